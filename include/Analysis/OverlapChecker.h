@@ -9,6 +9,8 @@
 
 
 #include <string>
+#include <vector>
+#include <utility>
 
 using namespace lcio ;
 using namespace marlin ;
@@ -19,6 +21,11 @@ using namespace marlin ;
 
 /**  Processor to check if tracks are overlapping.
  * 
+ * Two tracks are in conflict, when they share a hit. The conflicts are found from an index hit -> tracks,
+ * so only the tracks that actually share hits get compared and only the conflicting pairs are stored.
+ * 
+ * Per event and in total it reports the number of conflicting pairs, the size of the largest group of tracks 
+ * connected by conflicts and the number of hits shared by more than two tracks.
  * 
  *  <h4>Input - Prerequisites</h4>
  *  A collection of tracks.
@@ -69,7 +76,22 @@ protected:
    
    
    
-   bool areCompatible( Track* trackA , Track* trackB );
+   /** Finds all pairs of tracks that share at least one hit.
+    * 
+    * @param tracks the tracks to check
+    * 
+    * @param conflicts here the conflicting pairs get stored as indices into tracks, the first index being the lower one.
+    * Every pair is stored only once.
+    * 
+    * @param nSharedHits here the number of hits used by more than one track gets stored
+    * 
+    * @param nHitsSharedByMoreThanTwo here the number of hits used by more than two tracks gets stored
+    */
+   void findConflicts( const std::vector< Track* >& tracks , std::vector< std::pair< unsigned , unsigned > >& conflicts ,
+                       unsigned& nSharedHits , unsigned& nHitsSharedByMoreThanTwo ) const;
+   
+   /** @return the number of tracks in the largest connected component of the conflict graph */
+   unsigned getLargestComponent( unsigned nTracks , const std::vector< std::pair< unsigned , unsigned > >& conflicts ) const;
    
    
    
@@ -79,6 +101,13 @@ protected:
    
    std::string _trackCollectionName;
    
+   
+   unsigned long _nTracksTotal;
+   unsigned long _nConflictsTotal;
+   unsigned long _nSharedHitsTotal;
+   unsigned long _nHitsSharedByMoreThanTwoTotal;
+   unsigned _largestComponentMax;
+   
   
    
 } ;
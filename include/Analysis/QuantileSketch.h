@@ -0,0 +1,78 @@
+#ifndef QuantileSketch_h
+#define QuantileSketch_h
+
+#include <vector>
+#include <stdint.h>
+
+
+
+/** A streaming sketch of a distribution of floats, that can be asked for any quantile (a KLL sketch).
+ * 
+ * The values are kept in levels. A value on level h stands for 2^h values of the stream. When the sketch gets
+ * full, the lowest full level is sorted and every second value of it moves up a level. The memory needed only
+ * depends on k (about 3k values), not on the number of values seen, and the rank error of a quantile is
+ * roughly 1.7/k (k = 200 gives about 1%).
+ * 
+ * The values moving up are taken alternately at even and odd positions instead of at random positions,
+ * so the sketch of a stream is always the same.
+ * 
+ * Sketches with the same k can be merged.
+ */
+class QuantileSketch{
+   
+   
+public:
+   
+   QuantileSketch( unsigned k = 200 );
+   
+   /** Adds a value of the stream */
+   void update( float x );
+   
+   /** Adds all the values of another sketch */
+   void merge( const QuantileSketch& other );
+   
+   /** @return the value with the rank q*n (0 <= q <= 1) in the stream, approximately */
+   float getQuantile( double q ) const;
+   
+   /** @return the number of values seen */
+   uint64_t getN() const { return _n; }
+   
+   float getMin() const { return _min; }
+   float getMax() const { return _max; }
+   unsigned getK() const { return _k; }
+   
+   /** All the values stored with the levels they are on, for saving the sketch */
+   void getItems( std::vector< float >& items, std::vector< int >& levels ) const;
+   
+   /** @return a sketch made from the stored values of getItems() */
+   static QuantileSketch fromItems( unsigned k, float min, float max, const std::vector< float >& items, const std::vector< int >& levels );
+   
+   
+private:
+   
+   unsigned _k;
+   uint64_t _n;
+   float _min;
+   float _max;
+   
+   std::vector< std::vector< float > > _levels;
+   
+   /** for every level, whether the values at odd positions move up next time */
+   std::vector< bool > _odd;
+   
+   unsigned _size;
+   
+   /** the capacity of every level and their sum, they change when a level is added */
+   std::vector< unsigned > _capacities;
+   unsigned _totalCapacity;
+   
+   /** Moves half of the lowest full level up, until the sketch is within its capacity */
+   void compress();
+   
+   void addLevel();
+   
+};
+
+
+#endif
+
@@ -0,0 +1,87 @@
+#ifndef RootTreeWriter_h
+#define RootTreeWriter_h
+
+#include <string>
+#include <set>
+#include <vector>
+
+#include "TFile.h"
+#include "TTree.h"
+
+
+
+/** Writes rows of floats into trees of a root file.
+ * 
+ * It replaces KiTrackMarlin::setUpRootFile() and KiTrackMarlin::saveToRoot() for processors writing many rows:
+ * the file is opened once and stays open, and the branches of a tree are resolved once into slots of a flat row
+ * of floats (in the alphabetical order of the branch names, as they come from the set). So writing a row is
+ * copying the floats into the buffer the branches point to and filling the tree, no map and no lookup by name.
+ * 
+ * A row of a tree is a float array with getNumberOfBranches() entries, the value of a branch is at getSlot( branchName ).
+ */
+class RootTreeWriter{
+   
+   
+public:
+   
+   /**
+    * @param fileName the path of the root file
+    * 
+    * @param createNew if true and the file already exists, the old file is renamed (as done by 
+    * KiTrackMarlin::setUpRootFile), otherwise new trees get appended to the file and existing trees continued.
+    */
+   RootTreeWriter( const std::string& fileName, bool createNew );
+   
+   RootTreeWriter( const RootTreeWriter& ) = delete;
+   RootTreeWriter& operator=( const RootTreeWriter& ) = delete;
+   
+   /** Writes the trees and closes the file, if not already done by close() */
+   ~RootTreeWriter();
+   
+   /** Creates a tree with a float branch for every name, or continues the tree, if the file already has it.
+    * 
+    * @return the index of the tree, used for all the other methods
+    */
+   unsigned addTree( const std::string& treeName, const std::set< std::string >& branchNames );
+   
+   unsigned getNumberOfBranches( unsigned tree ) const { return _trees[ tree ]->branchNames.size(); }
+   
+   /** @return the position of the branch in a row of the tree. Throws std::runtime_error, if there is no such branch. */
+   unsigned getSlot( unsigned tree, const std::string& branchName ) const;
+   
+   /** @return the position of the branch in a row of the tree, or -1 if there is no such branch */
+   int findSlot( unsigned tree, const std::string& branchName ) const;
+   
+   /** Fills one row into the tree */
+   void fill( unsigned tree, const float* row );
+   
+   /** Fills all the rows stored one after another in rows into the tree */
+   void fillRows( unsigned tree, const std::vector< float >& rows );
+   
+   /** Writes the trees and closes the file */
+   void close();
+   
+   /** @return the root file, for writing other objects to it. NULL after close(). */
+   TFile* getFile() const { return _file; }
+   
+   
+private:
+   
+   struct Tree{
+      
+      TTree* tree;
+      std::vector< std::string > branchNames; // sorted
+      std::vector< float > buffer; // the branches point into this
+      
+   };
+   
+   TFile* _file;
+   
+   std::vector< Tree* > _trees;
+   
+   
+};
+
+
+#endif
+
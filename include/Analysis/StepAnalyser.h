@@ -10,27 +10,38 @@
 #include <EVENT/Track.h>
 
 #include "KiTrack/Segment.h"
+#include "ILDImpl/SectorSystemFTD.h"
+
+#include "RootTreeWriter.h"
+#include "FTDTransitionSectorConnector.h"
 
 
 
 
 using namespace lcio ;
 using namespace marlin ;
+using namespace KiTrackMarlin;
 
 
 
 
 /**  Processor to analyse the steps a true track made on its way through the FTD.
  * 
+ * Besides the root file it counts how often the tracks went from one sector of the FTD to the next one on 
+ * the nearest inner layer the track has a hit on (or to the IP) and writes this as a table with the coverage 
+ * fractions at the end. The table can be used by the FTDTransitionSectorConnector in ForwardTracking.
  * 
  *  <h4>Input - Prerequisites</h4>
  *  A collection of cheated tracks in the FTD.
  *
  *  <h4>Output</h4> 
- *  A root file
+ *  A root file and a text file with the sector transitions
  * 
  * @param MCTrueTrackRelCollectionName The collection of the cheated track relations.
  * 
+ * @param SectorTransitionFileName The file to write the table of sector transitions to. Nothing is written if empty.<br>
+ * (default value "SectorTransitions.txt")
+ * 
  * @author R. Glattauer HEPHY, Wien
  *
  */
@@ -88,8 +99,43 @@ protected:
    std::string _treeName;
    std::string _treeName2;
    
+   /** Writes both trees, the file stays open from init() to end() */
+   RootTreeWriter* _rootWriter;
+   
+   unsigned _tree;
+   unsigned _tree2;
+   
+   // the slots of the branches of the tree "values"
+   unsigned _slot_lastLayerBeforeIP;
+   unsigned _slot_nHits;
+   unsigned _slot_pt;
+   
+   // the slots of the branches of the tree "hitPairs"
+   unsigned _slot2_LayerA;
+   unsigned _slot2_LayerB;
+   unsigned _slot2_LayerDist;
+   unsigned _slot2_ModuleA;
+   unsigned _slot2_ModuleB;
+   unsigned _slot2_ModuleDist;
+   unsigned _slot2_SensorA;
+   unsigned _slot2_SensorB;
+   unsigned _slot2_SensorDist;
+   unsigned _slot2_pt;
+   
    std::string _colNameMCTrueTracksRel;
    
+   
+   const SectorSystemFTD* _sectorSystemFTD;
+   
+   std::string _sectorTransitionFileName;
+   
+   /** How often true tracks went from one sector to another */
+   SectorTransitionCounts _sectorTransitions;
+   
+   /** The sectors of the virtual IP hits on the forward and backward side */
+   int _ipSectorForward;
+   int _ipSectorBackward;
+   
   
    
 } ;
@@ -2,6 +2,8 @@
 #define TrueTrackCritAnalyser_h
 
 #include <string>
+#include <map>
+#include <set>
 
 #include "marlin/Processor.h"
 #include "lcio.h"
@@ -15,6 +17,9 @@
 
 #include "ILDImpl/SectorSystemFTD.h"
 
+#include "RootTreeWriter.h"
+#include "QuantileSketch.h"
+
 using namespace lcio ;
 using namespace marlin ;
 using namespace KiTrackMarlin;
@@ -76,6 +81,23 @@ using namespace KiTrackMarlin;
  * @param SmoothOn Whether to smooth all measurement sites in fit<br>
  * (default value false )
  * 
+ * @param QuantileSketches Whether to keep streaming quantile sketches of the values of the criteria, for all 
+ * true tracks and for every combination of layers. They are saved in the tree "QuantileSketches" at the end.
+ * QuantileAnalyser takes the cut values from them, merged over the files of several jobs. <br>
+ * (default value false )
+ * 
+ * @param QuantileSketchK The size of the sketches: the rank error of a quantile is about 1.7/k <br>
+ * (default value 200 )
+ * 
+ * @param WriteCritValueTrees Whether to save the values of the criteria of every true track in the trees 2Hit, 3Hit
+ * and 4Hit. Not needed, if only the quantile sketches are of interest (QuantileAnalyser then only reads the sketches,
+ * but can't estimate how many true connections all cuts of a round keep together). <br>
+ * (default value true )
+ * 
+ * @param NumberOfThreads The number of threads analysing the true tracks of an event in parallel. The output
+ * is the same as with one thread. <br>
+ * (default value 1 )
+ * 
  * @author R. Glattauer HEPHY, Wien
  *
  */
@@ -135,11 +157,167 @@ protected:
    std::string _treeNameKalman;
    std::string _treeNameHitDist;
    
+   /** Writes all the trees, the file stays open from init() to end() */
+   RootTreeWriter* _rootWriter;
+   
+   unsigned _tree2;
+   unsigned _tree3;
+   unsigned _tree4;
+   unsigned _treeKalman;
+   unsigned _treeHitDist;
+   
+   /** The slots of the branches all the criteria trees have */
+   struct CritTreeSlots{
+      
+      unsigned MCP_p;
+      unsigned MCP_pt;
+      unsigned MCP_distToIP;
+      unsigned chi2Prob;
+      unsigned layers;
+      unsigned PDG;
+      unsigned theta;
+      
+   };
+   
+   CritTreeSlots _slots2;
+   CritTreeSlots _slots3;
+   CritTreeSlots _slots4;
+   unsigned _slot2_distance;
+   
+   struct KalmanSlots{
+      
+      unsigned helixChi2;
+      unsigned helixNdf;
+      unsigned helixChi2OverNdf;
+      unsigned chi2Prob;
+      unsigned chi2;
+      unsigned Ndf;
+      unsigned nHits;
+      unsigned PDG;
+      unsigned MCP_p;
+      unsigned MCP_pt;
+      unsigned MCP_distToIP;
+      unsigned theta;
+      
+   };
+   
+   KalmanSlots _slotsKalman;
+   
+   struct HitDistSlots{
+      
+      unsigned distToPrevHit;
+      unsigned MCP_pt;
+      unsigned PDG;
+      unsigned MCP_p;
+      unsigned theta;
+      
+   };
+   
+   HitDistSlots _slotsHitDist;
+   
+   /** The names of the values a criterion calculates and their slots in the row, in the order of getMapOfValues() */
+   typedef std::vector< std::pair< std::string , int > > ValueSlots;
+   
+   /** Copies the values the criterion calculated last into the row of the tree.
+    * 
+    * The slots are looked up by name only the first time a value appears at a position of the map of values.
+    * Values without a branch are ignored.
+    */
+   void storeCritValues( ICriterion* crit, ValueSlots& valueSlots, unsigned tree, float* row ) const;
+   
+   CritTreeSlots getCritTreeSlots( unsigned tree ) const;
+   
    std::string _colNameMCTrueTracksRel;
    
-   std::vector <ICriterion*> _crits2;
-   std::vector <ICriterion*> _crits3;
-   std::vector <ICriterion*> _crits4;
+   /** The criteria used by one thread. The criteria store the values they calculate, so every thread needs its own. */
+   struct CritWorker{
+      
+      std::vector <ICriterion*> crits2;
+      std::vector <ICriterion*> crits3;
+      std::vector <ICriterion*> crits4;
+      
+      std::vector< ValueSlots > valueSlots2;
+      std::vector< ValueSlots > valueSlots3;
+      std::vector< ValueSlots > valueSlots4;
+      
+      ~CritWorker();
+      
+   };
+   
+   /** One worker per thread, the first one is also used when running serially */
+   std::vector< CritWorker* > _workers;
+   
+   CritWorker* createCritWorker() const;
+   
+   /** A true track that passed the cuts */
+   struct TrueTrackInfo{
+      
+      Track* track;
+      double p;
+      double pt;
+      double distToIP;
+      double chi2;
+      double Ndf;
+      double chi2Prob;
+      int nHits;
+      double theta;
+      double pdg;
+      
+   };
+   
+   /** The rows a true track produces for every tree, stored one after another */
+   struct TrueTrackRows{
+      
+      std::vector< float > rows2;
+      std::vector< float > rows3;
+      std::vector< float > rows4;
+      std::vector< float > rowsKalman;
+      std::vector< float > rowsHitDist;
+      
+   };
+   
+   /** Evaluates all the criteria on the segments of the true track and stores the values in the rows.
+    * Uses nothing but the worker and the rows passed, so true tracks can be analysed in parallel with different workers.
+    */
+   void analyseTrueTrack( const TrueTrackInfo& info, CritWorker& worker, TrueTrackRows& rows ) const;
+   
+   int _nThreads;
+   
+   
+   bool _makeQuantileSketches;
+   int _sketchK;
+   bool _writeCritValueTrees;
+   
+   /** The quantile sketches of the values of the criteria of one tree */
+   struct CritTreeSketches{
+      
+      unsigned tree;
+      std::string treeName;
+      
+      /** the slots of the values of the criteria in a row and their names */
+      std::vector< unsigned > slots;
+      std::vector< std::string > names;
+      
+      unsigned layersSlot;
+      
+      /** for every value the sketch of all rows and of the rows of every combination of layers */
+      std::vector< QuantileSketch > all;
+      std::map< int , std::vector< QuantileSketch > > perLayers;
+      
+   };
+   
+   CritTreeSketches _sketches2;
+   CritTreeSketches _sketches3;
+   CritTreeSketches _sketches4;
+   
+   void setUpSketches( CritTreeSketches& sketches, unsigned tree, const std::string& treeName, 
+                       const std::set< std::string >& valueNames, unsigned layersSlot );
+   
+   /** Adds all the rows (stored one after another) to the sketches */
+   void updateSketches( CritTreeSketches& sketches, const std::vector< float >& rows );
+   
+   /** Saves the sketches in the tree "QuantileSketches" of the root file */
+   void writeSketches();
 
    
    
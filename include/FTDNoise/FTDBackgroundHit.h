@@ -0,0 +1,60 @@
+#ifndef FTDBackgroundHit_h
+#define FTDBackgroundHit_h
+
+#include <cstddef>
+#include <vector>
+
+#include "IMPL/TrackerHitPlaneImpl.h"
+
+
+
+/** The fields of a background hit that are the same for all hits on a sensor */
+struct FTDBackgroundHitTemplate{
+   
+   int cellID0;
+   int type;
+   
+   // theta and phi of the u and v direction of the surface
+   float u[2];
+   float v[2];
+   
+   float dU;
+   float dV;
+   
+};
+
+
+/** A TrackerHitPlaneImpl for the generated background, whose memory comes from a pool of blocks.
+ * 
+ * The collections of LCIO own their hits and delete them one by one, so the hits can't simply be parts of one
+ * array. Instead operator new and delete of this class take and give back slots of blocks holding many hits.
+ * As the destructor of the hits is virtual, the collection deleting them through an LCObject* still ends up in
+ * the operator delete of this class. Freed slots are reused by the next event, the blocks are kept until the
+ * end of the job.
+ * 
+ * The hits are stored and read back as normal TrackerHitPlanes.
+ */
+class FTDBackgroundHit : public IMPL::TrackerHitPlaneImpl{
+   
+   
+public:
+   
+   /** Creates a hit with the fields of the template at the position pos (x,y,z) */
+   FTDBackgroundHit( const FTDBackgroundHitTemplate& hitTemplate, const double* pos, float time );
+   
+   static void* operator new( std::size_t size );
+   static void operator delete( void* p, std::size_t size );
+   
+   /** Takes n slots for hits from the pool at once and appends them to slots.
+    * The hits are then created in them with ::new( slot ) FTDBackgroundHit(...). */
+   static void allocate( unsigned n, std::vector< void* >& slots );
+   
+   /** The number of hits in a block of the pool */
+   static const unsigned BLOCK_SIZE = 1024;
+   
+   
+};
+
+
+#endif
+
@@ -0,0 +1,76 @@
+#ifndef FTDBackgroundLibrary_h
+#define FTDBackgroundLibrary_h
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+
+/** A hit in a background library: the sensor (its index in the sensor table of the FTDBackgroundProcessor) and
+ * the position on the trapezoid of the sensor (x from the inner edge outwards, y across), in mm.
+ */
+struct FTDBackgroundLibraryHit{
+   
+   uint32_t sensor;
+   float x;
+   float y;
+   
+};
+
+
+/** A file of pre-generated background frames, read through a read-only memory mapping.
+ * 
+ * The file consists of
+ * - a header: the magic "FTDBKG01", the number of sensors and the number of frames (2 x uint32)
+ * - nFrames + 1 offsets (uint64): frame i are the hits from offsets[i] to offsets[i+1]
+ * - the hits (FTDBackgroundLibraryHit)
+ * 
+ * As the hits are stored relative to their sensor, a frame can be put on any sensor of the same kind, e.g. be rotated 
+ * by some petals.
+ */
+class FTDBackgroundLibrary{
+   
+   
+public:
+   
+   /** Maps the library. Throws a std::runtime_error if it can't be read, is no background library or is corrupt
+    * (frames out of order or outside of the hits, hits on sensors >= the number of sensors).
+    */
+   FTDBackgroundLibrary( const std::string& fileName );
+   
+   ~FTDBackgroundLibrary();
+   
+   /** Writes the frames to a library file. Throws a std::runtime_error if it can't be written. */
+   static void write( const std::string& fileName, unsigned nSensors, const std::vector< std::vector< FTDBackgroundLibraryHit > >& frames );
+   
+   unsigned getNumberOfSensors() const { return _nSensors; }
+   unsigned getNumberOfFrames() const { return _nFrames; }
+   
+   /** @return the first hit of a frame, straight from the mapping */
+   const FTDBackgroundLibraryHit* beginFrame( unsigned frame ) const { return _hits + _offsets[ frame ]; }
+   
+   /** @return one past the last hit of a frame */
+   const FTDBackgroundLibraryHit* endFrame( unsigned frame ) const { return _hits + _offsets[ frame + 1 ]; }
+   
+   
+private:
+   
+   FTDBackgroundLibrary( const FTDBackgroundLibrary& );
+   FTDBackgroundLibrary& operator=( const FTDBackgroundLibrary& );
+   
+   void* _data;
+   size_t _size;
+   
+   unsigned _nSensors;
+   unsigned _nFrames;
+   
+   const uint64_t* _offsets;
+   const FTDBackgroundLibraryHit* _hits;
+   
+   
+};
+
+
+#endif
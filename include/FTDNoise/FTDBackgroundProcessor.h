@@ -1,109 +1,258 @@
-#ifndef FTDBackgroundProcessor_h
-#define FTDBackgroundProcessor_h 1
-
-#include <string>
-#include <vector>
-
-#include <CLHEP/Vector/ThreeVector.h>
-
-#include "marlin/Processor.h"
-#include "lcio.h"
-
-
-using namespace lcio ;
-using namespace marlin ;
-
-
-/** Generates background hits in the FTD detector.
- * 
- * @param FTDPixelTrackerHitCollectionName Name of the FTD Pixel TrackerHit collection where the background hits will be added.<br>
- * (default value FTDPixelTrackerHits)
- * 
- * @param FTDStripTrackerHitCollectionName Name of the FTD Strip TrackerHit collection where the background hits will be added.<br>
- * (default value FTDStripTrackerHits)
- * 
- * @param ResolutionU resolution in direction of u (in mm) <br>
- * (default value 0.004)
- * 
- * @param ResolutionV Resolution in direction of v (in mm) <br>
- * (default value 0.004)
- * 
- * @param BackgroundHitDensity the densities of the background hits measured in hits / cm^2 /BX  (BX= bunchcrossing) for
- * the different layers.<br>
- * These units are chosen because they are identical with those in the LOI.<br>
- * (default values 0.013 0.008 0.002 0.002 0.001 0.001 0.001 )
- * 
- * @param BackgroundHitDensitySigma the sigmas corresponding to the BackgroundHitDensity. Also in hits / cm^2 /BX.<br>
- * The actual number of created background hits will be smeared gaussian aroung the BackgroundHitDensity with these values.<br>
- * (default values 0.005 0.003 0.001 0.001 0.001 0.001 0.001 ) 
- * 
- * @param IntegratedBX the number of integrations of bunchcrossings the FTDs do before readout. For strip detectors this
- * is usually 1 and for Pixels a lot more.<br>
- * (default values 100 100 1 1 1 1 1 )
- * 
- * @param DensityRegulator Regulates all densities. This can be used to dim or amplify all the background. <br>
- * 1 means no change at all, 2 means background is doubled, 0.7 means only 70 percent of the background and so on. <br>
- * (default value 1. )
- * 
- * @author Robin Glattauer, HEPHY
- */
-class FTDBackgroundProcessor : public Processor {
-  
- public:
-  
-    virtual Processor*  newProcessor() { return new FTDBackgroundProcessor ; }
-  
-  
-    FTDBackgroundProcessor() ;
-  
-  /** Called at the begin of the job before anything is read.
-   * Use to initialize the processor, e.g. book histograms.
-   */
-  virtual void init() ;
-  
-  /** Called for every run.
-   */
-  virtual void processRunHeader( LCRunHeader* run ) ;
-  
-  /** Called for every event - the working horse.
-   */
-  virtual void processEvent( LCEvent * evt ) ; 
-  
-  
-  virtual void check( LCEvent * evt ) ; 
-  
-  
-  /** Called after data processing for clean up.
-   */
-  virtual void end() ;
-
-
- protected:
-   
-   
-    CLHEP::Hep3Vector getRandPosition( double rMin, double lengthMin, double lengthMax, double width, double phi, double z );
-   
-
-   std::string _colNameFTDStripTrackerHit;
-   std::string _colNameFTDPixelTrackerHit;
-
-   float _resU ;
-   float _resV ;
-
-   int _nRun ;
-   int _nEvt ;
-
-   
-   float _densityRegulator;
-   
-   std::vector < float > _backgroundDensity;
-   std::vector < float > _backgroundDensitySigma;
-   std::vector < int >   _integratedBX;
-
-
-} ;
-
-#endif
-
-
-
+#ifndef FTDBackgroundProcessor_h
+#define FTDBackgroundProcessor_h 1
+
+#include <string>
+#include <vector>
+
+#include <CLHEP/Vector/ThreeVector.h>
+
+#include "marlin/Processor.h"
+#include "lcio.h"
+#include "IMPL/TrackerHitPlaneImpl.h"
+
+#include "FTDBackgroundLibrary.h"
+#include "FTDBackgroundHit.h"
+
+
+using namespace lcio ;
+using namespace marlin ;
+
+
+/** Everything about one FTD sensor the background generation needs. All of it is constant for the job, so
+ * it is calculated once in init() from the DD4hep geometry.
+ */
+struct FTDBackgroundSensor{
+   
+   int side;
+   int layer;
+   unsigned petal;
+   unsigned sensor;
+   
+   int cellID0;
+   bool isPixel;
+   
+   /** index of the front sensor in the sensor table if this is the back of a double sided petal, else -1 */
+   int frontSensor;
+   
+   // where the sensors of the layer are in the sensor table, to find the same sensor on another petal
+   unsigned firstSensorOfLayer;
+   unsigned nPetals;
+   unsigned nSensorsPerPetal;
+   
+   // the trapezoid of the sensor (in mm and rad)
+   double rMin;
+   double lengthMin;
+   double lengthMax;
+   double width;
+   double phi;
+   double z;
+   double area; // in cm^2
+   
+   unsigned integratedBX;
+   
+   // the mean and sigma of the number of hits per cm^2 (already multiplied with the regulator and the integrated BX)
+   double densityMean;
+   double densitySigma;
+   
+   /** the fields every hit on the sensor gets: cellID0, type, u and v direction and resolutions */
+   FTDBackgroundHitTemplate hitTemplate;
+   
+   double cosPhi;
+   double sinPhi;
+   
+   /** the cumulative distribution of the hits along the width in equal bins, empty for a uniform density */
+   std::vector< double > cdfX;
+   
+};
+
+
+/** Generates background hits in the FTD detector.
+ * 
+ * @param FTDPixelTrackerHitCollectionName Name of the FTD Pixel TrackerHit collection where the background hits will be added.<br>
+ * (default value FTDPixelTrackerHits)
+ * 
+ * @param FTDStripTrackerHitCollectionName Name of the FTD Strip TrackerHit collection where the background hits will be added.<br>
+ * (default value FTDStripTrackerHits)
+ * 
+ * @param ResolutionU resolution in direction of u (in mm) <br>
+ * (default value 0.004)
+ * 
+ * @param ResolutionV Resolution in direction of v (in mm) <br>
+ * (default value 0.004)
+ * 
+ * @param BackgroundHitDensity the densities of the background hits measured in hits / cm^2 /BX  (BX= bunchcrossing) for
+ * the different layers.<br>
+ * These units are chosen because they are identical with those in the LOI.<br>
+ * (default values 0.013 0.008 0.002 0.002 0.001 0.001 0.001 )
+ * 
+ * @param BackgroundHitDensitySigma the sigmas corresponding to the BackgroundHitDensity. Also in hits / cm^2 /BX.<br>
+ * The actual number of created background hits will be smeared gaussian aroung the BackgroundHitDensity with these values.<br>
+ * (default values 0.005 0.003 0.001 0.001 0.001 0.001 0.001 ) 
+ * 
+ * @param IntegratedBX the number of integrations of bunchcrossings the FTDs do before readout. For strip detectors this
+ * is usually 1 and for Pixels a lot more.<br>
+ * (default values 100 100 1 1 1 1 1 )
+ * 
+ * @param DensityRegulator Regulates all densities. This can be used to dim or amplify all the background. <br>
+ * 1 means no change at all, 2 means background is doubled, 0.7 means only 70 percent of the background and so on. <br>
+ * (default value 1. )
+ * 
+ * @param BunchSpacing If greater than 0, every background hit gets the time of one of the IntegratedBX bunch crossings of its layer,
+ * drawn at random: BX * BunchSpacing (in ns) with BX = 0 ... IntegratedBX - 1, the bunch crossing of the event being BX 0. 
+ * The tracking can then cut on the time (HitTimeWindow and MaxHitTimeDifference of ForwardTracking). <br>
+ * (default value 0 = all hits at time 0)
+ * 
+ * @param RadialDensityExponent The hits are distributed on every sensor with a density proportional to r^-n, with r the
+ * distance from the beam axis. This only moves the hits within the sensor, their number is still given by the BackgroundHitDensity.
+ * If not 0, the distribution is an approximation: r is taken as rMin + x, the distance along the middle line of the petal 
+ * (ignoring the sideways offset y), and the cumulative distribution along x is tabulated in 100 bins and interpolated linearly. <br>
+ * (default value 0, meaning uniform )
+ * 
+ * @param UseCounterBasedRNG Draw the random numbers from counter based generators keyed by the event seed and the sensor
+ * (side, layer, petal, sensor) instead of the global CLHEP engine. The hits are then the same no matter in which order
+ * or thread the sensors are done. <br>
+ * (default value false )
+ * 
+ * @param NumberOfThreads The number of threads creating the hits if UseCounterBasedRNG is set. <br>
+ * (default value 1 )
+ * 
+ * @param BackgroundLibraryMode Instead of generating the background for every event, it can be taken from a library of 
+ * pre-generated frames: "write" writes such a library in init (and then generates as usual), "overlay" takes the background
+ * from it. An empty string just generates. <br>
+ * (default value "" )
+ * 
+ * @param BackgroundLibraryFile The file of the background library. <br>
+ * (default value FTDBackground.lib )
+ * 
+ * @param BackgroundLibraryFrames The number of frames written to the library. <br>
+ * (default value 1000 )
+ * 
+ * @param BackgroundLibrarySeed The seed of the first frame written, the next frames count up from it. <br>
+ * (default value 0 )
+ * 
+ * @param FramesPerEvent The number of frames overlaid on every event. Each is rotated by a random number of petals. Overlaying
+ * several frames made with IntegratedBX 1 emulates more integrated bunch crossings. <br>
+ * (default value 1 )
+ * 
+ * @author Robin Glattauer, HEPHY
+ */
+class FTDBackgroundProcessor : public Processor {
+  
+ public:
+  
+    virtual Processor*  newProcessor() { return new FTDBackgroundProcessor ; }
+  
+  
+    FTDBackgroundProcessor() ;
+  
+  /** Called at the begin of the job before anything is read.
+   * Use to initialize the processor, e.g. book histograms.
+   */
+  virtual void init() ;
+  
+  /** Called for every run.
+   */
+  virtual void processRunHeader( LCRunHeader* run ) ;
+  
+  /** Called for every event - the working horse.
+   */
+  virtual void processEvent( LCEvent * evt ) ; 
+  
+  
+  virtual void check( LCEvent * evt ) ; 
+  
+  
+  /** Called after data processing for clean up.
+   */
+  virtual void end() ;
+
+
+ protected:
+   
+   
+    /** Calculates a position on the trapezoid of a sensor from two uniform random numbers in (0,1), distributed
+     * with the density given by RadialDensityExponent. The point is always inside the sensor. The sampling is exact for a
+     * uniform density, else it uses the tabulated distribution of initSampling().
+     * 
+     * @param x the distance from the inner edge of the sensor (in mm)
+     * @param y the distance from the middle line of the sensor (in mm)
+     */
+    void getLocalPosition( const FTDBackgroundSensor& sensor, double randX, double randY, double& x, double& y );
+   
+   /** @return the global position of a point given as in getLocalPosition() */
+   CLHEP::Hep3Vector getGlobalPosition( const FTDBackgroundSensor& sensor, double x, double y );
+   
+   /** @return the time of a random one of the bunch crossings integrated by the sensor, from a uniform random number in (0,1) */
+   float getRandTime( const FTDBackgroundSensor& sensor, double randBX );
+   
+   /** @return a new hit on the sensor, created in the slot if given (see FTDBackgroundHit::allocate()) */
+   TrackerHitPlaneImpl* createHit( const FTDBackgroundSensor& sensor, const CLHEP::Hep3Vector& globalPos, float time, void* slot = NULL );
+   
+   /** Tabulates the distribution along the width of the sensor, if it is not uniform */
+   void initSampling( FTDBackgroundSensor& sensor );
+   
+   /** Creates nHits hits on the sensor, drawing their positions from random.flat(), and appends them to hits. */
+   template< class Random >
+   void createSensorHits( const FTDBackgroundSensor& sensor, unsigned nHits, Random& random, std::vector< TrackerHitPlaneImpl* >& hits );
+   
+   /** Creates the hits of all sensors with PhiloxRandom generators keyed by the seed and the sensor, in _nThreads threads. */
+   void generateHitsCounterBased( unsigned seed, std::vector< std::vector< TrackerHitPlaneImpl* > >& sensorHits );
+   
+   /** @return the number of hits on the sensor with index i, drawn from a PhiloxRandom keyed by the seed and the sensor */
+   unsigned getNumberOfHitsCounterBased( unsigned seed, unsigned i );
+   
+   /** Writes BackgroundLibraryFrames frames made like events with the counter based generators to the library */
+   void writeLibrary();
+   
+   /** Takes FramesPerEvent random frames from the library, rotates each by a random number of petals and adds
+    * their hits to sensorHits
+    */
+   void overlayLibraryFrames( unsigned seed, std::vector< std::vector< TrackerHitPlaneImpl* > >& sensorHits );
+   
+   /** Fills _sensors from the DD4hep geometry */
+   void initSensorTable();
+   
+
+   std::string _colNameFTDStripTrackerHit;
+   std::string _colNameFTDPixelTrackerHit;
+
+   float _resU ;
+   float _resV ;
+
+   int _nRun ;
+   int _nEvt ;
+
+   
+   float _densityRegulator;
+   
+   std::vector < float > _backgroundDensity;
+   std::vector < float > _backgroundDensitySigma;
+   std::vector < int >   _integratedBX;
+   
+   float _radialDensityExponent;
+   
+   float _bunchSpacing;
+   
+   bool _useCounterBasedRNG;
+   int _nThreads;
+   
+   std::string _libraryMode;
+   std::string _libraryFileName;
+   int _nLibraryFramesToWrite;
+   int _librarySeed;
+   int _framesPerEvent;
+   
+   FTDBackgroundLibrary* _library;
+   
+   /** all sensors of the FTD, ordered by side, layer, petal and sensor */
+   std::vector< FTDBackgroundSensor > _sensors;
+   
+   int _nLayers;
+
+
+} ;
+
+#endif
+
+
+
@@ -0,0 +1,54 @@
+#ifndef PhiloxRandom_h
+#define PhiloxRandom_h
+
+#include <stdint.h>
+
+
+
+/** A counter based random number generator (Philox4x32-10, Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+ * 
+ * The numbers are a pure function of the key and a counter, so a generator for e.g. one sensor in one event can be
+ * created anywhere, in any thread and in any order, and always gives the same sequence. There is no state shared
+ * between generators.
+ * 
+ * The key is made of two 32 bit words (e.g. the event seed and a cellID), a stream number allows several independent
+ * sequences for the same key.
+ */
+class PhiloxRandom{
+   
+   
+public:
+   
+   PhiloxRandom( uint32_t key0, uint32_t key1, uint32_t stream = 0 );
+   
+   /** @return a uniformly distributed number in (0,1) with 53 random bits */
+   double flat();
+   
+   /** @return a gaussian distributed number */
+   double gauss( double mean, double sigma );
+   
+   /** The Philox4x32-10 function itself: the four random words for a counter and a key.
+    * The generator uses the counter { block number, stream, 0, 0 }.
+    */
+   static void getBlock( const uint32_t counter[4], const uint32_t key[2], uint32_t block[4] );
+   
+   
+private:
+   
+   /** Fills _block with the next four random words */
+   void nextBlock();
+   
+   uint32_t nextWord();
+   
+   uint32_t _key[2];
+   uint32_t _stream;
+   uint32_t _counter;
+   
+   uint32_t _block[4];
+   unsigned _nUsed;
+   
+   
+};
+
+
+#endif
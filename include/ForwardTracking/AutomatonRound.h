@@ -0,0 +1,112 @@
+#ifndef AutomatonRound_h
+#define AutomatonRound_h
+
+#include <map>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <functional>
+
+#include "KiTrack/IHit.h"
+#include "KiTrack/ISectorConnector.h"
+#include "Criteria/ICriterion.h"
+
+using namespace KiTrack;
+
+namespace KiTrackMarlin{
+   
+   
+   /** One round of the Cellular Automaton of ForwardTracking and SiliconEndcapTracking: builds the 1-segments from
+    * the hits with the 2-hit criteria (ParallelSegmentBuilder) and lengthens them to 2- and 3-hit segments with the
+    * 3- and 4-hit criteria, each time followed by the automaton, the cleaning of bad states and the reset of the states.
+    *
+    * The automaton is a KiTrack::Automaton or a FlatAutomaton, both give the same tracks.
+    *
+    * A round that can be cancelled runs next to other rounds (see SpeculativeRounds), so it writes no debug output
+    * and draws nothing.
+    */
+   class AutomatonRound{
+      
+      
+   public:
+      
+      /**
+       * @param map_sector_hits the hits sorted by their sectors
+       *
+       * @param maxConnections if the automaton gets more connections than this, the round fails
+       *
+       * @param useFlatAutomaton whether to use a FlatAutomaton instead of a KiTrack::Automaton
+       */
+      AutomatonRound( const std::map< int , std::vector< IHit* > >& map_sector_hits, unsigned maxConnections, bool useFlatAutomaton );
+      
+      /** Whether to draw the 1-segments in CED (only with a KiTrack::Automaton and when the round can't be cancelled) */
+      void setDrawSegments( bool drawSegments ){ _drawSegments = drawSegments; }
+      
+      /** Runs the round.
+       *
+       * @param nThreads the number of threads for building and lengthening the segments
+       *
+       * @param cancelled if not NULL, the round stops and returns false as soon as this becomes true
+       *
+       * @return false if there are too many connections or the round got cancelled, else the tracks are in rawTracks
+       */
+      bool run( const std::vector< ICriterion* >& crit2Vec, const std::vector< ICriterion* >& crit3Vec,
+                const std::vector< ICriterion* >& crit4Vec, ISectorConnector* sectorConnector, unsigned nThreads,
+                const std::atomic< bool >* cancelled, std::vector< std::vector< IHit* > >& rawTracks ) const;
+      
+      
+   private:
+      
+      /** Runs the steps of the Cellular Automaton on its 1-segments, see the class description */
+      template< class AutomatonType >
+      bool runAutomaton( AutomatonType& automaton, const std::vector< ICriterion* >& crit3Vec, const std::vector< ICriterion* >& crit4Vec,
+                         const std::atomic< bool >* cancelled, std::vector< std::vector< IHit* > >& rawTracks ) const;
+      
+      const std::map< int , std::vector< IHit* > >& _map_sector_hits;
+      
+      unsigned _maxConnections;
+      
+      bool _useFlatAutomaton;
+      
+      bool _drawSegments;
+      
+      
+   };
+   
+   
+   /** Creates the criteria of a round of the Cellular Automaton of ForwardTracking and SiliconEndcapTracking into the
+    * given (empty) vectors. The caller owns them.
+    * 
+    * Every criterion gets the cut offs of the round, if there are no new ones for it, the last ones remain. If
+    * maxHitTimeDifference >= 0, a Crit2_DeltaTime< HitType > is put in front of the 2-hit criteria. HitType is
+    * IFTDHit or IEndcapHit.
+    * 
+    * @param critMinima, critMaxima the cut offs of every criterion, one per round
+    * 
+    * @return whether any new cut off value was used. false == there are no new cut off values anymore
+    */
+   template< class HitType >
+   bool createRoundCriteria( unsigned round, const std::vector< std::string >& criteriaNames,
+                             const std::map< std::string , std::vector< float > >& critMinima,
+                             const std::map< std::string , std::vector< float > >& critMaxima, float maxHitTimeDifference,
+                             std::vector< ICriterion* >& crit2Vec, std::vector< ICriterion* >& crit3Vec, std::vector< ICriterion* >& crit4Vec );
+   
+   
+   /** Creates the criteria of a round like createRoundCriteria() */
+   typedef std::function< bool( unsigned round, std::vector< ICriterion* >& crit2Vec, std::vector< ICriterion* >& crit3Vec,
+                                std::vector< ICriterion* >& crit4Vec ) > RoundCriteriaCreator;
+   
+   
+   /** Runs the rounds of all criteria at the same time in up to nThreads threads, see SpeculativeRounds. The criteria
+    * of the rounds are created with createCriteria until it returns false, and deleted at the end.
+    * 
+    * @return false if no round has few enough connections, else the tracks of the loosest round that has are in rawTracks
+    */
+   bool runRoundsSpeculatively( const AutomatonRound& automatonRound, ISectorConnector* sectorConnector, unsigned nThreads,
+                                const RoundCriteriaCreator& createCriteria, std::vector< std::vector< IHit* > >& rawTracks );
+   
+   
+}
+
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef Crit2_DeltaTime_h
+#define Crit2_DeltaTime_h
+
+
+#include "Criteria/ICriterion.h"
+
+using namespace KiTrack;
+
+namespace KiTrackMarlin{
+   
+   
+   /** Criterion: the difference of the times of the TrackerHits of two hits.
+    * 
+    * With integrating detectors, hits of different bunch crossings overlap in space. If the hits carry
+    * a time (TrackerHit::getTime()), hits from bunch crossings too far apart can't be from the same track.
+    * 
+    * HitType is the class of the hits that give access to their TrackerHit, IFTDHit in ForwardTracking and IEndcapHit
+    * in SiliconEndcapTracking (the two it is instantiated for). Each hit is cast only once to it. Virtual hits
+    * (like the IP) and other hits are always compatible.
+    */
+   template< class HitType >
+   class Crit2_DeltaTime : public ICriterion{
+      
+      
+      
+   public:
+      
+      /**
+       * @param deltaTimeMin the minimum of |t1 - t2| (in ns)
+       * 
+       * @param deltaTimeMax the maximum of |t1 - t2| (in ns)
+       */
+      Crit2_DeltaTime ( float deltaTimeMin , float deltaTimeMax );
+      
+      virtual bool areCompatible( Segment* parent , Segment* child );
+      
+      virtual ~Crit2_DeltaTime(){};
+      
+      
+   private:
+      
+      /** @return whether the hit has a TrackerHit, its time is stored in time */
+      static bool getHitTime( IHit* hit, float& time );
+      
+      float _deltaTimeMax;
+      float _deltaTimeMin;
+      
+      
+   };
+   
+   
+}
+
+
+#endif
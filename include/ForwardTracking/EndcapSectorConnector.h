@@ -4,6 +4,9 @@
 #include "KiTrack/ISectorConnector.h"
 
 #include "SectorSystemEndcap.h"
+#include "EndcapSectorOccupancy.h"
+
+#include <vector>
 
 
 
@@ -16,6 +19,14 @@ namespace KiTrackMarlin{
     * 
     * - going to layers on the inside (how far see constructor)
     * - jumping to the IP (from where see constructor)
+    * 
+    * The sectors searched on the inner layer lie in a window in phi and theta around the sector.
+    * With the first constructor this window is fixed (+-8 bins in phi, +-1 bin in theta).
+    * With the second one the window is calculated for every pair of layers from the z positions of the layers,
+    * the B field and a minimum transversal momentum: it is the smallest window that still contains all tracks
+    * from the IP with a higher pt (plus a number of tolerance bins).
+    * 
+    * If an EndcapSectorOccupancy is set, only the occupied sectors within the windows are returned.
     */   
    class EndcapSectorConnector : public ISectorConnector{
       
@@ -23,10 +34,31 @@ namespace KiTrackMarlin{
    public:
       
     EndcapSectorConnector ( const SectorSystemEndcap* sectorSystemEndcap , unsigned layerStepMax, unsigned lastLayerToIP ) ;
+    
+    /**
+     * @param layerZ the absolute z position of every layer of the sector system in mm (layer 0 is the IP)
+     * 
+     * @param ptMin the minimum transversal momentum in GeV of the tracks that should stay connected
+     * 
+     * @param Bz the B field in z direction in Tesla
+     * 
+     * @param toleranceBins number of bins added on each side of the calculated windows (to account for the 
+     * spread of the vertex, multiple scattering and so on)
+     */
+    EndcapSectorConnector ( const SectorSystemEndcap* sectorSystemEndcap , unsigned layerStepMax, unsigned lastLayerToIP,
+                            const std::vector< double >& layerZ, double ptMin, double Bz, unsigned toleranceBins ) ;
       
       /** @return a set of all sectors that are connected to the passed sector */
       virtual std::set <int>  getTargetSectors ( int sector );
       
+      /** Only return target sectors that are occupied according to the passed occupancy. NULL returns all sectors
+       * in the windows again. The occupancy is not owned by the connector.
+       */
+      void setOccupancy( const EndcapSectorOccupancy* occupancy ){ _occupancy = occupancy; }
+      
+      /** @return some information on the phi and theta windows used for every pair of layers */
+      std::string getInfoOnWindows() const;
+      
       virtual ~EndcapSectorConnector(){};
       
    private:
@@ -39,6 +71,22 @@ namespace KiTrackMarlin{
       unsigned _nDivisionsInPhi ;
       unsigned _nDivisionsInTheta ;      
       
+      /** The half width of the phi window in bins and the first and last theta bin on the target layer 
+       * for every (layer, layerStep, theta bin), see getWindowIndex() */
+      std::vector< int > _phiHalfWidth;
+      std::vector< int > _thetaLow;
+      std::vector< int > _thetaHigh;
+      
+      const EndcapSectorOccupancy* _occupancy;
+      
+      unsigned getWindowIndex( unsigned layer, unsigned layerStep, unsigned iTheta ) const {
+         return ( layer*_layerStepMax + layerStep - 1 )*_nDivisionsInTheta + iTheta; }
+      
+      /** Sets the window to the fixed values of +-8 bins in phi and +-1 bin in theta */
+      void setFixedWindow( unsigned layer, unsigned layerStep, unsigned iTheta );
+      
+      void init( const SectorSystemEndcap* sectorSystemEndcap , unsigned layerStepMax, unsigned lastLayerToIP );
+      
    };
    
    
@@ -0,0 +1,151 @@
+#ifndef EndcapSectorOccupancy_h
+#define EndcapSectorOccupancy_h
+
+#include "SectorSystemEndcap.h"
+
+#include <vector>
+#include <stdint.h>
+
+
+
+namespace KiTrackMarlin{
+
+
+   /** A bitset telling which sectors of a SectorSystemEndcap hold hits in the current event.
+    *
+    * With a fine sectorisation most of the sectors looked at when connecting hits are empty. Asking this class
+    * costs a single bit test instead of a lookup in the map of sectors and hits.
+    *
+    * The bits are ordered by (layer, theta, phi), so that all phi divisions of one layer and theta division
+    * are next to each other and a window in phi can be walked word by word (see forEachOccupiedSector).
+    *
+    * Only the words of sectors set since the last clear() get cleared, so the cost of a clear is proportional to
+    * the number of occupied sectors and not to the size of the sector system.
+    */
+   class EndcapSectorOccupancy{
+
+
+   public:
+
+      EndcapSectorOccupancy( const SectorSystemEndcap* sectorSystemEndcap );
+
+      /** Marks the sector as occupied */
+      void setOccupied( int sector ){
+
+         unsigned bit = getBit( sector );
+         uint64_t& word = _words[ bit >> 6 ];
+         uint64_t mask = uint64_t(1) << ( bit & 63 );
+
+         if( ( word & mask ) == 0 ){
+
+            word |= mask;
+            _occupiedSectors.push_back( sector );
+
+         }
+
+      }
+
+      /** @return whether the sector is occupied */
+      bool isOccupied( int sector ) const {
+
+         unsigned bit = getBit( sector );
+         return ( _words[ bit >> 6 ] >> ( bit & 63 ) ) & 1;
+
+      }
+
+      /** Marks all sectors as empty again */
+      void clear();
+
+      /** @return all the sectors set occupied since the last clear(), in the order they were set */
+      const std::vector< int >& getOccupiedSectors() const { return _occupiedSectors; }
+
+
+      /** Calls f( sector ) for every occupied sector in the passed layer and theta division and the
+       * phi divisions phiFirst to phiFirst + nPhi - 1. Phi wraps around, so phiFirst may be negative.
+       */
+      template< class F >
+      void forEachOccupiedSector( unsigned layer, unsigned theta, int phiFirst, int nPhi, F f ) const {
+
+         if( nPhi >= int( _nDivisionsInPhi ) ){
+
+            phiFirst = 0;
+            nPhi = _nDivisionsInPhi;
+
+         }
+
+         int n = _nDivisionsInPhi;
+         phiFirst = ( phiFirst % n + n ) % n;
+
+         int end = phiFirst + nPhi;
+
+         if( end <= n ) walk( layer, theta, phiFirst, end, f );
+         else{
+
+            walk( layer, theta, phiFirst, n, f );
+            walk( layer, theta, 0, end - n, f );
+
+         }
+
+      }
+
+
+   private:
+
+      unsigned _nLayers;
+      unsigned _nDivisionsInPhi;
+      unsigned _nDivisionsInTheta;
+
+      std::vector< uint64_t > _words;
+      std::vector< int > _occupiedSectors;
+
+      unsigned getBit( int sector ) const {
+
+         unsigned layer = sector % _nLayers;
+         unsigned phi   = ( sector / _nLayers ) % _nDivisionsInPhi;
+         unsigned theta = sector / ( _nLayers*_nDivisionsInPhi );
+
+         return ( layer*_nDivisionsInTheta + theta )*_nDivisionsInPhi + phi;
+
+      }
+
+      /** Walks the phi divisions [phiBegin, phiEnd) of one layer and theta division */
+      template< class F >
+      void walk( unsigned layer, unsigned theta, int phiBegin, int phiEnd, F& f ) const {
+
+         if( phiEnd <= phiBegin ) return;
+
+         unsigned rowStart = ( layer*_nDivisionsInTheta + theta )*_nDivisionsInPhi;
+         unsigned first = rowStart + phiBegin;
+         unsigned last  = rowStart + phiEnd - 1;
+
+         for( unsigned iWord = first >> 6; iWord <= ( last >> 6 ); iWord++ ){
+
+            uint64_t word = _words[ iWord ];
+
+            // mask the bits outside of the range
+            if( iWord == ( first >> 6 ) ) word &= ~uint64_t(0) << ( first & 63 );
+            if( iWord == ( last >> 6 ) )  word &= ~uint64_t(0) >> ( 63 - ( last & 63 ) );
+
+            while( word != 0 ){
+
+               unsigned bit = ( iWord << 6 ) + __builtin_ctzll( word );
+               word &= word - 1;
+
+               unsigned phi = bit - rowStart;
+               f( int( layer + _nLayers*phi + _nLayers*_nDivisionsInPhi*theta ) );
+
+            }
+
+         }
+
+      }
+
+
+   };
+
+
+}
+
+
+#endif
+
@@ -0,0 +1,90 @@
+#ifndef FTDTransitionSectorConnector_h
+#define FTDTransitionSectorConnector_h
+
+#include "KiTrack/ISectorConnector.h"
+
+#include "ILDImpl/SectorSystemFTD.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <ostream>
+
+
+
+namespace KiTrackMarlin{
+   
+   
+   /** A table of how often true tracks went from one sector to the next one further inside. The key is the pair
+    * ( outer sector, inner sector ), the value the number of times this transition was seen.
+    */
+   typedef std::map< std::pair< int, int >, unsigned long > SectorTransitionCounts;
+   
+   
+   /** Used to connect two sectors on the FTD, based on the transitions real tracks make.
+    * 
+    * The transitions are read from a table as written by StepAnalyser (see writeTable()). They are sorted by
+    * how often they occured and only the most frequent ones are kept, until they together make up the 
+    * requested coverage of all transitions. So for a coverage of 0.999, 99.9% of the steps true tracks made
+    * between two sectors are still connected, while rare and never seen combinations of sectors are not looked at.
+    * 
+    * The sectors must come from a SectorSystemFTD with the same number of layers, modules and sensors as the one
+    * the table was made with.
+    */   
+   class FTDTransitionSectorConnector : public ISectorConnector{
+      
+      
+   public:
+      
+      /**
+       * @param fileName the table with the transitions
+       * 
+       * @param coverage the fraction of all transitions in the table that shall stay connected (between 0 and 1)
+       * 
+       * Throws a std::runtime_error, if the file can't be read or was made for a different sector system.
+       */
+      FTDTransitionSectorConnector( const SectorSystemFTD* sectorSystemFTD , const std::string& fileName, double coverage );
+      
+      /** @return a set of all sectors that are connected to the passed sector */
+      virtual std::set <int>  getTargetSectors ( int sector );
+      
+      /** @return the number of transitions (sector pairs) that are used */
+      unsigned getNumberOfTransitions() const { return _nTransitions; }
+      
+      /** @return the fraction of all transitions in the table covered by the used ones */
+      double getCoverage() const { return _coverage; }
+      
+      virtual ~FTDTransitionSectorConnector(){};
+      
+      
+      /** Writes a table of transitions.
+       * 
+       * The lines are sorted by the count, the most frequent first, and hold: outer sector, inner sector, count,
+       * fraction, cumulative fraction (i.e. the coverage when keeping all transitions up to this one) and the 
+       * side, layer, module and sensor of both sectors. Lines starting with # are comments.
+       */
+      static void writeTable( std::ostream& os, const SectorSystemFTD* sectorSystemFTD, const SectorTransitionCounts& counts );
+      
+      /** Reads a table written by writeTable(). Throws a std::runtime_error if the file can't be read
+       * or doesn't match the sector system.
+       */
+      static void readTable( const std::string& fileName, const SectorSystemFTD* sectorSystemFTD, SectorTransitionCounts& counts );
+      
+      
+   private:
+      
+      
+      std::map< int, std::set< int > > _targets;
+      
+      unsigned _nTransitions;
+      double _coverage;
+      
+   };
+   
+   
+}
+
+
+#endif
+
@@ -0,0 +1,137 @@
+#ifndef FlatAutomaton_h
+#define FlatAutomaton_h
+
+#include <vector>
+#include <utility>
+#include <functional>
+
+#include "KiTrack/IHit.h"
+#include "Criteria/ICriterion.h"
+
+using namespace KiTrack;
+
+namespace KiTrackMarlin{
+   
+   
+   /** A Cellular Automaton doing the same as KiTrack::Automaton, but with all segments stored in flat arrays.
+    * 
+    * KiTrack::Automaton keeps every segment as an object on the heap, linked to its parents and children by
+    * lists of pointers. Here a segment is just an index: its hits, layer and states are entries of arrays
+    * (struct of arrays) and the children of all segments are one array with the offsets of every segment (CSR).
+    * The segments are sorted by layer, in the order the Automaton has them in its layers.
+    * 
+    * The rules are the ones of KiTrack::Automaton, so the same tracks come out:
+    * 
+    * - lengthenSegments(): every connection of a segment to a child becomes a segment with one more hit. It lies
+    * on the layer of the child and skips the layers between parent and child. Two of the new segments are connected,
+    * if they share all but one hit and fulfill the criteria.
+    * - doAutomaton(): in every sweep a segment raises its (inner) state if a child has an outer state equal to it,
+    * and the states for skipped layers follow one step. All segments are updated from the states of the last sweep,
+    * so a sweep can be done in any order, and in several threads. Repeated until nothing changes.
+    * - cleanBadStates(): removes the segments whose state is not their layer (i.e. that don't reach down to layer 0).
+    * - getTracks(): follows all paths from segments without parents to segments without children.
+    * 
+    * Only the criteria need real segments: when connecting new segments, a KiTrack::Segment with the hits is made
+    * for every new segment for the time of lengthenSegments(). The criteria are then called from several threads,
+    * so they must not save their values.
+    */
+   class FlatAutomaton{
+      
+      
+   public:
+      
+      /** @param nThreads the number of threads evaluating the criteria in lengthenSegments() and doing the sweeps of doAutomaton() */
+      FlatAutomaton( unsigned nThreads = 1 );
+      
+      /** Sets the 1-segments.
+       * 
+       * @param hits the hit of every segment
+       * 
+       * @param layers the layer of every segment
+       * 
+       * @param connections the pairs ( parent, child ) of indices of the segments. The children of a segment keep
+       * the order they have here.
+       */
+      void set1Segments( const std::vector< IHit* >& hits, const std::vector< unsigned >& layers,
+                         const std::vector< std::pair< unsigned, unsigned > >& connections );
+      
+      void addCriteria( const std::vector< ICriterion* >& criteria ){ _criteria.insert( _criteria.end(), criteria.begin(), criteria.end() ); }
+      
+      void clearCriteria(){ _criteria.clear(); }
+      
+      /** Makes the segments one hit longer, the new segments are connected according to the criteria */
+      void lengthenSegments();
+      
+      /** Raises the states of the segments until nothing changes anymore */
+      void doAutomaton();
+      
+      /** Removes all segments whose inner state is not equal to their layer */
+      void cleanBadStates();
+      
+      /** Sets all states to 0 */
+      void resetStates();
+      
+      /** @return the hits of all paths from a segment without parents to a segment without children that have at
+       * least minHits hits, from the outermost hit to the innermost */
+      std::vector< std::vector< IHit* > > getTracks( unsigned minHits = 3 );
+      
+      /** @return the number of connections between the segments */
+      unsigned getNumberOfConnections() const { return _children.size(); }
+      
+      unsigned getNumberOfSegments() const { return _layers.size(); }
+      
+      
+   private:
+      
+      /** Sorts the segments by layer (keeping their order within a layer) and sets the children.
+       * 
+       * @param children the children of the segments in the current order, segment i has the children 
+       * children[ childBegin[i] ] to children[ childBegin[i+1] - 1 ]
+       */
+      void sortByLayer( const std::vector< unsigned >& childBegin, const std::vector< unsigned >& children );
+      
+      /** Calls work( begin, end ) for blocks of the indices 0 to n - 1, in up to _nThreads threads. Small ranges are done
+       * in one block in the calling thread. An exception thrown by work is rethrown when all threads are done.
+       */
+      void forEachBlock( unsigned n, const std::function< void( unsigned begin, unsigned end ) >& work ) const;
+      
+      /** Follows the children of segment i and adds a track for every path to a segment without children */
+      void addTracksOfSegment( unsigned i, std::vector< IHit* >& hits, unsigned minHits, std::vector< std::vector< IHit* > >& tracks ) const;
+      
+      int getInnerState( unsigned i ) const { return _states[ _stateBegin[i] ]; }
+      int getOuterState( unsigned i ) const { return _states[ _stateBegin[i+1] - 1 ]; }
+      
+      
+      unsigned _nThreads;
+      
+      std::vector< ICriterion* > _criteria;
+      
+      /** the number of hits of every segment */
+      unsigned _nHits;
+      
+      /** the hits of segment i are _hits[ i*_nHits ] to _hits[ (i+1)*_nHits - 1 ], from the outside in */
+      std::vector< IHit* > _hits;
+      
+      std::vector< unsigned > _layers;
+      
+      /** the segments on layer l are _layerBegin[l] to _layerBegin[l+1] - 1 */
+      std::vector< unsigned > _layerBegin;
+      
+      /** the states of segment i are _states[ _stateBegin[i] ] (inner state) to _states[ _stateBegin[i+1] - 1 ] (outer state),
+       * one more than the number of skipped layers */
+      std::vector< unsigned > _stateBegin;
+      std::vector< int > _states;
+      
+      /** the children of segment i are _children[ _childBegin[i] ] to _children[ _childBegin[i+1] - 1 ] */
+      std::vector< unsigned > _childBegin;
+      std::vector< unsigned > _children;
+      
+      
+   };
+   
+   
+}
+
+
+#endif
+
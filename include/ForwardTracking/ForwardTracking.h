@@ -2,12 +2,16 @@
 #define ForwardTracking_h 1
 
 #include <string>
+#include <vector>
+#include <map>
+#include <utility>
 
 #include "marlin/Processor.h"
 #include "lcio.h"
 #include "EVENT/TrackerHit.h"
 #include "EVENT/Track.h"
 #include "IMPL/TrackImpl.h"
+#include "IMPL/LCCollectionVec.h"
 #include "MarlinTrk/IMarlinTrkSystem.h"
 #include "gear/BField.h"
 
@@ -16,6 +20,9 @@
 #include "Criteria/Criteria.h"
 #include "ILDImpl/SectorSystemFTD.h"
 
+#include "FTDTransitionSectorConnector.h"
+#include "AutomatonRound.h"
+
 using namespace lcio ;
 using namespace marlin ;
 using namespace KiTrack;
@@ -26,6 +33,27 @@ using namespace KiTrackMarlin;
 typedef std::vector< IHit* > RawTrack;
 
 
+/** The settings of ForwardTracking a point of a parameter scan can change */
+struct ForwardTrackingSettings{
+   
+   std::map< std::string , std::vector<float> > critMinima;
+   std::map< std::string , std::vector<float> > critMaxima;
+   double chi2ProbCut;
+   double helixFitMax;
+   int hitsPerTrackMin;
+   std::string bestSubsetFinder;
+   bool takeBestVersionOfTrack;
+   double HNN_Omega;
+   double HNN_ActivationThreshold;
+   double HNN_TInf;
+   int maxConnectionsAutomaton;
+   
+};
+
+/** A point of a parameter scan: pairs of parameter name and value */
+typedef std::vector< std::pair< std::string, std::string > > ScanPoint;
+
+
 /**  Standallone Forward Tracking Processor for Marlin.<br>
  * 
  * Reconstructs the tracks through the FTD <br>
@@ -101,6 +129,50 @@ typedef std::vector< IHit* > RawTrack;
  * prevents it) <br>
  * (default value 1000)
  * 
+ * @param SectorTransitionTable A table of the sector transitions of true tracks as written by StepAnalyser. If set, the sectors
+ * are connected according to this table (FTDTransitionSectorConnector) instead of connecting every sector to the neighbouring
+ * petals on the next layer (FTDSectorConnector). <br>
+ * (default value "" = use the FTDSectorConnector)
+ * 
+ * @param SectorTransitionCoverage The fraction of the transitions in the SectorTransitionTable that shall stay connected. Only
+ * the most frequent transitions needed for this are used. <br>
+ * (default value 0.999)
+ * 
+ * @param HitTimeWindow The time window [min max] (in ns) of the hits used for tracking. Hits with a time (TrackerHit::getTime())
+ * outside are dropped right when reading the event, before anything else. With integrating detectors this removes the background
+ * of the bunch crossings far from the one of the event. <br>
+ * (default value empty = use all hits)
+ * 
+ * @param MaxHitTimeDifference If not negative, two hits are only connected to a segment if their times differ by at most this
+ * (in ns). This is the 2-hit criterion Crit2_DeltaTime, applied in every round before all the other criteria. <br>
+ * (default value -1 = no time criterion)
+ * 
+ * @param SegmentBuilderThreads The number of threads connecting the hits to 1-segments (ParallelSegmentBuilder) and, with
+ * UseFlatAutomaton, lengthening the segments. The build of a round stops as soon as there are more connections than
+ * MaxConnectionsAutomaton. <br>
+ * (default value 1 = no extra threads)
+ * 
+ * @param UseFlatAutomaton Whether to run the Cellular Automaton with the FlatAutomaton, which keeps the segments in flat arrays
+ * instead of linked objects. It gives the same raw tracks as the Automaton of KiTrack. <br>
+ * (default value false)
+ * 
+ * @param SpeculativeRounds In events with more than SpeculativeRoundsMinHits hits, the rounds with the different criteria
+ * are run at the same time in up to this many threads instead of one after the other. The first (loosest) round with not
+ * too many connections is used and the tighter rounds still running are cancelled, so the tracks are the same as with
+ * the serial rounds. The rounds then write no debug output and the segments of the automaton are not drawn in CED. <br>
+ * (default value 0 = the rounds are always run one after the other)
+ * 
+ * @param SpeculativeRoundsMinHits The number of hits above which the rounds are run at the same time, see SpeculativeRounds. <br>
+ * (default value 10000)
+ * 
+ * @param ScanPoints Settings to rerun the tracking with in the same job, one scan point per entry. A point is a comma separated
+ * list of Name=value, e.g. "HNN_Omega=0.5,Crit2_RZRatio_max=1.05:1.02" (values of criteria for several rounds are separated by ":").
+ * Criteria min/max, Chi2ProbCut, HelixFitMax, HitsPerTrackMin, BestSubsetFinder, TakeBestVersionOfTrack, the HNN parameters
+ * and MaxConnectionsAutomaton can be changed. For every point the tracking runs again on the same hits (everything else, like geometry,
+ * the fitter and reading the event, is only done once) and the tracks are stored in the collection ForwardTrackCollection_scan\<i\>.
+ * A TrackingFeedbackProcessor can evaluate all of them with its parameter ScanTrackCollections. <br>
+ * (default value: no scan points)
+ * 
  * @author Robin Glattauer HEPHY, Wien
  *
  */
@@ -241,6 +313,32 @@ class ForwardTracking : public Processor {
    bool setCriteria( unsigned round );
    
    
+   /** Runs the Cellular Automaton with the current settings on the hits in _map_sector_hits, fits the track candidates,
+    * finds the best subset of them and finalises it.
+    * 
+    * @return a new collection with the tracks
+    * 
+    * @param map_hitFront_hitsBack the connections of hits on overlapping petals, see getOverlapConnectionMap()
+    */
+   LCCollectionVec* reconstructTracks( std::map< IHit* , std::vector< IHit* > >& map_hitFront_hitsBack );
+   
+   /** @return the settings a scan point can change */
+   ForwardTrackingSettings getSettings() const;
+   
+   void setSettings( const ForwardTrackingSettings& settings );
+   
+   /** Reads a scan point from Name=value,Name=value... Throws an EVENT::Exception if it can't be read. */
+   ScanPoint parseScanPoint( const std::string& point ) const;
+   
+   /** Changes the settings according to the scan point. Throws an EVENT::Exception for unknown parameters, criteria that are
+    * not in Criteria and values out of range, the settings are then left unchanged.
+    */
+   void applyScanPoint( const ScanPoint& scanPoint );
+   
+   /** @return the name of the output collection of a scan point */
+   std::string getScanCollectionName( unsigned iPoint ) const;
+   
+   
    /** @return Info on the content of _map_sector_hits. Says how many hits are in each sector */
    std::string getInfo_map_sector_hits();
    
@@ -273,6 +371,37 @@ class ForwardTracking : public Processor {
     * and the quality of the output track collection will be set to poor */
    int _maxHitsPerSector;
    
+   /** The table of sector transitions, empty = use the FTDSectorConnector */
+   std::string _sectorTransitionTable;
+   
+   /** The fraction of the transitions of the table to keep */
+   float _sectorTransitionCoverage;
+   
+   /** The time window of the hits used, empty = all hits */
+   std::vector< float > _hitTimeWindow;
+   
+   /** The maximum time difference of two connected hits, negative = no time criterion */
+   float _maxHitTimeDifference;
+   
+   /** The number of threads building the 1-segments */
+   int _segmentBuilderThreads;
+   
+   /** Whether to use the FlatAutomaton instead of the Automaton of KiTrack */
+   bool _useFlatAutomaton;
+   
+   /** The number of rounds run at the same time in busy events */
+   int _speculativeRounds;
+   
+   /** The number of hits above which the rounds are run at the same time */
+   int _speculativeRoundsMinHits;
+   
+   /** The sector connector made from the table of transitions, NULL if none is used */
+   FTDTransitionSectorConnector* _transitionSectorConnector;
+   
+   /** The points of the parameter scan as given in the steering and as read */
+   std::vector< std::string > _scanPointStrings;
+   std::vector< ScanPoint > _scanPoints;
+   
    
    // Properties for the Hopfield Neural Network
    double _HNN_Omega;
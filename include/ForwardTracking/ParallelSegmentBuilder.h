@@ -0,0 +1,105 @@
+#ifndef ParallelSegmentBuilder_h
+#define ParallelSegmentBuilder_h
+
+#include <map>
+#include <atomic>
+#include <vector>
+#include <utility>
+
+#include "KiTrack/IHit.h"
+#include "KiTrack/ISectorConnector.h"
+#include "KiTrack/Automaton.h"
+#include "Criteria/ICriterion.h"
+
+#include "FlatAutomaton.h"
+
+using namespace KiTrack;
+
+namespace KiTrackMarlin{
+   
+   
+   /** Builds the 1-segments of a Cellular Automaton like KiTrack::SegmentBuilder, but evaluates the criteria
+    * for the pairs of sectors in several threads.
+    * 
+    * Every sector with hits (together with all its target sectors) is one task for the threads. A task writes the
+    * connections it finds only into its own buffer, the buffers are merged in the order of the sectors when all
+    * threads are done. So no locks are needed and the automaton is the same as the one of the SegmentBuilder,
+    * including the order of the segments and of their parents and children.
+    * 
+    * The number of connections is counted while building. As soon as it is above the maximum, all threads stop
+    * and the automaton stays empty, so a round with too many connections doesn't have to be built to the end.
+    * 
+    * The criteria are called from several threads at the same time, so they must not save their values.
+    * 
+    * The building can also be cancelled from outside with a flag, see setCancelFlag().
+    */
+   class ParallelSegmentBuilder{
+      
+      
+   public:
+      
+      /**
+       * @param map_sector_hits the hits sorted by their sectors
+       * 
+       * @param nThreads the number of threads evaluating the criteria, 1 = everything is done in the calling thread
+       */
+      ParallelSegmentBuilder( const std::map< int , std::vector< IHit* > >& map_sector_hits, unsigned nThreads );
+      
+      /** Adds criteria that every connection of two hits must fulfill */
+      void addCriteria( const std::vector< ICriterion* >& criteria ){ _criteria.insert( _criteria.end(), criteria.begin(), criteria.end() ); }
+      
+      /** Adds a sector connector telling which sectors to look for connected hits in */
+      void addSectorConnector( ISectorConnector* sectorConnector ){ _sectorConnectors.push_back( sectorConnector ); }
+      
+      /** Sets a flag that is checked while building. If it becomes true, the building is aborted as if there were
+       * too many connections. NULL = the building can't be cancelled.
+       * A builder that can be cancelled runs next to others (see SpeculativeRounds), so it writes no debug output.
+       */
+      void setCancelFlag( const std::atomic< bool >* cancelled ){ _cancelled = cancelled; }
+      
+      /** Creates a 1-segment for every hit and connects them according to the criteria.
+       * 
+       * @param automaton an empty automaton the segments are added to
+       * 
+       * @param maxConnections if there are more connections than this, the building is aborted
+       * 
+       * @return false if the building was aborted, then nothing has been added to the automaton
+       */
+      bool get1SegAutomaton( Automaton& automaton, unsigned maxConnections );
+      
+      /** The same for a FlatAutomaton */
+      bool get1SegAutomaton( FlatAutomaton& automaton, unsigned maxConnections );
+      
+      /** @return the number of connections of the last get1SegAutomaton(), if it was aborted the number found until then */
+      unsigned getNumberOfConnections() const { return _nConnections; }
+      
+      
+   private:
+      
+      /** Creates the 1-segments and finds the connections ( parent, child ) as indices of the segments.
+       * @return false if the building was aborted, then there are no segments
+       */
+      bool buildSegments( unsigned maxConnections, std::vector< Segment* >& segments,
+                          std::vector< std::pair< unsigned, unsigned > >& connections );
+      
+      const std::map< int , std::vector< IHit* > >& _map_sector_hits;
+      
+      unsigned _nThreads;
+      
+      std::vector< ICriterion* > _criteria;
+      
+      std::vector< ISectorConnector* > _sectorConnectors;
+      
+      const std::atomic< bool >* _cancelled;
+      
+      unsigned _nConnections;
+      
+      
+   };
+   
+   
+}
+
+
+#endif
+
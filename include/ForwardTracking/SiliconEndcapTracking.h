@@ -16,7 +16,10 @@
 #include "ILDImpl/SectorSystemFTD.h"
 #include "ILDImpl/SectorSystemVXD.h"
 #include "SectorSystemEndcap.h"
+#include "EndcapSectorConnector.h"
+#include "EndcapSectorOccupancy.h"
 #include "EndcapHitSimple.h"
+#include "AutomatonRound.h"
 
 
 using namespace lcio ;
@@ -104,6 +107,44 @@ typedef std::vector< IHit* > RawTrack;
  * prevents it) <br>
  * (default value 1000)
  * 
+ * @param HitTimeWindow The time window [min max] (in ns) of the hits used for tracking. Hits with a time (TrackerHit::getTime())
+ * outside are dropped right when reading the event, before anything else. With integrating detectors this removes the background
+ * of the bunch crossings far from the one of the event. <br>
+ * (default value empty = use all hits)
+ * 
+ * @param MaxHitTimeDifference If not negative, two hits are only connected to a segment if their times differ by at most this
+ * (in ns). This is the 2-hit criterion Crit2_DeltaTime, applied in every round before all the other criteria. <br>
+ * (default value -1 = no time criterion)
+ * 
+ * @param SegmentBuilderThreads The number of threads connecting the hits to 1-segments (ParallelSegmentBuilder) and, with
+ * UseFlatAutomaton, lengthening the segments. The build of a round stops as soon as there are more connections than
+ * MaxConnectionsAutomaton. <br>
+ * (default value 1 = no extra threads)
+ * 
+ * @param UseFlatAutomaton Whether to run the Cellular Automaton with the FlatAutomaton, which keeps the segments in flat arrays
+ * instead of linked objects. It gives the same raw tracks as the Automaton of KiTrack. <br>
+ * (default value false)
+ * 
+ * @param SpeculativeRounds In events with more than SpeculativeRoundsMinHits hits, the rounds with the different criteria
+ * are run at the same time in up to this many threads instead of one after the other. The first (loosest) round with not
+ * too many connections is used and the tighter rounds still running are cancelled, so the tracks are the same as with
+ * the serial rounds. The rounds then write no debug output and the segments of the automaton are not drawn in CED. <br>
+ * (default value 0 = the rounds are always run one after the other)
+ * 
+ * @param SpeculativeRoundsMinHits The number of hits above which the rounds are run at the same time, see SpeculativeRounds. <br>
+ * (default value 10000)
+ * 
+ * @param LayerZPositions The absolute z positions in mm of all layers of the sector system (starting with 0 for the IP).
+ * If set, the phi and theta windows for connecting sectors are calculated for every pair of layers from these, the B field
+ * and ConnectorPtMin. If empty, a fixed window of +-8 phi and +-1 theta divisions is used.<br>
+ * (default value empty)
+ * 
+ * @param ConnectorPtMin The minimum pt in GeV of tracks that must still be connected by the sector windows<br>
+ * (default value 0.1)
+ * 
+ * @param ConnectorToleranceBins The number of bins added on every side of the calculated sector windows<br>
+ * (default value 1)
+ * 
  * @author Robin Glattauer HEPHY, Wien
  *
  */
@@ -247,6 +288,7 @@ class SiliconEndcapTracking : public Processor {
     * @param round The number of the round we are in. I.e. the nth time we run the Cellular Automaton.
     */
    bool setCriteria( unsigned round );
+   
   
    // void getCellID0Info(TrackerHit*& trackerHit );
    void getCellID0Info(LCCollection*& col );
@@ -296,6 +338,24 @@ class SiliconEndcapTracking : public Processor {
     * and the quality of the output track collection will be set to poor */
    int _maxHitsPerSector=0;
    
+   /** The time window of the hits used, empty = all hits */
+   std::vector< float > _hitTimeWindow;
+   
+   /** The maximum time difference of two connected hits, negative = no time criterion */
+   float _maxHitTimeDifference=-1.;
+   
+   /** The number of threads building the 1-segments */
+   int _segmentBuilderThreads=1;
+   
+   /** Whether to use the FlatAutomaton instead of the Automaton of KiTrack */
+   bool _useFlatAutomaton=false;
+   
+   /** The number of rounds run at the same time in busy events */
+   int _speculativeRounds=0;
+   
+   /** The number of hits above which the rounds are run at the same time */
+   int _speculativeRoundsMinHits=10000;
+   
    
    // Properties for the Hopfield Neural Network
    double _HNN_Omega=0.0;
@@ -330,6 +390,21 @@ class SiliconEndcapTracking : public Processor {
    // const SectorSystemFTD* _sectorSystemFTD;
    const SectorSystemEndcap* _sectorSystemEndcap=NULL;
    
+   /** The sector connector used by the SegmentBuilder, it only depends on the geometry so it is made once in init() */
+   EndcapSectorConnector* _sectorConnector=NULL;
+   
+   /** The sectors holding hits in the current event. The sector connector only returns those as targets. */
+   EndcapSectorOccupancy* _sectorOccupancy=NULL;
+   
+   /** The absolute z positions of the layers, used for the windows of the sector connector */
+   std::vector< float > _layerZPositions{};
+   
+   /** The minimum pt of tracks that the sector connector must still connect */
+   double _connectorPtMin=0.0;
+   
+   /** The number of bins added on every side of the calculated sector windows */
+   int _connectorToleranceBins=0;
+   
    
    bool _useCED=false;
    
@@ -0,0 +1,75 @@
+#ifndef SpeculativeRounds_h
+#define SpeculativeRounds_h
+
+#include <atomic>
+#include <vector>
+#include <functional>
+
+#include "KiTrack/IHit.h"
+
+using namespace KiTrack;
+
+namespace KiTrackMarlin{
+   
+   
+   /** Runs rounds that get tighter one after the other (like the rounds of criteria of the Cellular Automaton)
+    * at the same time in several threads and uses the result of the first round that succeeds. This is the result
+    * the rounds would give when run one after the other until one succeeds.
+    *
+    * The rounds are handed out to the threads in their order. A round that succeeds cancels all rounds after it,
+    * a round before it that is still running may succeed as well and then wins.
+    *
+    * A round gets a flag that becomes true when it is cancelled. It should check it now and then and give up.
+    * As the rounds run next to each other, they must not write debug output (or draw anything) while they can be cancelled.
+    */
+   class SpeculativeRounds{
+      
+      
+   public:
+      
+      /** A round.
+       *
+       * @param round the number of the round, starting from 0
+       *
+       * @param cancelled becomes true when the round isn't needed anymore
+       *
+       * @param rawTracks the tracks of the round go in here
+       *
+       * @return whether the round succeeded, false if it got cancelled
+       */
+      typedef std::function< bool( unsigned round, const std::atomic< bool >* cancelled, std::vector< std::vector< IHit* > >& rawTracks ) > Round;
+      
+      
+      /** @param nThreads the maximum number of threads to run the rounds in, 1 = the rounds are run in the calling thread */
+      SpeculativeRounds( unsigned nThreads );
+      
+      /** Runs the rounds 0 to nRounds - 1. An exception thrown by a round cancels all of them and is rethrown when all
+       * threads are done.
+       *
+       * @return false if no round succeeded, else the tracks of the first round that did are in rawTracks
+       */
+      bool run( unsigned nRounds, const Round& round, std::vector< std::vector< IHit* > >& rawTracks );
+      
+      /** @return the round whose tracks the last run() returned, the number of rounds if none succeeded */
+      unsigned getWinner() const { return _winner; }
+      
+      /** @return the number of threads used by the last run() */
+      unsigned getNumberOfThreads() const { return _nThreadsUsed; }
+      
+      
+   private:
+      
+      unsigned _nThreads;
+      
+      unsigned _nThreadsUsed;
+      
+      unsigned _winner;
+      
+      
+   };
+   
+   
+}
+
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef FeedbackSummary_h
+#define FeedbackSummary_h
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+
+
+
+/** An efficiency histogram, that keeps numerator and denominator separately, so that it can be merged exactly.
+ * 
+ * The bins are given by their edges. Bin 0 is the underflow, bin nBins+1 the overflow.
+ */
+class EfficiencyHistogram{
+   
+public:
+   
+   EfficiencyHistogram(){}
+   
+   EfficiencyHistogram( const std::string& name, const std::vector< double >& edges ):
+   _name( name ), _edges( edges ), _numerator( edges.size() + 1, 0 ), _denominator( edges.size() + 1, 0 ){}
+   
+   /** @return n equally wide bins between min and max */
+   static std::vector< double > linearEdges( unsigned n, double min, double max );
+   
+   /** @return n bins between min and max (both > 0) that are equally wide on a log scale */
+   static std::vector< double > logEdges( unsigned n, double min, double max );
+   
+   /** Counts an entry at x in the denominator and, if passed, in the numerator */
+   void fill( double x, bool passed );
+   
+   /** Adds the counts of another histogram with the same name and bins, throws std::runtime_error otherwise */
+   void add( const EfficiencyHistogram& other );
+   
+   const std::string& getName() const { return _name; }
+   const std::vector< double >& getEdges() const { return _edges; }
+   const std::vector< uint64_t >& getNumerator() const { return _numerator; }
+   const std::vector< uint64_t >& getDenominator() const { return _denominator; }
+   
+   
+private:
+   
+   friend class FeedbackSummary;
+   
+   std::string _name;
+   std::vector< double > _edges;
+   std::vector< uint64_t > _numerator;
+   std::vector< uint64_t > _denominator;
+   
+};
+
+
+
+/** The raw counters of the TrackingFeedbackProcessor summed over all events, together with efficiency histograms
+ * against pt, theta and the distance of the vertex to the IP.
+ * 
+ * As only counts are stored, summaries of jobs running on different parts of a sample can be added exactly 
+ * (see the FeedbackMerge executable) and the efficiency, ghost rate and clone rate calculated afterwards.
+ * 
+ * The summary is written in a small binary format (in the byte order of the machine) for merging, and as JSON
+ * for reading it elsewhere.
+ */
+class FeedbackSummary{
+   
+public:
+   
+   /** The names of the counters, in the order they are stored */
+   static const std::vector< std::string >& getCounterNames();
+   
+   /** An empty summary: all counters 0 and no histograms */
+   FeedbackSummary();
+   
+   /** @return the counter with the name, throws std::runtime_error if there is no such counter */
+   uint64_t& counter( const std::string& name );
+   uint64_t getCounter( const std::string& name ) const;
+   
+   void addHistogram( const EfficiencyHistogram& histogram ){ _histograms.push_back( histogram ); }
+   
+   /** @return the histogram with the name, throws std::runtime_error if there is no such histogram */
+   EfficiencyHistogram& histogram( const std::string& name );
+   
+   const std::vector< EfficiencyHistogram >& getHistograms() const { return _histograms; }
+   
+   /** Adds the counters and histograms of another summary. An empty summary takes over the histograms of the other one. */
+   void add( const FeedbackSummary& other );
+   
+   double getEfficiency() const;
+   double getGhostRate() const;
+   double getCloneRate() const;
+   
+   /** Writes the binary format, throws std::runtime_error on failure */
+   void write( const std::string& fileName ) const;
+   
+   /** Reads the binary format, throws std::runtime_error on failure */
+   static FeedbackSummary read( const std::string& fileName );
+   
+   void writeJSON( std::ostream& os ) const;
+   
+   
+private:
+   
+   std::vector< uint64_t > _counters;
+   std::vector< EfficiencyHistogram > _histograms;
+   
+   unsigned getCounterIndex( const std::string& name ) const;
+   
+};
+
+
+#endif
+
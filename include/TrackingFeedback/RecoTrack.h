@@ -6,6 +6,8 @@
 #include "MarlinTrk/IMarlinTrkSystem.h"
 #include "MarlinTrk/IMarlinTrack.h"
 
+#include "TrackFitCache.h"
+
 using namespace lcio;
 
 
@@ -40,7 +42,7 @@ class RecoTrack{
    
 public:
    
-   RecoTrack( Track* track, MarlinTrk::IMarlinTrkSystem* trkSystem ): _track( track ), _trkSystem( trkSystem )
+   RecoTrack( Track* track, TrackFitCache* fitCache ): _track( track ), _fitCache( fitCache )
       { _type = GHOST; } 
    
    Track* getTrack(){ return _track; }
@@ -78,7 +80,7 @@ protected:
    TrackType _type;
    
    
-   MarlinTrk::IMarlinTrkSystem* _trkSystem; // for fitting
+   TrackFitCache* _fitCache; // for fitting
    
    
    
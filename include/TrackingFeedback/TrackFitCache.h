@@ -0,0 +1,62 @@
+#ifndef TrackFitCache_h
+#define TrackFitCache_h
+
+#include <string>
+#include <unordered_map>
+
+#include "EVENT/Track.h"
+#include "lcio.h"
+#include "MarlinTrk/IMarlinTrkSystem.h"
+
+using namespace lcio;
+
+
+/** The result of a Kalman fit of a track, evaluated at the IP */
+struct TrackFitResult{
+   
+   /** whether the fit worked. If not, the other values are -1 */
+   bool fitOK;
+   
+   double chi2Prob;
+   double chi2;
+   int Ndf;
+   
+   /** the message of the exception, if the fit failed */
+   std::string error;
+   
+};
+
+
+/** A cache for the Kalman fits of tracks.
+ * 
+ * Every track passed to getFitResult() is fitted only the first time, after that the stored result is returned.
+ * As the tracks only live for one event, the cache has to be cleared at the start of every event.
+ */
+class TrackFitCache{
+   
+public:
+   
+   TrackFitCache( MarlinTrk::IMarlinTrkSystem* trkSystem ): _trkSystem( trkSystem ){}
+   
+   /** @return the result of the fit of the track. The track gets fitted, if this was not done before. */
+   const TrackFitResult& getFitResult( Track* track );
+   
+   /** Forgets all stored fit results */
+   void clear(){ _fitResults.clear(); }
+   
+   /** @return the number of fits that were actually done since the creation of the cache */
+   unsigned getNumberOfFits() const { return _nFits; }
+   
+private:
+   
+   MarlinTrk::IMarlinTrkSystem* _trkSystem; // for fitting
+   
+   std::unordered_map< const Track* , TrackFitResult > _fitResults{};
+   
+   unsigned _nFits{0};
+   
+};
+
+
+#endif
+
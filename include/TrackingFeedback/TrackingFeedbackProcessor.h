@@ -2,6 +2,8 @@
 #define TrackingFeedbackProcessor_h 1
 
 #include <string>
+#include <unordered_map>
+#include <fstream>
 
 #include "marlin/Processor.h"
 #include "lcio.h"
@@ -16,6 +18,8 @@
 
 #include "TrueTrack.h"
 #include "RecoTrack.h"
+#include "TrackFitCache.h"
+#include "FeedbackSummary.h"
 
 
 
@@ -41,12 +45,27 @@ using namespace marlin ;
  * @param TableFileName Name of the table file for saving the results <br>
  * (default value TrackingFeedback.csv )
  * 
+ * @param EventSummaryOutput Where the summary of every event is written: "table" (a row in the table file), 
+ * "root" (an entry in the tree "events" of the root file) or "both" <br>
+ * (default value table )
+ * 
  * @param SaveAllEventsSummary If true the results of all events are summed up and saved in the file specified under SummaryFileName <br>
  * (default value false )
  * 
  * @param SummaryFileName All events are summed up and saved in this file, if SaveAllEventsSummary == true <br>
  * (default value TrackingFeedbackSum.csv )
  * 
+ * @param MergeableSummaryFileName If not empty, the counters of all events and efficiency histograms against pt, theta and 
+ * the distance of the vertex to the IP are saved in this file (and as JSON in the same path with ".json" appended). 
+ * Summaries of several jobs can be added with the FeedbackMerge executable. <br>
+ * (default value "" )
+ * 
+ * @param ScanTrackCollections Further track collections to compare to the same true tracks, e.g. the collections of the 
+ * scan points of ForwardTracking. For each of them only the summary is kept and written in the format of MergeableSummaryFileName 
+ * to \<collection\>.summary (and \<collection\>.summary.json) in the directory of MergeableSummaryFileName, or in the current
+ * directory if that has none. ParamScan collects them with its keyword scansummary. <br>
+ * (default value: none )
+ * 
  * @param MultipleScatteringOn Whether to take multiple scattering into account when fitting the tracks<br>
  * (default value true )
  * 
@@ -143,6 +162,14 @@ class TrackingFeedbackProcessor : public Processor {
 
    
    std::string _tableFileName;
+   std::string _eventSummaryOutput;
+   
+   /** The table file stays open for the whole job, the rows of the events are collected in its buffer */
+   std::ofstream _tableFile;
+   std::vector< char > _tableFileBuffer;
+   
+   bool _writeEventTable;
+   bool _writeEventTree;
 
 
    int _nRun ;
@@ -197,18 +224,55 @@ class TrackingFeedbackProcessor : public Processor {
    bool _drawMCPTracks;
    bool _saveAllEventsSummary;
    std::string _summaryFileName;
+   
+   std::string _mergeableSummaryFileName;
+   FeedbackSummary _mergeableSummary;
+   
+   /** The further collections to compare and one summary for each of them */
+   std::vector< std::string > _scanTrackCollections;
+   std::vector< FeedbackSummary > _scanSummaries;
+   
+   /** @return an empty summary with the efficiency histograms */
+   FeedbackSummary createSummary() const;
+   
+   /** Fills the efficiency histograms of the summary for a valid true track */
+   void fillEfficiencyHistograms( FeedbackSummary& summary, const TrueTrack* trueTrack ) const;
+   
+   /** Compares the tracks of a collection to the true tracks of the event and adds the counts to the summary.
+    * The counters of the event and the relations of the true tracks to the reco tracks of the TrackCollection are
+    * not kept, so this must be done after they have been used.
+    */
+   void evaluateScanCollection( LCCollection* col, FeedbackSummary& summary );
   
    
   
    
+   /** All hits of the true tracks of the event and the true tracks they belong to. Filled once per event by fillHitTrueTrackMap() */
+   std::unordered_multimap< TrackerHit* , TrueTrack* > _map_hit_trueTracks;
+   
+   void fillHitTrueTrackMap();
+   
    void checkTheTrack( RecoTrack* recoTrack );
-   TrueTrack* getAssignedTrueTrack( std::vector<TrueTrack*> relatedTrueTracks , unsigned& nHitsFromAssignedTrueTrack );
+   
+   /** @return the true track most of the hits of a reco track belong to, or NULL if it should not be assigned
+    * 
+    * @param trueTrackCounts the true tracks related to the hits of the reco track and the number of hits from each of them
+    * 
+    * @param nRelatedHits the sum of all counts in trueTrackCounts
+    * 
+    * @param nHitsFromAssignedTrueTrack is set to the number of hits from the assigned true track
+    */
+   TrueTrack* getAssignedTrueTrack( const std::vector< std::pair< TrueTrack* , unsigned > >& trueTrackCounts , unsigned nRelatedHits , 
+                                    unsigned& nHitsFromAssignedTrueTrack );
    
    unsigned getNumberOfHitsFromDifferentLayers( std::vector< TrackerHit* > hits );
    double getDistToIP( MCParticle* mcp );
    
    MarlinTrk::IMarlinTrkSystem* _trkSystem;
    
+   /** The fits of the true and reco tracks of the current event, so that every track is fitted only once */
+   TrackFitCache* _fitCache;
+   
    TTree * _treeTrueTracks;
    TTree * _treeRecoTracks;
    TFile * _rootFile;
@@ -217,11 +281,18 @@ class TrackingFeedbackProcessor : public Processor {
    std::string _treeNameTrueTracks;
    std::string _treeNameRecoTracks;
    
+   /** The summary of every event, one entry per event */
+   TTree * _treeEvents;
+   std::string _treeNameEvents;
+   
    
    void saveRootInformation();   
    void makeRootBranches();
    void setRootBranches();
    
+   /** Gets the events tree from the root file, or creates it, if it isn't there yet */
+   void prepareEventTree( bool append );
+   
 
    float _rateOfFoundHitsMin;  //more than this number of hits of the real track must be in the reco track
    float _rateOfAssignedHitsMin;  //more than this number of hits of the reco track must belong to the assigned true track
@@ -244,11 +315,21 @@ class TrackingFeedbackProcessor : public Processor {
    int _trueTrack_Ndf;
    
    int _recoTrack_nTrueTracks;
+   int _recoTrack_type; // the TrackType of the RecoTrack
    double _recoTrack_pt;
    double _recoTrack_chi2prob;
    double _recoTrack_chi2;
    int _recoTrack_Ndf;
    
+   int _event_run;
+   int _event_event;
+   float _event_efficiency;
+   float _event_ghostrate;
+   float _event_pLost;
+   float _event_pComplete;
+   float _event_pFoundCompletely;
+   float _event_clonerate;
+   
    
 } ;
 
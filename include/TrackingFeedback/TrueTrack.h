@@ -9,6 +9,7 @@
 #include "MarlinTrk/IMarlinTrack.h"
 
 #include "RecoTrack.h"
+#include "TrackFitCache.h"
 
 using namespace lcio;
 
@@ -23,8 +24,8 @@ class TrueTrack{
 public:
    
    
-   TrueTrack( Track* trueTrack , MCParticle* mcp , MarlinTrk::IMarlinTrkSystem* trkSystem):
-   _trueTrack(trueTrack), _mcp(mcp), _trkSystem(trkSystem) {}
+   TrueTrack( Track* trueTrack , MCParticle* mcp , TrackFitCache* fitCache):
+   _trueTrack(trueTrack), _mcp(mcp), _fitCache(fitCache) {}
    
    /** @return the true track */
    Track* getTrueTrack() const { return _trueTrack; }
@@ -38,6 +39,9 @@ public:
    
    void addRecoTrack( RecoTrack* recoTrack ){ _recoTracks.push_back( recoTrack ); }
    
+   /** Forgets all related reco tracks, so the true track can be compared to another collection */
+   void clearRecoTracks(){ _recoTracks.clear(); }
+   
    
    
    
@@ -85,7 +89,7 @@ private:
    std::vector< const RecoTrack* > _recoTracks;
    std::vector< std::string > _cuts;
    
-   MarlinTrk::IMarlinTrkSystem* _trkSystem; // for fitting
+   TrackFitCache* _fitCache; // for fitting
    
    
 };
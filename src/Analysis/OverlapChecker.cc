@@ -8,6 +8,9 @@
 
 #include <EVENT/Track.h>
 
+#include <algorithm>
+#include <map>
+
 
 using namespace lcio ;
 using namespace marlin ;
@@ -55,6 +58,12 @@ void OverlapChecker::init() {
    _nRun = 0 ;
    _nEvt = 0 ;
    
+   _nTracksTotal = 0;
+   _nConflictsTotal = 0;
+   _nSharedHitsTotal = 0;
+   _nHitsSharedByMoreThanTwoTotal = 0;
+   _largestComponentMax = 0;
+   
    
 }
 
@@ -74,10 +83,6 @@ void OverlapChecker::processEvent( LCEvent * evt ) {
    LCCollection* col = evt->getCollection( _trackCollectionName ) ;
    
    unsigned nTracks = col->getNumberOfElements();
-
-   std::vector < std::vector <bool> > G; // a matrix telling, if two tracks are compatible
-   G.resize( nTracks );
-   for (unsigned i=0; i<nTracks; i++) G[i].resize( nTracks );
    
    
    std::vector< Track* > tracks;
@@ -93,51 +98,43 @@ void OverlapChecker::processEvent( LCEvent * evt ) {
    }
    
    //check their overlap
-   for( unsigned i=0; i < nTracks; i++){ //over all tracks
-      
-      
-      Track* trackA = tracks[i];  
+   std::vector< std::pair< unsigned , unsigned > > conflicts;
+   unsigned nSharedHits = 0;
+   unsigned nHitsSharedByMoreThanTwo = 0;
+   
+   findConflicts( tracks, conflicts, nSharedHits, nHitsSharedByMoreThanTwo );
+   
+   unsigned largestComponent = getLargestComponent( tracks.size(), conflicts );
+   
+   
+   //print out the conflicting pairs
+   if( streamlog::out.write< streamlog::DEBUG2 >() ){
       
+      streamlog_out( DEBUG2 ) << "\n\nConflicting tracks:";
       
-      // Fill the the G matrix. (whether two tracks are compatible or not)
-      for ( unsigned j=i+1; j < nTracks ; j++ ){ // over all tracks that come after the current one (matrix is symmetric)
+      for( unsigned i=0; i < conflicts.size(); i++ ){
          
-         Track* trackB = tracks[j]; // the track we check if it is in conflict with trackA
-         
-         if ( areCompatible( trackA , trackB ) ){ 
-            
-            G[i][j] = 0;
-            G[j][i] = 0;
-            
-         }
-         else{
-            
-            G[i][j] = 1;
-            G[j][i] = 1;            
-            
-         }
+         streamlog_out( DEBUG2 ) << "\n" << conflicts[i].first << " -- " << conflicts[i].second;
          
       }
       
+      streamlog_out( DEBUG2 ) << "\n\n";
+      
    }
    
-   //print out the matrix G
-   streamlog_out( MESSAGE0 ) << "\n\nG:";
+   streamlog_out( MESSAGE0 ) << "Event " << evt->getEventNumber() << ": "
+                             << tracks.size() << " tracks, "
+                             << conflicts.size() << " conflicting pairs, "
+                             << "largest conflict component " << largestComponent << " tracks, "
+                             << nSharedHits << " shared hits, "
+                             << nHitsSharedByMoreThanTwo << " hits shared by more than 2 tracks\n";
    
-   for( unsigned i=0; i < G.size(); i++ ){
-      
-      
-      streamlog_out( MESSAGE0 ) << "\n";
-      
-      for( unsigned j=0; j < G[i].size(); j++ ){
-         
-         
-         streamlog_out( MESSAGE0 ) << G[i][j] << "  ";
-         
-      }
-   }
    
-   streamlog_out( MESSAGE0 ) << "\n\n";
+   _nTracksTotal += tracks.size();
+   _nConflictsTotal += conflicts.size();
+   _nSharedHitsTotal += nSharedHits;
+   _nHitsSharedByMoreThanTwoTotal += nHitsSharedByMoreThanTwo;
+   _largestComponentMax = std::max( _largestComponentMax, largestComponent );
  
    
   
@@ -162,6 +159,15 @@ void OverlapChecker::check( LCEvent * ) {
 
 void OverlapChecker::end(){ 
    
+   
+   streamlog_out( MESSAGE ) << "\n\nOverlapChecker summary of " << _nEvt << " events:"
+                            << "\n   tracks: " << _nTracksTotal
+                            << "\n   conflicting pairs: " << _nConflictsTotal
+                            << "\n   largest conflict component: " << _largestComponentMax << " tracks"
+                            << "\n   shared hits: " << _nSharedHitsTotal
+                            << "\n   hits shared by more than 2 tracks: " << _nHitsSharedByMoreThanTwoTotal
+                            << "\n\n";
+   
    //   streamlog_out( DEBUG ) << "MyProcessor::end()  " << name() 
    //      << " processed " << _nEvt << " events in " << _nRun << " runs "
    //      << std::endl ;
@@ -170,24 +176,101 @@ void OverlapChecker::end(){
 
 
 
-bool OverlapChecker::areCompatible( Track* trackA , Track* trackB ){
+void OverlapChecker::findConflicts( const std::vector< Track* >& tracks , std::vector< std::pair< unsigned , unsigned > >& conflicts ,
+                                    unsigned& nSharedHits , unsigned& nHitsSharedByMoreThanTwo ) const {
+   
+   
+   conflicts.clear();
+   nSharedHits = 0;
+   nHitsSharedByMoreThanTwo = 0;
    
+   // which tracks use which hit
+   std::map< TrackerHit* , std::vector< unsigned > > hitToTracks;
+   
+   for( unsigned i=0; i < tracks.size(); i++ ){
+      
+      const std::vector< TrackerHit* >& hits = tracks[i]->getTrackerHits();
+      
+      for( unsigned j=0; j < hits.size(); j++ ){
+         
+         std::vector< unsigned >& trackIndices = hitToTracks[ hits[j] ];
+         
+         // a track could contain the same hit twice, but it is no conflict with itself
+         if( trackIndices.empty() || trackIndices.back() != i ) trackIndices.push_back( i );
+         
+      }
+      
+   }
    
-   std::vector< TrackerHit*> hitsA = trackA->getTrackerHits();
-   std::vector< TrackerHit*> hitsB = trackB->getTrackerHits();
    
+   // every hit used by more than one track makes all of its tracks conflict with each other
+   std::map< TrackerHit* , std::vector< unsigned > >::const_iterator it;
    
-   for( unsigned i=0; i < hitsA.size(); i++){
+   for( it = hitToTracks.begin(); it != hitToTracks.end(); it++ ){
       
-      for( unsigned j=0; j < hitsB.size(); j++){
+      const std::vector< unsigned >& trackIndices = it->second;
+      
+      if( trackIndices.size() < 2 ) continue;
+      
+      nSharedHits++;
+      if( trackIndices.size() > 2 ) nHitsSharedByMoreThanTwo++;
+      
+      // the indices are ascending, as the tracks were entered in order
+      for( unsigned a=0; a < trackIndices.size(); a++ ){
          
-         if ( hitsA[i] == hitsB[j] ) return false;      // a hit is shared -> incompatible
+         for( unsigned b=a+1; b < trackIndices.size(); b++ ){
+            
+            conflicts.push_back( std::make_pair( trackIndices[a], trackIndices[b] ) );
+            
+         }
          
       }
       
    }
    
-   return true;
+   
+   // two tracks sharing more than one hit are still only one conflict
+   std::sort( conflicts.begin(), conflicts.end() );
+   conflicts.erase( std::unique( conflicts.begin(), conflicts.end() ), conflicts.end() );
+   
    
 }
 
+
+unsigned OverlapChecker::getLargestComponent( unsigned nTracks , const std::vector< std::pair< unsigned , unsigned > >& conflicts ) const {
+   
+   
+   // union-find over the tracks
+   std::vector< unsigned > parent( nTracks );
+   for( unsigned i=0; i < nTracks; i++ ) parent[i] = i;
+   
+   for( unsigned i=0; i < conflicts.size(); i++ ){
+      
+      unsigned a = conflicts[i].first;
+      unsigned b = conflicts[i].second;
+      
+      while( parent[a] != a ){ parent[a] = parent[ parent[a] ]; a = parent[a]; }
+      while( parent[b] != b ){ parent[b] = parent[ parent[b] ]; b = parent[b]; }
+      
+      if( a != b ) parent[ std::max( a, b ) ] = std::min( a, b );
+      
+   }
+   
+   
+   std::vector< unsigned > componentSize( nTracks, 0 );
+   unsigned largest = 0;
+   
+   for( unsigned i=0; i < nTracks; i++ ){
+      
+      unsigned root = i;
+      while( parent[root] != root ) root = parent[root];
+      
+      componentSize[root]++;
+      largest = std::max( largest, componentSize[root] );
+      
+   }
+   
+   return largest;
+   
+   
+}
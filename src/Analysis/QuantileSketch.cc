@@ -0,0 +1,194 @@
+#include "QuantileSketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+
+QuantileSketch::QuantileSketch( unsigned k ):
+_k( std::max( k, 8u ) ), _n( 0 ), _min( std::numeric_limits< float >::max() ), _max( -std::numeric_limits< float >::max() ), _size( 0 ){
+   
+   addLevel();
+   
+}
+
+
+void QuantileSketch::addLevel(){
+   
+   
+   _levels.push_back( std::vector< float >() );
+   _odd.push_back( false );
+   
+   // the top level holds k values, every level below 2/3 of the one above (but at least 2)
+   _capacities.resize( _levels.size() );
+   _totalCapacity = 0;
+   
+   for( unsigned h=0; h < _levels.size(); h++ ){
+      
+      unsigned depth = _levels.size() - 1 - h;
+      _capacities[h] = std::max( 2u, unsigned( ceil( _k * pow( 2./3., double( depth ) ) ) ) );
+      _totalCapacity += _capacities[h];
+      
+   }
+   
+}
+
+
+void QuantileSketch::update( float x ){
+   
+   
+   _n++;
+   if( x < _min ) _min = x;
+   if( x > _max ) _max = x;
+   
+   _levels[0].push_back( x );
+   _size++;
+   
+   if( _size >= _totalCapacity ) compress();
+   
+}
+
+
+void QuantileSketch::compress(){
+   
+   
+   while( _size >= _totalCapacity ){
+      
+      for( unsigned h=0; h < _levels.size(); h++ ){
+         
+         if( _levels[h].size() < _capacities[h] ) continue;
+         
+         if( h + 1 == _levels.size() ) addLevel();
+         
+         std::vector< float >& level = _levels[h];
+         std::vector< float >& above = _levels[h+1];
+         
+         std::sort( level.begin(), level.end() );
+         
+         // with an odd number of values the last one stays on this level
+         unsigned nPairs = level.size() / 2;
+         float leftOver = level.back();
+         bool hasLeftOver = ( level.size() % 2 == 1 );
+         
+         unsigned offset = _odd[h] ? 1 : 0;
+         _odd[h] = !_odd[h];
+         
+         for( unsigned i=0; i < nPairs; i++ ) above.push_back( level[ 2*i + offset ] );
+         
+         level.clear();
+         if( hasLeftOver ) level.push_back( leftOver );
+         
+         _size -= nPairs;
+         
+         break;
+         
+      }
+      
+   }
+   
+}
+
+
+void QuantileSketch::merge( const QuantileSketch& other ){
+   
+   
+   if( other._n == 0 ) return;
+   
+   while( _levels.size() < other._levels.size() ) addLevel();
+   
+   for( unsigned h=0; h < other._levels.size(); h++ ){
+      
+      _levels[h].insert( _levels[h].end(), other._levels[h].begin(), other._levels[h].end() );
+      _size += other._levels[h].size();
+      
+   }
+   
+   _n += other._n;
+   _min = std::min( _min, other._min );
+   _max = std::max( _max, other._max );
+   
+   compress();
+   
+}
+
+
+float QuantileSketch::getQuantile( double q ) const{
+   
+   
+   if( _n == 0 ) return 0.;
+   if( q <= 0. ) return _min;
+   if( q >= 1. ) return _max;
+   
+   std::vector< std::pair< float , uint64_t > > weighted;
+   weighted.reserve( _size );
+   
+   for( unsigned h=0; h < _levels.size(); h++ )
+      for( unsigned i=0; i < _levels[h].size(); i++ ) weighted.push_back( std::make_pair( _levels[h][i], uint64_t(1) << h ) );
+   
+   std::sort( weighted.begin(), weighted.end() );
+   
+   uint64_t total = 0;
+   for( unsigned i=0; i < weighted.size(); i++ ) total += weighted[i].second;
+   
+   double rank = q * total;
+   
+   uint64_t cumulated = 0;
+   for( unsigned i=0; i < weighted.size(); i++ ){
+      
+      cumulated += weighted[i].second;
+      if( cumulated >= rank ) return weighted[i].first;
+      
+   }
+   
+   return _max;
+   
+}
+
+
+void QuantileSketch::getItems( std::vector< float >& items, std::vector< int >& levels ) const{
+   
+   
+   items.clear();
+   levels.clear();
+   
+   for( unsigned h=0; h < _levels.size(); h++ ){
+      
+      items.insert( items.end(), _levels[h].begin(), _levels[h].end() );
+      levels.insert( levels.end(), _levels[h].size(), int( h ) );
+      
+   }
+   
+}
+
+
+QuantileSketch QuantileSketch::fromItems( unsigned k, float min, float max, const std::vector< float >& items, const std::vector< int >& levels ){
+   
+   
+   QuantileSketch sketch( k );
+   
+   for( unsigned i=0; i < items.size() && i < levels.size(); i++ ){
+      
+      if( levels[i] < 0 ) continue;
+      
+      while( sketch._levels.size() <= unsigned( levels[i] ) ) sketch.addLevel();
+      
+      sketch._levels[ levels[i] ].push_back( items[i] );
+      sketch._size++;
+      sketch._n += uint64_t(1) << levels[i];
+      
+   }
+   
+   if( sketch._n > 0 ){
+      
+      sketch._min = min;
+      sketch._max = max;
+      
+   }
+   
+   sketch.compress();
+   
+   return sketch;
+   
+}
+
@@ -0,0 +1,176 @@
+#include "RootTreeWriter.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+
+
+RootTreeWriter::RootTreeWriter( const std::string& fileName, bool createNew ){
+   
+   
+   if( createNew ){
+      
+      // keep an existing file as <name>_<i>.root, like KiTrackMarlin::setUpRootFile does
+      std::string fileNamePath = fileName.substr( 0 , fileName.find_last_of( "." ) );
+      std::ifstream rf( fileName.c_str() );
+      
+      if( rf.good() ){
+         
+         rf.close();
+         
+         std::stringstream newName;
+         for( unsigned i=1; ; i++ ){
+            
+            newName.str( "" );
+            newName << fileNamePath << "_" << i << ".root";
+            
+            std::ifstream test( newName.str().c_str() );
+            if( !test.good() ) break;
+            
+         }
+         
+         rename( fileName.c_str(), newName.str().c_str() );
+         
+      }
+      
+   }
+   
+   
+   _file = new TFile( fileName.c_str(), "UPDATE" );
+   
+   if( _file->IsZombie() ){
+      
+      delete _file;
+      _file = NULL;
+      throw std::runtime_error( "RootTreeWriter: can't open the root file " + fileName );
+      
+   }
+   
+}
+
+
+RootTreeWriter::~RootTreeWriter(){
+   
+   close();
+   
+   for( unsigned i=0; i < _trees.size(); i++ ) delete _trees[i];
+   
+}
+
+
+unsigned RootTreeWriter::addTree( const std::string& treeName, const std::set< std::string >& branchNames ){
+   
+   
+   _file->cd(); // so the tree gets its baskets written to this file
+   
+   Tree* tree = new Tree;
+   tree->branchNames.assign( branchNames.begin(), branchNames.end() );
+   tree->buffer.assign( branchNames.size(), 0. );
+   
+   tree->tree = dynamic_cast< TTree* >( _file->Get( treeName.c_str() ) );
+   
+   if( tree->tree == NULL ){
+      
+      tree->tree = new TTree( treeName.c_str(), treeName.c_str() );
+      
+      for( unsigned i=0; i < tree->branchNames.size(); i++ ) 
+         tree->tree->Branch( tree->branchNames[i].c_str(), &tree->buffer[i], ( tree->branchNames[i] + "/F" ).c_str() );
+      
+   }
+   else{ // continue the existing tree
+      
+      for( unsigned i=0; i < tree->branchNames.size(); i++ ){
+         
+         if( tree->tree->GetBranch( tree->branchNames[i].c_str() ) == NULL ){
+            
+            std::string branchName = tree->branchNames[i];
+            delete tree;
+            throw std::runtime_error( "RootTreeWriter: the existing tree " + treeName + " has no branch " + branchName );
+            
+         }
+         
+         tree->tree->SetBranchAddress( tree->branchNames[i].c_str(), &tree->buffer[i] );
+         
+      }
+      
+   }
+   
+   _trees.push_back( tree );
+   
+   return _trees.size() - 1;
+   
+}
+
+
+unsigned RootTreeWriter::getSlot( unsigned tree, const std::string& branchName ) const{
+   
+   
+   int slot = findSlot( tree, branchName );
+   
+   if( slot < 0 ) 
+      throw std::runtime_error( "RootTreeWriter: the tree " + std::string( _trees[ tree ]->tree->GetName() ) + " has no branch " + branchName );
+   
+   return slot;
+   
+}
+
+
+int RootTreeWriter::findSlot( unsigned tree, const std::string& branchName ) const{
+   
+   
+   const std::vector< std::string >& names = _trees[ tree ]->branchNames;
+   
+   std::vector< std::string >::const_iterator it = std::lower_bound( names.begin(), names.end(), branchName );
+   
+   if( ( it == names.end() ) || ( *it != branchName ) ) return -1;
+   
+   return it - names.begin();
+   
+}
+
+
+void RootTreeWriter::fill( unsigned tree, const float* row ){
+   
+   
+   Tree* t = _trees[ tree ];
+   
+   if( !t->buffer.empty() ) memcpy( &t->buffer[0], row, t->buffer.size()*sizeof( float ) );
+   
+   t->tree->Fill();
+   
+}
+
+
+void RootTreeWriter::fillRows( unsigned tree, const std::vector< float >& rows ){
+   
+   
+   unsigned nBranches = getNumberOfBranches( tree );
+   if( nBranches == 0 ) return;
+   
+   for( unsigned i=0; i + nBranches <= rows.size(); i += nBranches ) fill( tree, &rows[i] );
+   
+}
+
+
+void RootTreeWriter::close(){
+   
+   
+   if( _file == NULL ) return;
+   
+   _file->cd();
+   
+   for( unsigned i=0; i < _trees.size(); i++ ) _trees[i]->tree->Write( "", TObject::kOverwrite );
+   
+   // the trees belong to the file and get deleted with it
+   _file->Close();
+   delete _file;
+   _file = NULL;
+   
+   for( unsigned i=0; i < _trees.size(); i++ ) _trees[i]->tree = NULL;
+   
+}
+
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <fstream>
 
 #include "marlin/VerbosityLevels.h"
 #include "EVENT/LCCollection.h"
@@ -16,7 +17,12 @@
 #include "TTree.h"
 #include "TFile.h"
 
+//----From DD4Hep-----------------------------
+#include "DD4hep/Detector.h"
+#include "DDRec/DetectorData.h"
+
 #include "Tools/KiTrackMarlinTools.h"
+#include "ILDImpl/FTDHit01.h"
 
 
 
@@ -24,6 +30,7 @@
 
 using namespace lcio ;
 using namespace marlin ;
+using namespace KiTrack;
 
 
 
@@ -52,6 +59,11 @@ StepAnalyser::StepAnalyser() : Processor("StepAnalyser") {
                               _rootFileName,
                               std::string("StepAnalysis.root") );
    
+   registerProcessorParameter("SectorTransitionFileName",
+                              "Name of the file for the table of sector transitions of the true tracks (empty = don't write it)",
+                              _sectorTransitionFileName,
+                              std::string("SectorTransitions.txt") );
+   
    
    
    
@@ -72,6 +84,34 @@ void StepAnalyser::init() {
    _nEvt = 0 ;
    
    
+   // The same sector system as in ForwardTracking, so the sectors of the transition table match
+   dd4hep::Detector& theDetector = dd4hep::Detector::getInstance();
+   dd4hep::DetElement ftdDE = theDetector.detector("FTD") ;
+   dd4hep::rec::ZDiskPetalsData* ftd = ftdDE.extension<dd4hep::rec::ZDiskPetalsData>() ;
+
+   int nLayers = ftd->layers.size() + 1; // we add one layer for the IP
+
+   int nModules(0),nSensors(0) ;
+
+   // make sure we take the highest number of modules / sensors available
+   for(unsigned i=0,n=ftd->layers.size() ; i<n; ++i){
+     
+     const dd4hep::rec::ZDiskPetalsData::LayerLayout& l = ftd->layers[i] ;
+
+     if( l.petalNumber > nModules ) nModules = l.petalNumber ;
+     if( l.sensorsPerPetal > nSensors ) nSensors = l.sensorsPerPetal ;
+   }
+  
+   _sectorSystemFTD = new SectorSystemFTD( nLayers, nModules , nSensors );
+   
+   IHit* virtualIPHitForward = KiTrackMarlin::createVirtualIPHit( 1 , _sectorSystemFTD );
+   IHit* virtualIPHitBackward = KiTrackMarlin::createVirtualIPHit( -1 , _sectorSystemFTD );
+   _ipSectorForward = virtualIPHitForward->getSector();
+   _ipSectorBackward = virtualIPHitBackward->getSector();
+   delete virtualIPHitForward;
+   delete virtualIPHitBackward;
+   
+   
 
       
    std::set < std::string > branchNames;
@@ -86,8 +126,14 @@ void StepAnalyser::init() {
    branchNames.insert( "pt" );  
    
    // Set up the root file with the tree and the branches
+   _rootWriter = new RootTreeWriter( _rootFileName, true );      //prepare the root file.
+   
    _treeName = "values";
-   KiTrackMarlin::setUpRootFile( _rootFileName, _treeName, branchNames );      //prepare the root file.
+   _tree = _rootWriter->addTree( _treeName, branchNames );
+   
+   _slot_lastLayerBeforeIP = _rootWriter->getSlot( _tree, "lastLayerBeforeIP" );
+   _slot_nHits             = _rootWriter->getSlot( _tree, "nHits" );
+   _slot_pt                = _rootWriter->getSlot( _tree, "pt" );
    
    
    branchNames.clear();
@@ -103,7 +149,18 @@ void StepAnalyser::init() {
    branchNames.insert("pt");
    
    _treeName2 = "hitPairs";
-   KiTrackMarlin::setUpRootFile( _rootFileName, _treeName2, branchNames , false );   
+   _tree2 = _rootWriter->addTree( _treeName2, branchNames );
+   
+   _slot2_LayerA     = _rootWriter->getSlot( _tree2, "LayerA" );
+   _slot2_LayerB     = _rootWriter->getSlot( _tree2, "LayerB" );
+   _slot2_LayerDist  = _rootWriter->getSlot( _tree2, "LayerDist" );
+   _slot2_ModuleA    = _rootWriter->getSlot( _tree2, "ModuleA" );
+   _slot2_ModuleB    = _rootWriter->getSlot( _tree2, "ModuleB" );
+   _slot2_ModuleDist = _rootWriter->getSlot( _tree2, "ModuleDist" );
+   _slot2_SensorA    = _rootWriter->getSlot( _tree2, "SensorA" );
+   _slot2_SensorB    = _rootWriter->getSlot( _tree2, "SensorB" );
+   _slot2_SensorDist = _rootWriter->getSlot( _tree2, "SensorDist" );
+   _slot2_pt         = _rootWriter->getSlot( _tree2, "pt" );
    
    
    
@@ -128,8 +185,11 @@ void StepAnalyser::processEvent( LCEvent * evt ) {
    
    int nMCTracks = col->getNumberOfElements();
 
-   std::vector < std::map < std::string , float > > rootDataVec;
-   std::vector < std::map < std::string , float > > rootDataVec2;
+   // the rows for the trees, reused for every entry
+   std::vector< float > row( _rootWriter->getNumberOfBranches( _tree ) );
+   std::vector< float > row2( _rootWriter->getNumberOfBranches( _tree2 ) );
+   
+   unsigned nHitPairs = 0;
    
    for( int i=0; i < nMCTracks; i++){ //over all tracks
       
@@ -168,18 +228,18 @@ void StepAnalyser::processEvent( LCEvent * evt ) {
          
          if( j >= 1){
             
-            std::map < std::string , float > rootData;
-            rootData["LayerA"] = prevLayer;
-            rootData["LayerB"] = layer;
-            rootData[ "LayerDist" ] = std::abs( layer - prevLayer );
-            rootData["ModuleA"] = prevModule;
-            rootData["ModuleB"] = module;
-            rootData[ "ModuleDist" ] = std::abs( module - prevModule );
-            rootData["SensorA"] = prevSensor;
-            rootData["SensorB"] = sensor;
-            rootData[ "SensorDist" ] = std::abs( sensor - prevSensor );
-            rootData["pt"] = pt;
-            rootDataVec2.push_back( rootData );
+            row2[ _slot2_LayerA ] = prevLayer;
+            row2[ _slot2_LayerB ] = layer;
+            row2[ _slot2_LayerDist ] = std::abs( layer - prevLayer );
+            row2[ _slot2_ModuleA ] = prevModule;
+            row2[ _slot2_ModuleB ] = module;
+            row2[ _slot2_ModuleDist ] = std::abs( module - prevModule );
+            row2[ _slot2_SensorA ] = prevSensor;
+            row2[ _slot2_SensorB ] = sensor;
+            row2[ _slot2_SensorDist ] = std::abs( sensor - prevSensor );
+            row2[ _slot2_pt ] = pt;
+            _rootWriter->fill( _tree2, &row2[0] );
+            nHitPairs++;
          }
          
          prevLayer = layer;
@@ -188,17 +248,57 @@ void StepAnalyser::processEvent( LCEvent * evt ) {
          
       }
       
+      
+      // The sector transitions. Hits on the same layer (overlapping petals) are no step for the sector connector,
+      // so every hit is connected to all hits on the next inner layer of the track, the innermost ones to the IP.
+      std::vector< int > sectors;
+      std::vector< int > layers;
+      for( unsigned j = 0; j < trackerHits.size() ; j++ ){
+         
+         FTDHit01 ftdHit( trackerHits[j] , _sectorSystemFTD );
+         sectors.push_back( ftdHit.getSector() );
+         layers.push_back( _sectorSystemFTD->getLayer( ftdHit.getSector() ) );
+         
+      }
+      
+      unsigned innerBegin = 0; // the hits on the next inner layer are [innerBegin, innerEnd)
+      unsigned innerEnd = 0;
+      unsigned j = 0;
+      
+      while( j < sectors.size() ){
+         
+         unsigned layerEnd = j; // the hits on this layer are [j, layerEnd)
+         while( ( layerEnd < sectors.size() ) && ( layers[layerEnd] == layers[j] ) ) layerEnd++;
+         
+         for( unsigned a = j; a < layerEnd; a++ ){
+            
+            if( innerEnd == 0 ){
+               
+               int ipSector = _sectorSystemFTD->getSide( sectors[a] ) > 0 ? _ipSectorForward : _ipSectorBackward;
+               _sectorTransitions[ std::make_pair( sectors[a], ipSector ) ]++;
+               
+            }
+            
+            for( unsigned b = innerBegin; b < innerEnd; b++ ) _sectorTransitions[ std::make_pair( sectors[a], sectors[b] ) ]++;
+            
+         }
+         
+         innerBegin = j;
+         innerEnd = layerEnd;
+         j = layerEnd;
+         
+      }
+      
       int nHits = trackerHits.size(); //Number of hits in the track
       
       
       
       
       // Store the data in a root file
-      std::map < std::string , float > rootData;
-      rootData["lastLayerBeforeIP"] = lastLayerBeforeIP;
-      rootData["nHits"] = nHits;
-      rootData["pt"] = pt;
-      rootDataVec.push_back( rootData );
+      row[ _slot_lastLayerBeforeIP ] = lastLayerBeforeIP;
+      row[ _slot_nHits ] = nHits;
+      row[ _slot_pt ] = pt;
+      _rootWriter->fill( _tree, &row[0] );
       
 
 
@@ -208,10 +308,7 @@ void StepAnalyser::processEvent( LCEvent * evt ) {
       
  
    
-   streamlog_out(DEBUG) << "Saving " << rootDataVec2.size() << "\n";
-
-   KiTrackMarlin::saveToRoot( _rootFileName, _treeName , rootDataVec );
-   KiTrackMarlin::saveToRoot( _rootFileName, _treeName2 , rootDataVec2 );
+   streamlog_out(DEBUG) << "Saved " << nHitPairs << "\n";
 
 
    //-- note: this will not be printed if compiled w/o MARLINDEBUG4=1 !
@@ -234,6 +331,29 @@ void StepAnalyser::check( LCEvent* ) {
 
 void StepAnalyser::end(){ 
    
+   _rootWriter->close();
+   delete _rootWriter;
+   _rootWriter = NULL;
+   
+   
+   if( !_sectorTransitionFileName.empty() ){
+      
+      std::ofstream transitionFile( _sectorTransitionFileName.c_str() );
+      
+      if( transitionFile ){
+         
+         KiTrackMarlin::FTDTransitionSectorConnector::writeTable( transitionFile, _sectorSystemFTD, _sectorTransitions );
+         
+         streamlog_out( MESSAGE ) << "Wrote " << _sectorTransitions.size() << " sector transitions to " << _sectorTransitionFileName << "\n";
+         
+      }
+      else streamlog_out( ERROR ) << "Can't open " << _sectorTransitionFileName << " for the sector transitions\n";
+      
+   }
+   
+   delete _sectorSystemFTD;
+   _sectorSystemFTD = NULL;
+   
    //   streamlog_out( DEBUG ) << "MyProcessor::end()  " << name() 
    //      << " processed " << _nEvt << " events in " << _nRun << " runs "
    //      << std::endl ;
@@ -2,6 +2,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
 
 #include "EVENT/LCCollection.h"
 #include "EVENT/MCParticle.h"
@@ -101,6 +105,26 @@ TrueTrackCritAnalyser::TrueTrackCritAnalyser() : Processor("TrueTrackCritAnalyse
    
    
    
+   registerProcessorParameter("QuantileSketches",
+                              "Whether to keep streaming quantile sketches of the values of the criteria and save them at the end",
+                              _makeQuantileSketches,
+                              bool(false));
+   
+   registerProcessorParameter("QuantileSketchK",
+                              "The size of the quantile sketches: the rank error of a quantile is about 1.7/k",
+                              _sketchK,
+                              int(200));
+   
+   registerProcessorParameter("WriteCritValueTrees",
+                              "Whether to save the values of the criteria of every true track in the trees 2Hit, 3Hit and 4Hit",
+                              _writeCritValueTrees,
+                              bool(true));
+   
+   registerProcessorParameter("NumberOfThreads",
+                              "The number of threads analysing the true tracks of an event in parallel",
+                              _nThreads,
+                              int(1));
+   
    registerProcessorParameter("OverlappingHitsDistMax",
                               "The maximum distance of hits from overlapping petals belonging to one track",
                               _overlappingHitsDistMax,
@@ -142,21 +166,20 @@ void TrueTrackCritAnalyser::init() {
    _nRun = 0 ;
    _nEvt = 0 ;
    
-   std::set< std::string > critNames = Criteria::getAllCriteriaNames();
+   if( _nThreads < 1 ) _nThreads = 1;
    
-   for( std::set< std::string >::iterator it = critNames.begin(); it!= critNames.end(); it++ ){
-      
-      ICriterion* crit = Criteria::createCriterion( (*it) );
-      
-      if ( crit->getType() == "2Hit" ) _crits2.push_back( crit );
-      else if ( crit->getType() == "3Hit" ) _crits3.push_back( crit );
-      else if ( crit->getType() == "4Hit" ) _crits4.push_back( crit );
-      else delete crit;
-      
-   }
+   for( int t=0; t < _nThreads; t++ ) _workers.push_back( createCritWorker() );
+   
+   // the criteria of the first worker are used to get the names of the values they calculate
+   std::vector <ICriterion*>& crits2 = _workers[0]->crits2;
+   std::vector <ICriterion*>& crits3 = _workers[0]->crits3;
+   std::vector <ICriterion*>& crits4 = _workers[0]->crits4;
 
    
    
+   _rootWriter = new RootTreeWriter( _rootFileName, _writeNewRootFile );
+   
+   
    std::set < std::string > branchNames2; //branch names of the 2-hit criteria
    std::set < std::string > branchNames3;
    std::set < std::string > branchNames4;
@@ -182,14 +205,14 @@ void TrueTrackCritAnalyser::init() {
    Segment virtual1Segment( hitVec );
    
    
-   for ( unsigned int i=0; i < _crits2 .size() ; i++ ){ //for all criteria
+   for ( unsigned int i=0; i < crits2 .size() ; i++ ){ //for all criteria
 
-      _crits2[i]->setSaveValues( true ); // so the calculated values won't just fade away, but are saved in a map
+      crits2[i]->setSaveValues( true ); // so the calculated values won't just fade away, but are saved in a map
       //get the map
-      _crits2 [i]->areCompatible( &virtual1Segment , &virtual1Segment ); // It's a bit of a cheat: we calculate it for virtual hits to get a map containing the
+      crits2 [i]->areCompatible( &virtual1Segment , &virtual1Segment ); // It's a bit of a cheat: we calculate it for virtual hits to get a map containing the
                                                                    // names of the values ( and of course values that are useless, but we don't use them here anyway)
       
-      std::map < std::string , float > newMap = _crits2 [i]->getMapOfValues();
+      std::map < std::string , float > newMap = crits2 [i]->getMapOfValues();
       std::map < std::string , float > ::iterator it;
       
       for ( it = newMap.begin() ; it != newMap.end() ; it++ ){ //over all values in the map
@@ -202,6 +225,8 @@ void TrueTrackCritAnalyser::init() {
    }
    
    
+   std::set < std::string > critValueNames2 = branchNames2;
+   
    // Also insert branches for additional information
    branchNames2.insert("PDG"); //PDG
    branchNames2.insert( "MCP_p" ); //momentum
@@ -213,7 +238,10 @@ void TrueTrackCritAnalyser::init() {
    branchNames2.insert( "theta" ); // the theta angle of the mcp
    // Set up the root file with the tree and the branches
    _treeName2 = "2Hit";
-   KiTrackMarlin::setUpRootFile( _rootFileName, _treeName2, branchNames2, _writeNewRootFile );      //prepare the root file.
+   _tree2 = _rootWriter->addTree( _treeName2, branchNames2 );
+   _slots2 = getCritTreeSlots( _tree2 );
+   _slot2_distance = _rootWriter->getSlot( _tree2, "distance" );
+   setUpSketches( _sketches2, _tree2, _treeName2, critValueNames2, _slots2.layers );
    
    
    
@@ -226,16 +254,16 @@ void TrueTrackCritAnalyser::init() {
    Segment virtual2Segment( hitVec );
    
    
-   for ( unsigned int i=0; i < _crits3 .size() ; i++ ){ //for all criteria
+   for ( unsigned int i=0; i < crits3 .size() ; i++ ){ //for all criteria
 
 
-      _crits3[i]->setSaveValues( true ); // so the calculated values won't just fade away, but are saved in a map
+      crits3[i]->setSaveValues( true ); // so the calculated values won't just fade away, but are saved in a map
 
       //get the map
-      _crits3 [i]->areCompatible( &virtual2Segment , &virtual2Segment ); // It's a bit of a cheat: we calculate it for virtual hits to get a map containing the
+      crits3 [i]->areCompatible( &virtual2Segment , &virtual2Segment ); // It's a bit of a cheat: we calculate it for virtual hits to get a map containing the
       // names of the values ( and of course values that are useless, but we don't use them here anyway)
       
-      std::map < std::string , float > newMap = _crits3 [i]->getMapOfValues();
+      std::map < std::string , float > newMap = crits3 [i]->getMapOfValues();
       std::map < std::string , float > ::iterator it;
       
       for ( it = newMap.begin() ; it != newMap.end() ; it++ ){ //over all values in the map
@@ -248,6 +276,8 @@ void TrueTrackCritAnalyser::init() {
    }
    
    
+   std::set < std::string > critValueNames3 = branchNames3;
+   
    // Also insert branches for additional information
    branchNames3.insert("PDG"); //PDG
    branchNames3.insert( "MCP_p" ); //momentum
@@ -261,7 +291,9 @@ void TrueTrackCritAnalyser::init() {
    // Set up the root file with the tree and the branches
    _treeName3 = "3Hit"; 
    
-   KiTrackMarlin::setUpRootFile( _rootFileName, _treeName3, branchNames3 , false );      //prepare the root file.
+   _tree3 = _rootWriter->addTree( _treeName3, branchNames3 );
+   _slots3 = getCritTreeSlots( _tree3 );
+   setUpSketches( _sketches3, _tree3, _treeName3, critValueNames3, _slots3.layers );
   
    
    
@@ -273,15 +305,15 @@ void TrueTrackCritAnalyser::init() {
    Segment virtual3Segment( hitVec );
    
    
-   for ( unsigned int i=0; i < _crits4 .size() ; i++ ){ //for all criteria
+   for ( unsigned int i=0; i < crits4 .size() ; i++ ){ //for all criteria
 
-      _crits4[i]->setSaveValues( true ); // so the calculated values won't just fade away, but are saved in a map
+      crits4[i]->setSaveValues( true ); // so the calculated values won't just fade away, but are saved in a map
 
       //get the map
-      _crits4 [i]->areCompatible( &virtual3Segment , &virtual3Segment ); // It's a bit of a cheat: we calculate it for virtual hits to get a map containing the
+      crits4 [i]->areCompatible( &virtual3Segment , &virtual3Segment ); // It's a bit of a cheat: we calculate it for virtual hits to get a map containing the
       // names of the values ( and of course values that are useless, but we don't use them here anyway)
       
-      std::map < std::string , float > newMap = _crits4 [i]->getMapOfValues();
+      std::map < std::string , float > newMap = crits4 [i]->getMapOfValues();
       std::map < std::string , float > ::iterator it;
       
       for ( it = newMap.begin() ; it != newMap.end() ; it++ ){ //over all values in the map
@@ -294,6 +326,8 @@ void TrueTrackCritAnalyser::init() {
    }
    
    
+   std::set < std::string > critValueNames4 = branchNames4;
+   
    // Also insert branches for additional information
    branchNames4.insert( "PDG" ); //PDG
    branchNames4.insert( "MCP_p" ); //momentum
@@ -307,7 +341,9 @@ void TrueTrackCritAnalyser::init() {
    // Set up the root file with the tree and the branches
    _treeName4 = "4Hit"; 
    
-   KiTrackMarlin::setUpRootFile( _rootFileName, _treeName4, branchNames4 , false );      //prepare the root file.
+   _tree4 = _rootWriter->addTree( _treeName4, branchNames4 );
+   _slots4 = getCritTreeSlots( _tree4 );
+   setUpSketches( _sketches4, _tree4, _treeName4, critValueNames4, _slots4.layers );
    
  
    delete virtualIPHit;
@@ -335,7 +371,20 @@ void TrueTrackCritAnalyser::init() {
    // Set up the root file with the tree and the branches
    _treeNameKalman = "KalmanFit"; 
    
-   KiTrackMarlin::setUpRootFile( _rootFileName, _treeNameKalman, branchNamesKalman , false );      //prepare the root file.
+   _treeKalman = _rootWriter->addTree( _treeNameKalman, branchNamesKalman );
+   
+   _slotsKalman.helixChi2        = _rootWriter->getSlot( _treeKalman, "helixChi2" );
+   _slotsKalman.helixNdf         = _rootWriter->getSlot( _treeKalman, "helixNdf" );
+   _slotsKalman.helixChi2OverNdf = _rootWriter->getSlot( _treeKalman, "helixChi2OverNdf" );
+   _slotsKalman.chi2Prob         = _rootWriter->getSlot( _treeKalman, "chi2Prob" );
+   _slotsKalman.chi2             = _rootWriter->getSlot( _treeKalman, "chi2" );
+   _slotsKalman.Ndf              = _rootWriter->getSlot( _treeKalman, "Ndf" );
+   _slotsKalman.nHits            = _rootWriter->getSlot( _treeKalman, "nHits" );
+   _slotsKalman.PDG              = _rootWriter->getSlot( _treeKalman, "PDG" );
+   _slotsKalman.MCP_p            = _rootWriter->getSlot( _treeKalman, "MCP_p" );
+   _slotsKalman.MCP_pt           = _rootWriter->getSlot( _treeKalman, "MCP_pt" );
+   _slotsKalman.MCP_distToIP     = _rootWriter->getSlot( _treeKalman, "MCP_distToIP" );
+   _slotsKalman.theta            = _rootWriter->getSlot( _treeKalman, "theta" );
    
  
    /**********************************************************************************************/
@@ -350,7 +399,13 @@ void TrueTrackCritAnalyser::init() {
    
    
    _treeNameHitDist = "HitDist"; 
-   KiTrackMarlin::setUpRootFile( _rootFileName, _treeNameHitDist, branchNamesHitDist , false );      //prepare the root file.
+   _treeHitDist = _rootWriter->addTree( _treeNameHitDist, branchNamesHitDist );
+   
+   _slotsHitDist.distToPrevHit = _rootWriter->getSlot( _treeHitDist, "distToPrevHit" );
+   _slotsHitDist.MCP_pt        = _rootWriter->getSlot( _treeHitDist, "MCP_pt" );
+   _slotsHitDist.PDG           = _rootWriter->getSlot( _treeHitDist, "PDG" );
+   _slotsHitDist.MCP_p         = _rootWriter->getSlot( _treeHitDist, "MCP_p" );
+   _slotsHitDist.theta         = _rootWriter->getSlot( _treeHitDist, "theta" );
    
  
    
@@ -370,12 +425,6 @@ void TrueTrackCritAnalyser::processEvent( LCEvent * evt ) {
    streamlog_out(DEBUG5) << "   processing event: " << evt->getEventNumber() 
    << "   in run:  " << evt->getRunNumber() << std::endl ;
    
-   std::vector < std::map < std::string , float > > rootDataVec2;
-   std::vector < std::map < std::string , float > > rootDataVec3;
-   std::vector < std::map < std::string , float > > rootDataVec4;
-   std::vector < std::map < std::string , float > > rootDataVecKalman;
-   std::vector < std::map < std::string , float > > rootDataVecHitDist;
-  
    // get the true tracks 
    LCCollection* col = evt->getCollection( _colNameMCTrueTracksRel ) ;
    
@@ -386,7 +435,8 @@ void TrueTrackCritAnalyser::processEvent( LCEvent * evt ) {
       int nMCTracks = col->getNumberOfElements();
 
       
-      unsigned nUsedRelations = 0;
+      // the true tracks of interest
+      std::vector< TrueTrackInfo > trueTracks;
       
       streamlog_out(DEBUG3) << "There are " << nMCTracks << " MCPTrackRelations in the collection " << _colNameMCTrueTracksRel << "\n";
       
@@ -479,328 +529,630 @@ void TrueTrackCritAnalyser::processEvent( LCEvent * evt ) {
          double theta = ( 180./M_PI ) * atan( fabs( pt / p_vec[2] ) ) ;
          
          
-         /**********************************************************************************************/
-         /*      If we reached this point the track is of interest  -> create FTDHits                  */
-         /**********************************************************************************************/
+         TrueTrackInfo info;
+         info.track    = track;
+         info.p        = p;
+         info.pt       = pt;
+         info.distToIP = distToIP;
+         info.chi2     = chi2;
+         info.Ndf      = Ndf;
+         info.chi2Prob = chi2Prob;
+         info.nHits    = nHits;
+         info.theta    = theta;
+         info.pdg      = pdg;
          
-         nUsedRelations++;
+         trueTracks.push_back( info );
          
-         std::vector <TrackerHit*> trackerHits = track->getTrackerHits();
-         // sort the hits in the track
-         sort( trackerHits.begin(), trackerHits.end(), KiTrackMarlin::compare_TrackerHit_z );
-         // now at [0] is the hit with the smallest |z| and at [1] is the one with a bigger |z| and so on
-        
-         // make FTDHits from them (because Criteria need IHit pointers and FTDHits are derrived from IHit )
-         std::vector <IHit*> hits;
-         for ( unsigned j=0; j< trackerHits.size(); j++ ) hits.push_back( new FTDHit01( trackerHits[j] , _sectorSystemFTD ) );
-         
-         
-         /**********************************************************************************************/
-         /*     Store the distances of the hits                                                        */
-         /**********************************************************************************************/
-         
-         for( unsigned j=0; j< hits.size()-1; j++ ){
-            
-            std::map < std::string , float > rootData;
-            
-            rootData[ "distToPrevHit" ] = hits[j]->distTo(hits[j+1]);
-            rootData["MCP_pt"] = pt;
-            rootData["MCP_p"] = p;
-            rootData["PDG"] = pdg;
-            rootData["theta"] = theta;
-            
-            rootDataVecHitDist.push_back( rootData );
-            
-         }         
+      }
+      
+      unsigned nUsedRelations = trueTracks.size();
+      
+      
+      /**********************************************************************************************/
+      /*                Analyse the true tracks (in parallel, if wanted)                            */
+      /**********************************************************************************************/
+      
+      // every true track gets its own rows, so the order of the output doesn't depend on the threads
+      std::vector< TrueTrackRows > rows( trueTracks.size() );
+      
+      unsigned nThreads = std::min( _workers.size(), trueTracks.size() );
+      
+      if( nThreads <= 1 ){
          
-         /**********************************************************************************************/
-         /*                Manipulate the hits (for example erase some or add some)                    */
-         /**********************************************************************************************/
+         for( unsigned i=0; i < trueTracks.size(); i++ ) analyseTrueTrack( trueTracks[i], *_workers[0], rows[i] );
          
-         ///////////////////////////////////////////////////////////////////////////////////////////////
-         // Add the IP as a hit
-         IHit* virtualIPHit = KiTrackMarlin::createVirtualIPHit(1 , _sectorSystemFTD );
+      }
+      else{
          
-         hits.insert( hits.begin() , virtualIPHit );
-         ///////////////////////////////////////////////////////////////////////////////////////////////
+         std::atomic< unsigned > nextTrack( 0 );
+         std::vector< std::thread > threads;
          
+         // an exception (e.g. from the fitter or a criterion) must not leave a thread, it is rethrown after the join
+         std::mutex exceptionMutex;
+         std::exception_ptr exception;
          
-         ///////////////////////////////////////////////////////////////////////////////////////////////
-         //Erase hits that are too close. For those will be from overlapping petals
-         for ( unsigned j=1; j < hits.size() ; j++ ){
-            
-            IHit* hitA = hits[j-1];
-            IHit* hitB = hits[j];
+         for( unsigned t=0; t < nThreads; t++ ){
             
-            float dist = hitA->distTo( hitB );
+            CritWorker* worker = _workers[t];
             
-            if( dist < _overlappingHitsDistMax ){
+            threads.push_back( std::thread( [ this, worker, &trueTracks, &rows, &nextTrack, &exceptionMutex, &exception ](){
                
-               hits.erase( hits.begin() + j );
-               j--;
+               try{
+                  
+                  for( unsigned i = nextTrack++; i < trueTracks.size(); i = nextTrack++ ) analyseTrueTrack( trueTracks[i], *worker, rows[i] );
+                  
+               }
+               catch( ... ){
+                  
+                  std::lock_guard< std::mutex > lock( exceptionMutex );
+                  if( !exception ) exception = std::current_exception();
+                  nextTrack = trueTracks.size(); // the other threads stop after their current track
+                  
+               }
                
-            }               
+            } ) );
             
          }
-         ///////////////////////////////////////////////////////////////////////////////////////////////
          
-         /**********************************************************************************************/
-         /*                Build the segments                                                          */
-         /**********************************************************************************************/
-         
-         // Now we have a vector of hits starting with the IP followed by all (or most) hits from the track.
-         // So we now are able to build segments from them
+         for( unsigned t=0; t < threads.size(); t++ ) threads[t].join();
          
-         std::vector <Segment*> segments1; // 1-hit segments
+         if( exception ) std::rethrow_exception( exception );
          
-         for ( unsigned j=0; j < hits.size(); j++ ){
-            
-            
-            std::vector <IHit*> segHits;
-            segHits.insert( segHits.begin() , hits.begin()+j , hits.begin()+j+1 );
-            
-            segments1.push_back( new Segment( segHits ) );
-            
-         }
-         
-         std::vector <Segment*> segments2; // 2-hit segments
+      }
+      
+      
+      /**********************************************************************************************/
+      /*                Save all the data to ROOT, in the order of the true tracks                  */
+      /**********************************************************************************************/
+      
+      for( unsigned i=0; i < rows.size(); i++ ){
          
-         for ( unsigned j=0; j < hits.size()-1; j++ ){
-            
-            
-            std::vector <IHit*> segHits;
+         if( _makeQuantileSketches ){
             
-            segHits.push_back( hits[j] );
-            segHits.push_back( hits[j+1] );
-            
-            
-            segments2.push_back( new Segment( segHits ) );
+            updateSketches( _sketches2, rows[i].rows2 );
+            updateSketches( _sketches3, rows[i].rows3 );
+            updateSketches( _sketches4, rows[i].rows4 );
             
          }
          
-         std::vector <Segment*> segments3; // 3-hit segments
-         
-         for ( unsigned j=0; j < hits.size()-2; j++ ){
-            
-            
-            std::vector <IHit*> segHits;
+         if( _writeCritValueTrees ){
             
-            segHits.push_back( hits[j] );
-            segHits.push_back( hits[j+1] );
-            segHits.push_back( hits[j+2] );
-            
-            segments3.push_back( new Segment( segHits ) );
+            _rootWriter->fillRows( _tree2, rows[i].rows2 );
+            _rootWriter->fillRows( _tree3, rows[i].rows3 );
+            _rootWriter->fillRows( _tree4, rows[i].rows4 );
             
          }
+         _rootWriter->fillRows( _treeKalman, rows[i].rowsKalman );
+         _rootWriter->fillRows( _treeHitDist, rows[i].rowsHitDist );
          
-         // Now we have the segments of the track (ordered) in the vector
-         
-         /**********************************************************************************************/
-         /*                Use the criteria on the segments                                            */
-         /**********************************************************************************************/
-         
-         
-         for ( unsigned j=0; j < segments1.size()-1; j++ ){
-            
-            // the data that will get stored
-            std::map < std::string , float > rootData;
-            
-            //make the check on the segments, store it in the the map...
-            Segment* child = segments1[j];
-            Segment* parent = segments1[j+1];
-            
-            
-            for( unsigned iCrit=0; iCrit < _crits2 .size(); iCrit++){ // over all criteria
+      }
+      
+      
+      
+      streamlog_out (DEBUG5) << "Number of used mcp-track relations: " << nUsedRelations <<"\n";
+    
+   }
+ 
 
-               
-               //get the map
-               _crits2 [iCrit]->areCompatible( parent , child ); //calculate their compatibility
-               
-               std::map < std::string , float > newMap = _crits2 [iCrit]->getMapOfValues(); //get the values that were calculated
-               
-               rootData.insert( newMap.begin() , newMap.end() );
-               
-            }
-            
-            rootData["MCP_p"] = p;
-            rootData["MCP_pt"] = pt;
-            rootData["MCP_distToIP"] = distToIP;
-            rootData["chi2Prob"] = chi2Prob;
-            rootData["layers"] = child->getHits()[0]->getLayer() *10 + parent->getHits()[0]->getLayer();
-            rootData["PDG"] = pdg;
-            rootData["theta"] = theta;
-            
-            
-            IHit* childHit = child->getHits()[0];
-            IHit* parentHit = parent->getHits()[0];
-            float dx = childHit->getX() - parentHit->getX();
-            float dy = childHit->getY() - parentHit->getY();
-            float dz = childHit->getZ() - parentHit->getZ();
-            rootData["distance"] = sqrt( dx*dx + dy*dy + dz*dz );
-            
-            rootDataVec2.push_back( rootData );
-            
-         }
-         
-         
-         for ( unsigned j=0; j < segments2.size()-1; j++ ){
-            
-            // the data that will get stored
-            std::map < std::string , float > rootData;
-            
-            //make the check on the segments, store it in the the map...
-            Segment* child = segments2[j];
-            Segment* parent = segments2[j+1];
-            
-            
-            for( unsigned iCrit=0; iCrit < _crits3 .size(); iCrit++){ // over all criteria
 
-               
-               //get the map
-               _crits3 [iCrit]->areCompatible( parent , child ); //calculate their compatibility
-               
-               std::map < std::string , float > newMap = _crits3 [iCrit]->getMapOfValues(); //get the values that were calculated
-               
-               rootData.insert( newMap.begin() , newMap.end() );
-               
-            }
-            
-            rootData["MCP_p"] = p;
-            rootData["MCP_pt"] = pt;
-            rootData["MCP_distToIP"] = distToIP;
-            rootData["chi2Prob"] = chi2Prob;
-            rootData["layers"] = child->getHits()[1]->getLayer() *100 +
-                                 child->getHits()[0]->getLayer() *10 + 
-                                 parent->getHits()[0]->getLayer();
-            rootData["PDG"] = pdg;
-            rootData["theta"] = theta;
-            
-            
-            rootDataVec3.push_back( rootData );
-            
-         }
-         
-         
-         for ( unsigned j=0; j < segments3.size()-1; j++ ){
-            
-            // the data that will get stored
-            std::map < std::string , float > rootData;
-            
-            //make the check on the segments, store it in the the map...
-            Segment* child = segments3[j];
-            Segment* parent = segments3[j+1];
-            
-            
-            for( unsigned iCrit=0; iCrit < _crits4 .size(); iCrit++){ // over all criteria
 
-               
-               //get the map
-               _crits4 [iCrit]->areCompatible( parent , child ); //calculate their compatibility
-               
-               std::map < std::string , float > newMap = _crits4 [iCrit]->getMapOfValues(); //get the values that were calculated
-               
-               rootData.insert( newMap.begin() , newMap.end() );
-               
-            }
-            
-            rootData["MCP_p"] = p;
-            rootData["MCP_pt"] = pt;
-            rootData["MCP_distToIP"] = distToIP;
-            rootData["chi2Prob"] = chi2Prob;
-            rootData["layers"] = child->getHits()[2]->getLayer() *1000 +
-                                 child->getHits()[1]->getLayer() *100 +
-                                 child->getHits()[0]->getLayer() *10 + 
-                                 parent->getHits()[0]->getLayer();
-            rootData["PDG"] = pdg;
-            rootData["theta"] = theta;
-            
-            
-            rootDataVec4.push_back( rootData );
-            
-         }
+
+   _nEvt ++ ;
+   
+   
+}
+
+
+
+void TrueTrackCritAnalyser::analyseTrueTrack( const TrueTrackInfo& info, CritWorker& worker, TrueTrackRows& rows ) const{
+   
+   
+   Track* track = info.track;
+   double p = info.p;
+   double pt = info.pt;
+   double distToIP = info.distToIP;
+   double chi2 = info.chi2;
+   double Ndf = info.Ndf;
+   double chi2Prob = info.chi2Prob;
+   int nHits = info.nHits;
+   double theta = info.theta;
+   double pdg = info.pdg;
+   
+   // the rows for the trees, reused for every entry
+   std::vector< float > row2( _rootWriter->getNumberOfBranches( _tree2 ) );
+   std::vector< float > row3( _rootWriter->getNumberOfBranches( _tree3 ) );
+   std::vector< float > row4( _rootWriter->getNumberOfBranches( _tree4 ) );
+   std::vector< float > rowKalman( _rootWriter->getNumberOfBranches( _treeKalman ) );
+   std::vector< float > rowHitDist( _rootWriter->getNumberOfBranches( _treeHitDist ) );
+   
+   
+   /**********************************************************************************************/
+   /*                Create FTDHits                                                              */
+   /**********************************************************************************************/
+   
+   std::vector <TrackerHit*> trackerHits = track->getTrackerHits();
+   // sort the hits in the track
+   sort( trackerHits.begin(), trackerHits.end(), KiTrackMarlin::compare_TrackerHit_z );
+   // now at [0] is the hit with the smallest |z| and at [1] is the one with a bigger |z| and so on
+  
+   // make FTDHits from them (because Criteria need IHit pointers and FTDHits are derrived from IHit )
+   std::vector <IHit*> hits;
+   for ( unsigned j=0; j< trackerHits.size(); j++ ) hits.push_back( new FTDHit01( trackerHits[j] , _sectorSystemFTD ) );
+   
+   
+   /**********************************************************************************************/
+   /*     Store the distances of the hits                                                        */
+   /**********************************************************************************************/
+   
+   for( unsigned j=0; j< hits.size()-1; j++ ){
+      
+      rowHitDist[ _slotsHitDist.distToPrevHit ] = hits[j]->distTo(hits[j+1]);
+      rowHitDist[ _slotsHitDist.MCP_pt ] = pt;
+      rowHitDist[ _slotsHitDist.MCP_p ] = p;
+      rowHitDist[ _slotsHitDist.PDG ] = pdg;
+      rowHitDist[ _slotsHitDist.theta ] = theta;
+      
+      rows.rowsHitDist.insert( rows.rowsHitDist.end(), rowHitDist.begin(), rowHitDist.end() );
+      
+   }         
+   
+   /**********************************************************************************************/
+   /*                Manipulate the hits (for example erase some or add some)                    */
+   /**********************************************************************************************/
+   
+   ///////////////////////////////////////////////////////////////////////////////////////////////
+   // Add the IP as a hit
+   IHit* virtualIPHit = KiTrackMarlin::createVirtualIPHit(1 , _sectorSystemFTD );
+   
+   hits.insert( hits.begin() , virtualIPHit );
+   ///////////////////////////////////////////////////////////////////////////////////////////////
+   
+   
+   ///////////////////////////////////////////////////////////////////////////////////////////////
+   //Erase hits that are too close. For those will be from overlapping petals
+   for ( unsigned j=1; j < hits.size() ; j++ ){
+      
+      IHit* hitA = hits[j-1];
+      IHit* hitB = hits[j];
+      
+      float dist = hitA->distTo( hitB );
+      
+      if( dist < _overlappingHitsDistMax ){
          
+         hits.erase( hits.begin() + j );
+         j--;
          
+      }               
+      
+   }
+   ///////////////////////////////////////////////////////////////////////////////////////////////
+   
+   /**********************************************************************************************/
+   /*                Build the segments                                                          */
+   /**********************************************************************************************/
+   
+   // Now we have a vector of hits starting with the IP followed by all (or most) hits from the track.
+   // So we now are able to build segments from them
+   
+   std::vector <Segment*> segments1; // 1-hit segments
+   
+   for ( unsigned j=0; j < hits.size(); j++ ){
+      
+      
+      std::vector <IHit*> segHits;
+      segHits.insert( segHits.begin() , hits.begin()+j , hits.begin()+j+1 );
+      
+      segments1.push_back( new Segment( segHits ) );
+      
+   }
+   
+   std::vector <Segment*> segments2; // 2-hit segments
+   
+   for ( unsigned j=0; j < hits.size()-1; j++ ){
+      
+      
+      std::vector <IHit*> segHits;
+      
+      segHits.push_back( hits[j] );
+      segHits.push_back( hits[j+1] );
+      
+      
+      segments2.push_back( new Segment( segHits ) );
+      
+   }
+   
+   std::vector <Segment*> segments3; // 3-hit segments
+   
+   for ( unsigned j=0; j < hits.size()-2; j++ ){
+      
+      
+      std::vector <IHit*> segHits;
+      
+      segHits.push_back( hits[j] );
+      segHits.push_back( hits[j+1] );
+      segHits.push_back( hits[j+2] );
+      
+      segments3.push_back( new Segment( segHits ) );
+      
+   }
+   
+   // Now we have the segments of the track (ordered) in the vector
+   
+   /**********************************************************************************************/
+   /*                Use the criteria on the segments                                            */
+   /**********************************************************************************************/
+   
+   
+   for ( unsigned j=0; j < segments1.size()-1; j++ ){
+      
+      // the data that will get stored
+      std::fill( row2.begin(), row2.end(), 0. );
+      
+      //make the check on the segments, store it in the the row...
+      Segment* child = segments1[j];
+      Segment* parent = segments1[j+1];
+      
+      
+      for( unsigned iCrit=0; iCrit < worker.crits2.size(); iCrit++){ // over all criteria
+
          
-         /**********************************************************************************************/
-         /*                Save the fit of the track                                                   */
-         /**********************************************************************************************/
+         worker.crits2[iCrit]->areCompatible( parent , child ); //calculate their compatibility
          
+         storeCritValues( worker.crits2[iCrit], worker.valueSlots2[iCrit], _tree2, &row2[0] ); //store the values that were calculated
          
-         std::map < std::string , float > rootDataFit;
+      }
+      
+      row2[ _slots2.MCP_p ] = p;
+      row2[ _slots2.MCP_pt ] = pt;
+      row2[ _slots2.MCP_distToIP ] = distToIP;
+      row2[ _slots2.chi2Prob ] = chi2Prob;
+      row2[ _slots2.layers ] = child->getHits()[0]->getLayer() *10 + parent->getHits()[0]->getLayer();
+      row2[ _slots2.PDG ] = pdg;
+      row2[ _slots2.theta ] = theta;
+      
+      
+      IHit* childHit = child->getHits()[0];
+      IHit* parentHit = parent->getHits()[0];
+      float dx = childHit->getX() - parentHit->getX();
+      float dy = childHit->getY() - parentHit->getY();
+      float dz = childHit->getZ() - parentHit->getZ();
+      row2[ _slot2_distance ] = sqrt( dx*dx + dy*dy + dz*dz );
+      
+      rows.rows2.insert( rows.rows2.end(), row2.begin(), row2.end() );
+      
+   }
+   
+   
+   for ( unsigned j=0; j < segments2.size()-1; j++ ){
+      
+      // the data that will get stored
+      std::fill( row3.begin(), row3.end(), 0. );
+      
+      //make the check on the segments, store it in the the row...
+      Segment* child = segments2[j];
+      Segment* parent = segments2[j+1];
+      
+      
+      for( unsigned iCrit=0; iCrit < worker.crits3.size(); iCrit++){ // over all criteria
+
          
+         worker.crits3[iCrit]->areCompatible( parent , child ); //calculate their compatibility
          
-         rootDataFit[ "chi2" ]          = chi2;
-         rootDataFit[ "Ndf" ]           = Ndf;
-         rootDataFit[ "nHits" ]         = nHits;
-         rootDataFit[ "chi2Prob" ]      = chi2Prob;
+         storeCritValues( worker.crits3[iCrit], worker.valueSlots3[iCrit], _tree3, &row3[0] ); //store the values that were calculated
          
-         rootDataFit["MCP_p"] = p;
-         rootDataFit["MCP_pt"] = pt;
-         rootDataFit["MCP_distToIP"] = distToIP;
-         rootDataFit["PDG"] = pdg;
-         rootDataFit["theta"] = theta;
+      }
+      
+      row3[ _slots3.MCP_p ] = p;
+      row3[ _slots3.MCP_pt ] = pt;
+      row3[ _slots3.MCP_distToIP ] = distToIP;
+      row3[ _slots3.chi2Prob ] = chi2Prob;
+      row3[ _slots3.layers ] = child->getHits()[1]->getLayer() *100 +
+                               child->getHits()[0]->getLayer() *10 + 
+                               parent->getHits()[0]->getLayer();
+      row3[ _slots3.PDG ] = pdg;
+      row3[ _slots3.theta ] = theta;
+      
+      
+      rows.rows3.insert( rows.rows3.end(), row3.begin(), row3.end() );
+      
+   }
+   
+   
+   for ( unsigned j=0; j < segments3.size()-1; j++ ){
+      
+      // the data that will get stored
+      std::fill( row4.begin(), row4.end(), 0. );
+      
+      //make the check on the segments, store it in the the row...
+      Segment* child = segments3[j];
+      Segment* parent = segments3[j+1];
+      
+      
+      for( unsigned iCrit=0; iCrit < worker.crits4.size(); iCrit++){ // over all criteria
+
          
+         worker.crits4[iCrit]->areCompatible( parent , child ); //calculate their compatibility
          
-         FTDHelixFitter helixFitter( track );
-         float helixChi2 = helixFitter.getChi2();
-         float helixNdf  = helixFitter.getNdf();
+         storeCritValues( worker.crits4[iCrit], worker.valueSlots4[iCrit], _tree4, &row4[0] ); //store the values that were calculated
          
-         rootDataFit["helixChi2"] = helixChi2;
-         rootDataFit["helixNdf"] = helixNdf;
-         rootDataFit["helixChi2OverNdf"] = helixChi2 / helixNdf;
+      }
+      
+      row4[ _slots4.MCP_p ] = p;
+      row4[ _slots4.MCP_pt ] = pt;
+      row4[ _slots4.MCP_distToIP ] = distToIP;
+      row4[ _slots4.chi2Prob ] = chi2Prob;
+      row4[ _slots4.layers ] = child->getHits()[2]->getLayer() *1000 +
+                               child->getHits()[1]->getLayer() *100 +
+                               child->getHits()[0]->getLayer() *10 + 
+                               parent->getHits()[0]->getLayer();
+      row4[ _slots4.PDG ] = pdg;
+      row4[ _slots4.theta ] = theta;
+      
+      
+      rows.rows4.insert( rows.rows4.end(), row4.begin(), row4.end() );
+      
+   }
+   
+   
+   
+   /**********************************************************************************************/
+   /*                Save the fit of the track                                                   */
+   /**********************************************************************************************/
+   
+   
+   rowKalman[ _slotsKalman.chi2 ]          = chi2;
+   rowKalman[ _slotsKalman.Ndf ]           = Ndf;
+   rowKalman[ _slotsKalman.nHits ]         = nHits;
+   rowKalman[ _slotsKalman.chi2Prob ]      = chi2Prob;
+   
+   rowKalman[ _slotsKalman.MCP_p ] = p;
+   rowKalman[ _slotsKalman.MCP_pt ] = pt;
+   rowKalman[ _slotsKalman.MCP_distToIP ] = distToIP;
+   rowKalman[ _slotsKalman.PDG ] = pdg;
+   rowKalman[ _slotsKalman.theta ] = theta;
+   
+   
+   FTDHelixFitter helixFitter( track );
+   float helixChi2 = helixFitter.getChi2();
+   float helixNdf  = helixFitter.getNdf();
+   
+   rowKalman[ _slotsKalman.helixChi2 ] = helixChi2;
+   rowKalman[ _slotsKalman.helixNdf ] = helixNdf;
+   rowKalman[ _slotsKalman.helixChi2OverNdf ] = helixChi2 / helixNdf;
+   
+   
+   rows.rowsKalman.insert( rows.rowsKalman.end(), rowKalman.begin(), rowKalman.end() );
+   
+   
+   
+   
+   /**********************************************************************************************/
+   /*                Clean up                                                                    */
+   /**********************************************************************************************/
+   
+   for (unsigned j=0; j<segments1.size(); j++) delete segments1[j];
+   segments1.clear();
+   for (unsigned j=0; j<segments2.size(); j++) delete segments2[j];
+   segments2.clear();
+   for (unsigned j=0; j<segments3.size(); j++) delete segments3[j];
+   segments3.clear();
+   for (unsigned j=0; j<hits.size(); j++) delete hits[j];
+   hits.clear();
+   
+   
+}
+
+
+void TrueTrackCritAnalyser::setUpSketches( CritTreeSketches& sketches, unsigned tree, const std::string& treeName, 
+                                           const std::set< std::string >& valueNames, unsigned layersSlot ){
+   
+   
+   sketches.tree = tree;
+   sketches.treeName = treeName;
+   sketches.layersSlot = layersSlot;
+   
+   sketches.names.assign( valueNames.begin(), valueNames.end() );
+   sketches.slots.clear();
+   for( unsigned i=0; i < sketches.names.size(); i++ ) sketches.slots.push_back( _rootWriter->getSlot( tree, sketches.names[i] ) );
+   
+   sketches.all.assign( sketches.names.size(), QuantileSketch( _sketchK ) );
+   sketches.perLayers.clear();
+   
+}
+
+
+void TrueTrackCritAnalyser::updateSketches( CritTreeSketches& sketches, const std::vector< float >& rows ){
+   
+   
+   unsigned nBranches = _rootWriter->getNumberOfBranches( sketches.tree );
+   
+   for( unsigned iRow=0; iRow + nBranches <= rows.size(); iRow += nBranches ){
+      
+      const float* row = &rows[ iRow ];
+      
+      int layers = int( row[ sketches.layersSlot ] );
+      
+      std::map< int , std::vector< QuantileSketch > >::iterator it = sketches.perLayers.find( layers );
+      if( it == sketches.perLayers.end() ) 
+         it = sketches.perLayers.insert( std::make_pair( layers, std::vector< QuantileSketch >( sketches.names.size(), QuantileSketch( _sketchK ) ) ) ).first;
+      
+      std::vector< QuantileSketch >& layerSketches = it->second;
+      
+      for( unsigned i=0; i < sketches.slots.size(); i++ ){
          
+         float value = row[ sketches.slots[i] ];
          
-         rootDataVecKalman.push_back( rootDataFit );
+         sketches.all[i].update( value );
+         layerSketches[i].update( value );
          
+      }
+      
+   }
+   
+}
+
+
+void TrueTrackCritAnalyser::writeSketches(){
+   
+   
+   TFile* file = _rootWriter->getFile();
+   file->cd();
+   
+   TTree* tree = new TTree( "QuantileSketches", "QuantileSketches" );
+   
+   std::string critType;
+   std::string valueName;
+   int layers;
+   Long64_t n;
+   int k;
+   float min;
+   float max;
+   std::vector< float > items;
+   std::vector< int > levels;
+   
+   tree->Branch( "critType", &critType );
+   tree->Branch( "valueName", &valueName );
+   tree->Branch( "layers", &layers ); // -1 for all combinations of layers
+   tree->Branch( "n", &n );
+   tree->Branch( "k", &k );
+   tree->Branch( "min", &min );
+   tree->Branch( "max", &max );
+   tree->Branch( "items", &items );
+   tree->Branch( "levels", &levels );
+   
+   CritTreeSketches* allSketches[] = { &_sketches2, &_sketches3, &_sketches4 };
+   
+   for( unsigned iTree=0; iTree < 3; iTree++ ){
+      
+      CritTreeSketches& sketches = *allSketches[ iTree ];
+      
+      critType = sketches.treeName;
+      
+      for( unsigned i=0; i < sketches.names.size(); i++ ){
          
+         valueName = sketches.names[i];
          
+         std::vector< std::pair< int , const QuantileSketch* > > toWrite;
+         toWrite.push_back( std::make_pair( -1, &sketches.all[i] ) );
          
-         /**********************************************************************************************/
-         /*                Clean up                                                                    */
-         /**********************************************************************************************/
+         std::map< int , std::vector< QuantileSketch > >::const_iterator it;
+         for( it = sketches.perLayers.begin(); it != sketches.perLayers.end(); ++it ) toWrite.push_back( std::make_pair( it->first, &it->second[i] ) );
          
-         for (unsigned j=0; j<segments1.size(); j++) delete segments1[j];
-         segments1.clear();
-         for (unsigned j=0; j<segments2.size(); j++) delete segments2[j];
-         segments2.clear();
-         for (unsigned j=0; j<segments3.size(); j++) delete segments3[j];
-         segments3.clear();
-         for (unsigned j=0; j<hits.size(); j++) delete hits[j];
-         hits.clear();
+         for( unsigned j=0; j < toWrite.size(); j++ ){
+            
+            const QuantileSketch* sketch = toWrite[j].second;
+            
+            layers = toWrite[j].first;
+            n = sketch->getN();
+            k = sketch->getK();
+            min = sketch->getMin();
+            max = sketch->getMax();
+            sketch->getItems( items, levels );
+            
+            tree->Fill();
+            
+         }
          
+         streamlog_out( DEBUG4 ) << critType << " " << valueName << ": n = " << sketches.all[i].getN() 
+                                 << ", 1% quantile = " << sketches.all[i].getQuantile( 0.01 ) 
+                                 << ", 99% quantile = " << sketches.all[i].getQuantile( 0.99 ) << "\n";
          
-       
       }
       
+   }
+   
+   tree->Write( "", TObject::kOverwrite );
+   
+   streamlog_out( MESSAGE ) << "Saved " << tree->GetEntries() << " quantile sketches in " << _rootFileName << "\n";
+   
+}
+
+
+TrueTrackCritAnalyser::CritWorker::~CritWorker(){
+   
+   for (unsigned i=0; i<crits2.size(); i++) delete crits2[i];
+   for (unsigned i=0; i<crits3.size(); i++) delete crits3[i];
+   for (unsigned i=0; i<crits4.size(); i++) delete crits4[i];
+   
+}
+
+
+TrueTrackCritAnalyser::CritWorker* TrueTrackCritAnalyser::createCritWorker() const{
+   
+   
+   CritWorker* worker = new CritWorker;
+   
+   std::set< std::string > critNames = Criteria::getAllCriteriaNames();
+   
+   for( std::set< std::string >::iterator it = critNames.begin(); it!= critNames.end(); it++ ){
       
+      ICriterion* crit = Criteria::createCriterion( (*it) );
       
-      /**********************************************************************************************/
-      /*                Save all the data to ROOT                                                   */
-      /**********************************************************************************************/
-      
-      
-      KiTrackMarlin::saveToRoot( _rootFileName, _treeName2, rootDataVec2 );
-      KiTrackMarlin::saveToRoot( _rootFileName, _treeName3, rootDataVec3 );
-      KiTrackMarlin::saveToRoot( _rootFileName, _treeName4, rootDataVec4 );
-      KiTrackMarlin::saveToRoot( _rootFileName, _treeNameKalman, rootDataVecKalman );
-      KiTrackMarlin::saveToRoot( _rootFileName, _treeNameHitDist, rootDataVecHitDist );
+      if ( crit->getType() == "2Hit" ) worker->crits2.push_back( crit );
+      else if ( crit->getType() == "3Hit" ) worker->crits3.push_back( crit );
+      else if ( crit->getType() == "4Hit" ) worker->crits4.push_back( crit );
+      else{
+         
+         delete crit;
+         continue;
+         
+      }
       
+      crit->setSaveValues( true ); // so the calculated values won't just fade away, but are saved in a map
       
-      streamlog_out (DEBUG5) << "Number of used mcp-track relations: " << nUsedRelations <<"\n";
-    
    }
- 
+   
+   worker->valueSlots2.assign( worker->crits2.size(), ValueSlots() );
+   worker->valueSlots3.assign( worker->crits3.size(), ValueSlots() );
+   worker->valueSlots4.assign( worker->crits4.size(), ValueSlots() );
+   
+   return worker;
+   
+}
 
 
+void TrueTrackCritAnalyser::storeCritValues( ICriterion* crit, ValueSlots& valueSlots, unsigned tree, float* row ) const{
+   
+   
+   std::map < std::string , float > values = crit->getMapOfValues();
+   
+   unsigned k = 0;
+   for( std::map < std::string , float >::const_iterator it = values.begin(); it != values.end(); ++it, k++ ){
+      
+      // a criterion usually calculates the same values every time, so this lookup is only done once
+      if( ( k >= valueSlots.size() ) || ( valueSlots[k].first != it->first ) ){
+         
+         if( k >= valueSlots.size() ) valueSlots.resize( k+1 );
+         valueSlots[k] = std::make_pair( it->first, _rootWriter->findSlot( tree, it->first ) );
+         
+      }
+      
+      if( valueSlots[k].second >= 0 ) row[ valueSlots[k].second ] = it->second;
+      
+   }
+   
+   
+}
 
 
-   _nEvt ++ ;
+TrueTrackCritAnalyser::CritTreeSlots TrueTrackCritAnalyser::getCritTreeSlots( unsigned tree ) const{
+   
    
+   CritTreeSlots slots;
+   
+   slots.MCP_p        = _rootWriter->getSlot( tree, "MCP_p" );
+   slots.MCP_pt       = _rootWriter->getSlot( tree, "MCP_pt" );
+   slots.MCP_distToIP = _rootWriter->getSlot( tree, "MCP_distToIP" );
+   slots.chi2Prob     = _rootWriter->getSlot( tree, "chi2Prob" );
+   slots.layers       = _rootWriter->getSlot( tree, "layers" );
+   slots.PDG          = _rootWriter->getSlot( tree, "PDG" );
+   slots.theta        = _rootWriter->getSlot( tree, "theta" );
+   
+   return slots;
    
 }
 
 
-
 void TrueTrackCritAnalyser::check( LCEvent * ) { 
    // nothing to check here - could be used to fill checkplots in reconstruction processor
 }
@@ -812,9 +1164,14 @@ void TrueTrackCritAnalyser::end(){
    //      << " processed " << _nEvt << " events in " << _nRun << " runs "
    //      << std::endl ;
    
-   for (unsigned i=0; i<_crits2 .size(); i++) delete _crits2 [i];
-   for (unsigned i=0; i<_crits3 .size(); i++) delete _crits3 [i];
-   for (unsigned i=0; i<_crits4 .size(); i++) delete _crits4 [i];
+   for (unsigned i=0; i<_workers.size(); i++) delete _workers[i];
+   _workers.clear();
+   
+   if( _makeQuantileSketches ) writeSketches();
+   
+   _rootWriter->close();
+   delete _rootWriter;
+   _rootWriter = NULL;
    
    delete _sectorSystemFTD;
    _sectorSystemFTD = NULL;
@@ -0,0 +1,60 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+
+#include "FeedbackSummary.h"
+
+
+
+/** Adds up the summaries written by the TrackingFeedbackProcessor (parameter MergeableSummaryFileName), 
+ * e.g. of jobs that each ran on a part of a sample.
+ * 
+ * @param argv[1] the path of the merged summary. A JSON version is written to the same path with ".json" appended.
+ * 
+ * @param argv[2...] the summaries to merge
+ * 
+ */
+int main(int argc,char *argv[]){
+   
+   
+   if( argc < 3 ){
+      
+      std::cout << "Usage: " << argv[0] << " <merged summary> <summary> [<summary> ...]\n";
+      return 1;
+      
+   }
+   
+   std::string OUTPUT_PATH = argv[1];
+   
+   
+   FeedbackSummary merged;
+   
+   try{
+      
+      for( int i=2; i < argc; i++ ) merged.add( FeedbackSummary::read( argv[i] ) );
+      
+      merged.write( OUTPUT_PATH );
+      
+      std::ofstream json( ( OUTPUT_PATH + ".json" ).c_str() );
+      merged.writeJSON( json );
+      
+   }
+   catch( std::runtime_error& e ){
+      
+      std::cout << e.what() << "\n";
+      return 1;
+      
+   }
+   
+   
+   std::cout << "Merged " << argc - 2 << " summaries of " << merged.getCounter( "nEvents" ) << " events into " << OUTPUT_PATH << "\n";
+   std::cout << "Efficiency\t" << merged.getEfficiency() << "\n";
+   std::cout << "ghostrate\t"  << merged.getGhostRate()  << "\n";
+   std::cout << "clonerate\t"  << merged.getCloneRate()  << "\n";
+   
+   
+   return 0;
+   
+}
+
@@ -0,0 +1,672 @@
+#include <cmath>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TH1D.h"
+#include "TGraphAsymmErrors.h"
+#include "TMultiGraph.h"
+#include "TCanvas.h"
+#include "TLegend.h"
+#include "TStyle.h"
+
+#include "RecoTrack.h"
+
+
+
+/** The binning of one variable */
+struct Binning{
+   
+   int nBins;
+   double min;
+   double max;
+   bool log; // evenly spaced bins on a logarithmic axis
+   
+};
+
+
+/** Everything read from the plot config */
+struct PlotterConfig{
+   
+   std::vector< std::string > fileNames;
+   std::vector< std::string > labels;
+   std::string outputFile;
+   std::string pictureEnding;
+   unsigned nThreads;
+   
+   std::map< std::string, Binning > binnings;
+   
+};
+
+
+/** The variables of the true tracks the efficiency is plotted against, with the axis titles */
+const std::vector< std::pair< std::string, std::string > > EFFICIENCY_VARIABLES = {
+   
+   { "pT", "p_{T}[GeV]" },
+   { "theta", "#vartheta" },
+   { "nHits", "number of hits" },
+   { "vertexDist", "distance of vertex to IP [mm]" }
+   
+};
+
+
+/** Reads the plot config.
+ *
+ * Every line holds a keyword and its arguments, lines starting with # are comments:
+ *
+ * - input <file> <label>: a root file written by the TrackingFeedbackProcessor and the name it gets in the plots
+ * - output <file>: the root file the histograms, graphs and canvases are written to (default "FeedbackPlots.root")
+ * - pictures <ending>: also save the canvases as pictures, e.g. ".svg"
+ * - threads <n>: how many threads read the files (default: the number of cores)
+ * - binning <variable> <nBins> <min> <max> [log]: the binning of pT, theta, nHits or vertexDist
+ *
+ * The binning of pT is used for the splits and the ghost rate as well.
+ */
+PlotterConfig readPlotterConfig( const std::string& fileName ){
+   
+   
+   std::ifstream file( fileName.c_str() );
+   if( !file ) throw std::runtime_error( "Can't open the plot config " + fileName );
+   
+   PlotterConfig config;
+   config.outputFile = "FeedbackPlots.root";
+   config.nThreads = std::thread::hardware_concurrency();
+   
+   // the binnings the root scripts used
+   config.binnings[ "pT" ] = { 20, 0.1, 50., true };
+   config.binnings[ "theta" ] = { 20, 0., 30., false };
+   config.binnings[ "nHits" ] = { 5, 3., 8., false };
+   config.binnings[ "vertexDist" ] = { 20, 0., 500., false };
+   
+   std::string line;
+   
+   while( std::getline( file, line ) ){
+      
+      
+      std::istringstream ss( line );
+      std::string keyword;
+      
+      if( !( ss >> keyword ) || keyword[0] == '#' ) continue;
+      
+      if( keyword == "output" ) ss >> config.outputFile;
+      else if( keyword == "pictures" ) ss >> config.pictureEnding;
+      else if( keyword == "threads" ) ss >> config.nThreads;
+      else if( keyword == "input" ){
+         
+         std::string inputFile;
+         std::string label;
+         
+         if( !( ss >> inputFile >> label ) ) throw std::runtime_error( "Bad input line: " + line );
+         
+         config.fileNames.push_back( inputFile );
+         config.labels.push_back( label );
+         
+      }
+      else if( keyword == "binning" ){
+         
+         std::string variable;
+         Binning binning = { 0, 0., 0., false };
+         std::string log;
+         
+         if( !( ss >> variable >> binning.nBins >> binning.min >> binning.max ) || binning.nBins < 1 || !( binning.max > binning.min ) ){
+            
+            throw std::runtime_error( "Bad binning line: " + line );
+            
+         }
+         if( config.binnings.count( variable ) == 0 ) throw std::runtime_error( "Unknown variable in binning line: " + line );
+         
+         binning.log = ( ss >> log ) && ( log == "log" );
+         if( binning.log && !( binning.min > 0. ) ) throw std::runtime_error( "A logarithmic binning needs a positive min: " + line );
+         
+         config.binnings[ variable ] = binning;
+         
+      }
+      else throw std::runtime_error( "Unknown keyword in the plot config: " + keyword );
+      
+      
+   }
+   
+   if( config.fileNames.empty() ) throw std::runtime_error( "The plot config has no input" );
+   if( config.nThreads < 1 ) config.nThreads = 1;
+   
+   return config;
+   
+   
+}
+
+
+/** @return a histogram with the binning, detached from any directory so it can be filled in any thread */
+TH1D* createHistogram( const std::string& name, const Binning& binning ){
+   
+   
+   std::vector< double > edges( binning.nBins + 1 );
+   
+   for( int i=0; i <= binning.nBins; i++ ){
+      
+      // as we want a logarithmic scale with even binning, the edges are evenly spaced in log10
+      if( binning.log ) edges[i] = pow( 10., log10( binning.min ) + i * ( log10( binning.max ) - log10( binning.min ) ) / binning.nBins );
+      else edges[i] = binning.min + i * ( binning.max - binning.min ) / binning.nBins;
+      
+   }
+   
+   TH1D* hist = new TH1D( name.c_str(), name.c_str(), binning.nBins, &edges[0] );
+   hist->SetDirectory( NULL );
+   hist->Sumw2();
+   
+   return hist;
+   
+   
+}
+
+
+/** All histograms of one input file, by name:
+ *
+ * - all_<variable>, found_<variable>: true tracks and the ones found, for every efficiency variable
+ * - lost_pT, contaminated_pT, notContaminated_pT: the split of the true tracks
+ * - reco_pT, ghost_pT, recoContaminated_pT, recoNotContaminated_pT: the reconstructed tracks and their split
+ */
+typedef std::map< std::string, TH1D* > FeedbackHistograms;
+
+
+FeedbackHistograms createHistograms( const PlotterConfig& config ){
+   
+   
+   FeedbackHistograms hists;
+   
+   for( unsigned i=0; i < EFFICIENCY_VARIABLES.size(); i++ ){
+      
+      const std::string& variable = EFFICIENCY_VARIABLES[i].first;
+      
+      hists[ "all_" + variable ] = createHistogram( "all_" + variable, config.binnings.at( variable ) );
+      hists[ "found_" + variable ] = createHistogram( "found_" + variable, config.binnings.at( variable ) );
+      
+   }
+   
+   const char* pTHistNames[] = { "lost_pT", "contaminated_pT", "notContaminated_pT", "reco_pT", "ghost_pT", "recoContaminated_pT", "recoNotContaminated_pT" };
+   for( unsigned i=0; i < sizeof( pTHistNames ) / sizeof( pTHistNames[0] ); i++ ) hists[ pTHistNames[i] ] = createHistogram( pTHistNames[i], config.binnings.at( "pT" ) );
+   
+   return hists;
+   
+   
+}
+
+
+/** A chunk of entries of one tree of one input */
+struct ReadTask{
+   
+   unsigned input;
+   bool trueTracks; // else recoTracks
+   Long64_t first;
+   Long64_t last; // exclusive
+   
+};
+
+
+/** The trees of one input opened in one thread, with only the branches needed enabled and bound */
+struct FeedbackTreeReader{
+   
+   TFile* file;
+   TTree* trueTree;
+   TTree* recoTree;
+   
+   int nComplete;
+   int nCompletePlus;
+   int nIncomplete;
+   int nIncompletePlus;
+   double pT;
+   double theta;
+   int nHits;
+   double vertexX;
+   double vertexY;
+   double vertexZ;
+   
+   int type; // the TrackType of the reconstructed track
+   double recoPT;
+   
+   FeedbackTreeReader( const std::string& fileName ){
+      
+      
+      file = TFile::Open( fileName.c_str() );
+      if( file == NULL || file->IsZombie() ) throw std::runtime_error( "Can't open " + fileName );
+      
+      trueTree = dynamic_cast< TTree* >( file->Get( "trueTracks" ) );
+      recoTree = dynamic_cast< TTree* >( file->Get( "recoTracks" ) );
+      if( trueTree == NULL || recoTree == NULL ){
+         
+         delete file;
+         throw std::runtime_error( fileName + " has no trueTracks or recoTracks tree" );
+         
+      }
+      
+      trueTree->SetCacheSize( 16*1024*1024 );
+      recoTree->SetCacheSize( 16*1024*1024 );
+      
+      trueTree->SetBranchStatus( "*", 0 );
+      bind( trueTree, "nComplete", &nComplete );
+      bind( trueTree, "nCompletePlus", &nCompletePlus );
+      bind( trueTree, "nIncomplete", &nIncomplete );
+      bind( trueTree, "nIncompletePlus", &nIncompletePlus );
+      bind( trueTree, "pT", &pT );
+      bind( trueTree, "theta", &theta );
+      bind( trueTree, "nHits", &nHits );
+      bind( trueTree, "vertexX", &vertexX );
+      bind( trueTree, "vertexY", &vertexY );
+      bind( trueTree, "vertexZ", &vertexZ );
+      
+      recoTree->SetBranchStatus( "*", 0 );
+      bind( recoTree, "Type", &type );
+      bind( recoTree, "pT", &recoPT );
+      
+      
+   }
+   
+   ~FeedbackTreeReader(){ delete file; }
+   
+   template< class T > void bind( TTree* tree, const char* branchName, T* address ){
+      
+      tree->SetBranchStatus( branchName, 1 );
+      tree->SetBranchAddress( branchName, address );
+      tree->AddBranchToCache( branchName );
+      
+   }
+   
+};
+
+
+/** @return the reading split into the clusters of the trees, so a thread reads whole baskets */
+std::vector< ReadTask > getReadTasks( const PlotterConfig& config ){
+   
+   
+   std::vector< ReadTask > tasks;
+   
+   for( unsigned i=0; i < config.fileNames.size(); i++ ){
+      
+      FeedbackTreeReader reader( config.fileNames[i] );
+      
+      for( int t=0; t < 2; t++ ){
+         
+         TTree* tree = ( t == 0 ) ? reader.trueTree : reader.recoTree;
+         Long64_t nEntries = tree->GetEntries();
+         
+         TTree::TClusterIterator clusters = tree->GetClusterIterator( 0 );
+         Long64_t first = 0;
+         
+         while( ( first = clusters() ) < nEntries ){
+            
+            ReadTask task = { i, t == 0, first, std::min( clusters.GetNextEntry(), nEntries ) };
+            tasks.push_back( task );
+            
+         }
+         
+      }
+      
+   }
+   
+   return tasks;
+   
+   
+}
+
+
+/** The histograms of FeedbackHistograms the entries get filled in, looked up once and not for every entry */
+struct FillHistograms{
+   
+   std::vector< TH1D* > all; // [efficiency variable]
+   std::vector< TH1D* > found;
+   TH1D* lost;
+   TH1D* contaminated;
+   TH1D* notContaminated;
+   
+   TH1D* reco;
+   TH1D* ghost;
+   TH1D* recoContaminated;
+   TH1D* recoNotContaminated;
+   
+   FillHistograms( FeedbackHistograms& hists ){
+      
+      
+      for( unsigned i=0; i < EFFICIENCY_VARIABLES.size(); i++ ){
+         
+         all.push_back( hists.at( "all_" + EFFICIENCY_VARIABLES[i].first ) );
+         found.push_back( hists.at( "found_" + EFFICIENCY_VARIABLES[i].first ) );
+         
+      }
+      
+      lost = hists.at( "lost_pT" );
+      contaminated = hists.at( "contaminated_pT" );
+      notContaminated = hists.at( "notContaminated_pT" );
+      
+      reco = hists.at( "reco_pT" );
+      ghost = hists.at( "ghost_pT" );
+      recoContaminated = hists.at( "recoContaminated_pT" );
+      recoNotContaminated = hists.at( "recoNotContaminated_pT" );
+      
+      
+   }
+   
+};
+
+
+void fillTrueTrack( const FillHistograms& hists, const FeedbackTreeReader& r ){
+   
+   
+   double values[] = { r.pT, r.theta, double( r.nHits ), sqrt( r.vertexX*r.vertexX + r.vertexY*r.vertexY + r.vertexZ*r.vertexZ ) };
+   
+   int nContaminated = r.nCompletePlus + r.nIncompletePlus;
+   int nNotContaminated = r.nComplete + r.nIncomplete;
+   bool found = nContaminated + nNotContaminated > 0;
+   
+   for( unsigned i=0; i < EFFICIENCY_VARIABLES.size(); i++ ){
+      
+      hists.all[i]->Fill( values[i] );
+      if( found ) hists.found[i]->Fill( values[i] );
+      
+   }
+   
+   if( nContaminated > 0 ) hists.contaminated->Fill( r.pT );
+   else if( nNotContaminated > 0 ) hists.notContaminated->Fill( r.pT );
+   else hists.lost->Fill( r.pT );
+   
+   
+}
+
+
+/** A reconstructed track belongs to at most one true track, so it is split by its type: ghosts, the ones with hits
+ * of other tracks (COMPLETE_PLUS, INCOMPLETE_PLUS) and the ones without (COMPLETE, INCOMPLETE).
+ */
+void fillRecoTrack( const FillHistograms& hists, const FeedbackTreeReader& r ){
+   
+   
+   hists.reco->Fill( r.recoPT );
+   
+   if( r.type == COMPLETE || r.type == INCOMPLETE ) hists.recoNotContaminated->Fill( r.recoPT );
+   else if( r.type == COMPLETE_PLUS || r.type == INCOMPLETE_PLUS ) hists.recoContaminated->Fill( r.recoPT );
+   else hists.ghost->Fill( r.recoPT );
+   
+   
+}
+
+
+TGraphAsymmErrors* createRatio( TH1D* pass, TH1D* total, int color, int markerStyle ){
+   
+   
+   TGraphAsymmErrors* graph = new TGraphAsymmErrors( pass, total );
+   graph->SetMarkerColor( color );
+   graph->SetMarkerStyle( markerStyle );
+   graph->SetMarkerSize( 0.8 );
+   graph->SetLineColor( color );
+   
+   return graph;
+   
+   
+}
+
+
+void saveCanvas( const PlotterConfig& config, TCanvas* canvas, TMultiGraph* mg, TLegend* legend, const std::string& xTitle, bool logX ){
+   
+   
+   canvas->cd();
+   if( logX ) canvas->SetLogx();
+   
+   mg->Draw( "AP" );
+   mg->GetYaxis()->SetRangeUser( 0., 1. );
+   mg->GetXaxis()->SetTitle( xTitle.c_str() );
+   legend->SetFillColor( kWhite );
+   legend->Draw( "same" );
+   canvas->Update();
+   
+   canvas->Write();
+   if( !config.pictureEnding.empty() ) canvas->SaveAs( ( std::string( canvas->GetName() ) + config.pictureEnding ).c_str() );
+   
+   
+}
+
+
+/**
+ * Makes the efficiency, ghost rate and split plots of the root files written by TrackingFeedbackProcessors.
+ *
+ * Every input is read only once: the trees are split into their clusters, which are read by a pool of threads,
+ * each filling its own histograms of all plots at the same time. The histograms of the threads are added up at the end.
+ *
+ * The output root file has a directory per input with the histograms and the efficiency and ghost rate graphs,
+ * and the canvases:
+ * - Efficiency_<variable>: the efficiency of all inputs against pT, theta, nHits and the distance of the vertex to the IP
+ * - Ghostrate: the ghost rate of all inputs against pT
+ * - Efficiency_split_<label>: the true tracks of an input split into lost, found contaminated and found not contaminated
+ * - Ghostrate_split_<label>: the reconstructed tracks of an input split into ghosts, contaminated and not contaminated tracks
+ *
+ * @param argv[1] the plot config, see readPlotterConfig()
+ *
+ */
+int main(int argc,char *argv[]){
+   
+   
+   if( argc < 2 ){
+      
+      std::cout << "Usage: " << argv[0] << " <plot config>\n";
+      return 1;
+      
+   }
+   
+   PlotterConfig config;
+   std::vector< ReadTask > tasks;
+   
+   ROOT::EnableThreadSafety();
+   TH1::AddDirectory( kFALSE );
+   
+   try{
+      
+      config = readPlotterConfig( argv[1] );
+      tasks = getReadTasks( config );
+      
+   }
+   catch( std::runtime_error& e ){
+      
+      std::cout << e.what() << "\n";
+      return 1;
+      
+   }
+   
+   unsigned nInputs = config.fileNames.size();
+   unsigned nThreads = std::min< unsigned >( config.nThreads, tasks.size() );
+   if( nThreads < 1 ) nThreads = 1;
+   
+   std::cout << "Reading " << nInputs << " inputs in " << tasks.size() << " clusters with " << nThreads << " threads\n";
+   
+   
+   /**********************************************************************************************/
+   /*                Fill the histograms                                                         */
+   /**********************************************************************************************/
+   
+   // the histograms of every thread and input, created here as booking histograms isn't thread safe
+   std::vector< std::vector< FeedbackHistograms > > threadHists( nThreads );
+   for( unsigned t=0; t < nThreads; t++ ) for( unsigned i=0; i < nInputs; i++ ) threadHists[t].push_back( createHistograms( config ) );
+   
+   std::atomic< unsigned > nextTask( 0 );
+   std::atomic< bool > failed( false );
+   std::mutex outputMutex;
+   
+   std::vector< std::thread > threads;
+   
+   for( unsigned t=0; t < nThreads; t++ ){
+      
+      threads.push_back( std::thread( [&, t](){
+         
+         // every thread opens each input at most once and keeps it for all its clusters
+         std::map< unsigned, FeedbackTreeReader* > readers;
+         
+         try{
+            
+            for( unsigned k = nextTask++; k < tasks.size(); k = nextTask++ ){
+               
+               const ReadTask& task = tasks[k];
+               
+               FeedbackTreeReader*& reader = readers[ task.input ];
+               if( reader == NULL ) reader = new FeedbackTreeReader( config.fileNames[ task.input ] );
+               
+               TTree* tree = task.trueTracks ? reader->trueTree : reader->recoTree;
+               tree->SetCacheEntryRange( task.first, task.last );
+               
+               FillHistograms hists( threadHists[t][ task.input ] );
+               
+               for( Long64_t j = task.first; j < task.last; j++ ){
+                  
+                  tree->GetEntry( j );
+                  
+                  if( task.trueTracks ) fillTrueTrack( hists, *reader );
+                  else fillRecoTrack( hists, *reader );
+                  
+               }
+               
+            }
+            
+         }
+         catch( std::runtime_error& e ){
+            
+            std::lock_guard< std::mutex > lock( outputMutex );
+            std::cout << e.what() << "\n";
+            failed = true;
+            
+         }
+         
+         for( std::map< unsigned, FeedbackTreeReader* >::iterator it = readers.begin(); it != readers.end(); ++it ) delete it->second;
+         
+      } ) );
+      
+   }
+   
+   for( unsigned t=0; t < threads.size(); t++ ) threads[t].join();
+   
+   if( failed ) return 1;
+   
+   // add up the histograms of the threads
+   std::vector< FeedbackHistograms >& hists = threadHists[0];
+   
+   for( unsigned t=1; t < nThreads; t++ ){
+      
+      for( unsigned i=0; i < nInputs; i++ ){
+         
+         for( FeedbackHistograms::iterator it = threadHists[t][i].begin(); it != threadHists[t][i].end(); ++it ){
+            
+            hists[i][ it->first ]->Add( it->second );
+            delete it->second;
+            
+         }
+         
+      }
+      
+   }
+   
+   
+   /**********************************************************************************************/
+   /*                Make the plots                                                              */
+   /**********************************************************************************************/
+   
+   TFile* outputFile = new TFile( config.outputFile.c_str(), "RECREATE" );
+   if( outputFile->IsZombie() ){
+      
+      std::cout << "Can't create " << config.outputFile << "\n";
+      return 1;
+      
+   }
+   
+   gROOT->SetStyle( "Plain" );    // a style using white instead of grey
+   
+   const int colors[] = { 3, 2, 4, 6, 7, 8, 9, 1 };
+   const unsigned nColors = sizeof( colors ) / sizeof( colors[0] );
+   
+   for( unsigned v=0; v < EFFICIENCY_VARIABLES.size() + 1; v++ ){
+      
+      bool ghostrate = ( v == EFFICIENCY_VARIABLES.size() );
+      std::string variable = ghostrate ? "pT" : EFFICIENCY_VARIABLES[v].first;
+      std::string name = ghostrate ? "Ghostrate" : "Efficiency_" + variable;
+      
+      TCanvas* canvas = new TCanvas( name.c_str(), name.c_str(), 0, 0, 600, 400 );
+      TMultiGraph* mg = new TMultiGraph();
+      mg->SetTitle( ghostrate ? "Ghost Rate" : "Efficiency" );
+      TLegend* legend = ghostrate ? new TLegend( 0.6, 0.65, 0.85, 0.85 ) : new TLegend( 0.4, 0.15, 0.7, 0.35 );
+      
+      for( unsigned i=0; i < nInputs; i++ ){
+         
+         TGraphAsymmErrors* graph = ghostrate ? createRatio( hists[i][ "ghost_pT" ], hists[i][ "reco_pT" ], colors[ i % nColors ], 20 + i )
+                                              : createRatio( hists[i][ "found_" + variable ], hists[i][ "all_" + variable ], colors[ i % nColors ], 20 + i );
+         graph->SetName( ( name + "_" + config.labels[i] ).c_str() );
+         
+         mg->Add( graph );
+         legend->AddEntry( graph, config.labels[i].c_str() );
+         
+      }
+      
+      saveCanvas( config, canvas, mg, legend, ghostrate ? "p_{T}[GeV]" : EFFICIENCY_VARIABLES[v].second, config.binnings[ variable ].log );
+      
+   }
+   
+   for( unsigned i=0; i < nInputs; i++ ){
+      
+      const std::string& label = config.labels[i];
+      
+      
+      std::string name = "Efficiency_split_" + label;
+      TCanvas* canvas = new TCanvas( name.c_str(), name.c_str(), 0, 0, 600, 400 );
+      TMultiGraph* mg = new TMultiGraph();
+      mg->SetTitle( ( label + ", True Tracks" ).c_str() );
+      TLegend* legend = new TLegend( 0.6, 0.9, 0.9, 0.99 );
+      
+      TGraphAsymmErrors* graph = createRatio( hists[i][ "lost_pT" ], hists[i][ "all_pT" ], 6, 20 );
+      mg->Add( graph );
+      legend->AddEntry( graph, "Lost" );
+      graph = createRatio( hists[i][ "contaminated_pT" ], hists[i][ "all_pT" ], 7, 21 );
+      mg->Add( graph );
+      legend->AddEntry( graph, "Found, Contaminated" );
+      graph = createRatio( hists[i][ "notContaminated_pT" ], hists[i][ "all_pT" ], 3, 22 );
+      mg->Add( graph );
+      legend->AddEntry( graph, "Found, Not Contaminated" );
+      
+      saveCanvas( config, canvas, mg, legend, "p_{T}[GeV]", config.binnings[ "pT" ].log );
+      
+      
+      name = "Ghostrate_split_" + label;
+      canvas = new TCanvas( name.c_str(), name.c_str(), 0, 0, 600, 400 );
+      mg = new TMultiGraph();
+      mg->SetTitle( ( label + ", Reconstructed Tracks" ).c_str() );
+      legend = new TLegend( 0.6, 0.9, 0.9, 0.99 );
+      
+      graph = createRatio( hists[i][ "ghost_pT" ], hists[i][ "reco_pT" ], 6, 20 );
+      mg->Add( graph );
+      legend->AddEntry( graph, "Ghost" );
+      graph = createRatio( hists[i][ "recoContaminated_pT" ], hists[i][ "reco_pT" ], 7, 21 );
+      mg->Add( graph );
+      legend->AddEntry( graph, "Contaminated" );
+      graph = createRatio( hists[i][ "recoNotContaminated_pT" ], hists[i][ "reco_pT" ], 3, 22 );
+      mg->Add( graph );
+      legend->AddEntry( graph, "Not Contaminated" );
+      
+      saveCanvas( config, canvas, mg, legend, "p_{T}[GeV]", config.binnings[ "pT" ].log );
+      
+      
+      // the raw histograms, so the plots can be remade or merged later
+      outputFile->mkdir( label.c_str() )->cd();
+      for( FeedbackHistograms::iterator it = hists[i].begin(); it != hists[i].end(); ++it ) it->second->Write();
+      outputFile->cd();
+      
+   }
+   
+   outputFile->Close();
+   delete outputFile;
+   
+   std::cout << "Wrote " << config.outputFile << "\n";
+   
+   
+   return 0;
+   
+}
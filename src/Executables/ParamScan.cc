@@ -0,0 +1,490 @@
+#include <cstdlib>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "FeedbackSummary.h"
+
+
+
+/** A parameter of a processor and the values it takes in the scan */
+struct ScanParameter{
+   
+   std::string name; // Processor.Parameter
+   std::vector< std::string > values;
+
+};
+
+
+/** Everything read from the scan spec */
+struct ScanSpec{
+   
+   std::string steeringFile;
+   std::string outputDir;
+   std::string marlin;
+   unsigned nJobs;
+   
+   /** options passed to every job, e.g. --Global.MaxRecordNumber=100 */
+   std::vector< std::string > options;
+   
+   /** the Processor.Parameter that tells a TrackingFeedbackProcessor where to write its mergeable summary */
+   std::vector< std::string > summaries;
+   
+   /** the scan collections of a TrackingFeedbackProcessor, their summaries are written next to its mergeable summary */
+   std::vector< std::string > scanSummaries;
+   
+   /** other output files of the jobs: the Processor.Parameter and the name of the file in the directory of the point */
+   std::vector< std::pair< std::string , std::string > > pointFiles;
+   
+   std::vector< ScanParameter > parameters;
+
+};
+
+
+/** Reads the scan spec.
+ * 
+ * Every line holds a keyword and its arguments, lines starting with # are comments:
+ * 
+ * - steering <file>: the Marlin steering file
+ * - output <dir>: where the directories of the jobs and the table go (default "scan")
+ * - jobs <n>: how many Marlin processes run at the same time (default 1)
+ * - marlin <command>: the Marlin executable (default "Marlin")
+ * - option <--Processor.Parameter=value>: passed unchanged to every job
+ * - summary <Processor.MergeableSummaryFileName>: a feedback processor to collect the summary of
+ * - scansummary <collection>: a collection in ScanTrackCollections of a feedback processor to collect the summary of. The
+ *   processor writes it next to its mergeable summary, so the processor has to be given with summary as well
+ * - pointfile <Processor.Parameter> <file name>: an output file of the jobs, every point writes it into its own directory
+ * - grid <Processor.Parameter> <min> <max> <step>: the values min, min+step, ... up to max
+ * - list <Processor.Parameter> <value> [<value> ...]: the given values
+ * 
+ * The points of the scan are all combinations of the values of the grid and list parameters.
+ * 
+ * Marlin runs in the directory ParamScan was started in, so relative paths in the steering file and the options
+ * work as usual. Output files the steering file sets would be written by all jobs at the same place, so they should
+ * be given as pointfile.
+ */
+ScanSpec readScanSpec( const std::string& fileName ){
+   
+   
+   std::ifstream file( fileName.c_str() );
+   if( !file ) throw std::runtime_error( "Can't open the scan spec " + fileName );
+   
+   ScanSpec spec;
+   spec.outputDir = "scan";
+   spec.marlin = "Marlin";
+   spec.nJobs = 1;
+   
+   std::string line;
+   
+   while( std::getline( file, line ) ){
+      
+      
+      std::istringstream ss( line );
+      std::string keyword;
+      
+      if( !( ss >> keyword ) || keyword[0] == '#' ) continue;
+      
+      if( keyword == "steering" ) ss >> spec.steeringFile;
+      else if( keyword == "output" ) ss >> spec.outputDir;
+      else if( keyword == "jobs" ) ss >> spec.nJobs;
+      else if( keyword == "marlin" ) ss >> spec.marlin;
+      else if( keyword == "option" ){
+         
+         std::string option;
+         ss >> option;
+         spec.options.push_back( option );
+      
+      }
+      else if( keyword == "summary" ){
+         
+         std::string summary;
+         ss >> summary;
+         spec.summaries.push_back( summary );
+      
+      }
+      else if( keyword == "scansummary" ){
+         
+         std::string collection;
+         ss >> collection;
+         spec.scanSummaries.push_back( collection );
+      
+      }
+      else if( keyword == "pointfile" ){
+         
+         std::pair< std::string , std::string > pointFile;
+         
+         if( !( ss >> pointFile.first >> pointFile.second ) ) throw std::runtime_error( "Bad pointfile line: " + line );
+         
+         spec.pointFiles.push_back( pointFile );
+      
+      }
+      else if( keyword == "grid" ){
+         
+         ScanParameter parameter;
+         double min = 0.;
+         double max = 0.;
+         double step = 0.;
+         
+         if( !( ss >> parameter.name >> min >> max >> step ) || !( step > 0. ) ) throw std::runtime_error( "Bad grid line: " + line );
+         
+         // count the steps instead of adding them up, so rounding doesn't lose the last point
+         unsigned nSteps = unsigned( ( max - min ) / step + 1e-6 );
+         
+         for( unsigned i=0; i <= nSteps; i++ ){
+            
+            std::ostringstream value;
+            value << min + i*step;
+            parameter.values.push_back( value.str() );
+         
+         }
+         
+         spec.parameters.push_back( parameter );
+      
+      }
+      else if( keyword == "list" ){
+         
+         ScanParameter parameter;
+         ss >> parameter.name;
+         
+         std::string value;
+         while( ss >> value ) parameter.values.push_back( value );
+         
+         if( parameter.values.empty() ) throw std::runtime_error( "Bad list line: " + line );
+         
+         spec.parameters.push_back( parameter );
+      
+      }
+      else throw std::runtime_error( "Unknown keyword in the scan spec: " + keyword );
+   
+   
+   }
+   
+   if( spec.steeringFile.empty() ) throw std::runtime_error( "The scan spec has no steering file" );
+   if( !spec.scanSummaries.empty() && spec.summaries.empty() ){
+      
+      throw std::runtime_error( "The scan spec has scansummary but no summary, the scan summaries would be written outside the directories of the points" );
+   
+   }
+   if( spec.nJobs < 1 ) spec.nJobs = 1;
+   
+   return spec;
+
+
+}
+
+
+/** @return all combinations of the values of the parameters, the first parameter changing slowest */
+std::vector< std::vector< std::string > > getScanPoints( const std::vector< ScanParameter >& parameters ){
+   
+   
+   std::vector< std::vector< std::string > > points( 1 );
+   
+   for( unsigned i=0; i < parameters.size(); i++ ){
+      
+      std::vector< std::vector< std::string > > newPoints;
+      
+      for( unsigned j=0; j < points.size(); j++ ){
+         
+         for( unsigned k=0; k < parameters[i].values.size(); k++ ){
+            
+            newPoints.push_back( points[j] );
+            newPoints.back().push_back( parameters[i].values[k] );
+         
+         }
+      
+      }
+      
+      points.swap( newPoints );
+   
+   }
+   
+   return points;
+
+
+}
+
+
+/** @return the name of the summary file a processor writes in the job directory */
+std::string getSummaryFileName( const std::string& summary ){
+   
+   return summary.substr( 0, summary.find( '.' ) ) + ".summary";
+
+}
+
+
+/** @return the parameters of a point the way Marlin takes them on the command line, one per line.
+ * The summaries and the other output files go to the directory of the point.
+ */
+std::string getPointParameters( const ScanSpec& spec, const std::string& pointDir, const std::vector< std::string >& point ){
+   
+   
+   std::ostringstream ss;
+   
+   for( unsigned i=0; i < spec.options.size(); i++ ) ss << spec.options[i] << "\n";
+   for( unsigned i=0; i < point.size(); i++ ) ss << "--" << spec.parameters[i].name << "=" << point[i] << "\n";
+   for( unsigned i=0; i < spec.summaries.size(); i++ ) ss << "--" << spec.summaries[i] << "=" << pointDir << "/" << getSummaryFileName( spec.summaries[i] ) << "\n";
+   for( unsigned i=0; i < spec.pointFiles.size(); i++ ) ss << "--" << spec.pointFiles[i].first << "=" << pointDir << "/" << spec.pointFiles[i].second << "\n";
+   
+   return ss.str();
+
+
+}
+
+
+std::string readFile( const std::string& fileName ){
+   
+   std::ifstream file( fileName.c_str() );
+   std::ostringstream ss;
+   ss << file.rdbuf();
+   return ss.str();
+
+}
+
+
+/** @return the argument quoted for the shell, so that quotes, $, ` and backslashes in it reach Marlin unchanged */
+std::string shellQuote( const std::string& argument ){
+   
+   
+   // inside single quotes everything is literal, only a single quote itself has to end the quoting: ' -> '\''
+   std::string quoted = "'";
+   
+   for( unsigned i=0; i < argument.size(); i++ ){
+      
+      if( argument[i] == '\'' ) quoted += "'\\''";
+      else quoted += argument[i];
+   
+   }
+   
+   quoted += "'";
+   
+   return quoted;
+
+
+}
+
+
+/** Runs Marlin for one point. Marlin runs in the current directory, its log goes to marlin.log in the directory of the point.
+ * 
+ * The directory gets a file "parameters" with the command line parameters and, if Marlin returned 0, a file "done"
+ * with the same content. A point whose "done" matches its parameters is not run again, so an interrupted scan
+ * can simply be restarted.
+ * 
+ * @return whether the point was run successfully (now or before)
+ */
+bool runPoint( const ScanSpec& spec, const std::string& pointDir, const std::string& parameters, bool& skipped ){
+   
+   
+   skipped = false;
+   
+   std::string doneFile = pointDir + "/done";
+   
+   if( readFile( doneFile ) == parameters ){
+      
+      skipped = true;
+      return true;
+   
+   }
+   
+   mkdir( pointDir.c_str(), 0755 );
+   unlink( doneFile.c_str() );
+   
+   std::ofstream( ( pointDir + "/parameters" ).c_str() ) << parameters;
+   
+   
+   std::string commandLine;
+   std::istringstream ss( parameters );
+   std::string parameter;
+   while( std::getline( ss, parameter ) ) commandLine += " " + shellQuote( parameter );
+   
+   std::string command = spec.marlin + " " + shellQuote( spec.steeringFile ) + commandLine + " > " + shellQuote( pointDir + "/marlin.log" ) + " 2>&1";
+   
+   if( system( command.c_str() ) != 0 ) return false;
+   
+   std::ofstream( doneFile.c_str() ) << parameters;
+   
+   return true;
+
+
+}
+
+
+/**
+ * Runs Marlin for every point of a parameter scan, with a number of jobs at the same time, and collects the
+ * summaries of the feedback processors into one table.
+ * 
+ * Every point gets its own directory <output>/point_<i> for the log, the summaries and the pointfile outputs. The table <output>/scan.csv has one row per point with
+ * the values of the scanned parameters and for every summary the number of events, efficiency, ghost rate and clone rate.
+ * 
+ * @param argv[1] the scan spec, see readScanSpec()
+ * 
+ */
+int main(int argc,char *argv[]){
+   
+   
+   if( argc < 2 ){
+      
+      std::cout << "Usage: " << argv[0] << " <scan spec>\n";
+      return 1;
+   
+   }
+   
+   
+   ScanSpec spec;
+   
+   try{
+      
+      spec = readScanSpec( argv[1] );
+   
+   }
+   catch( std::runtime_error& e ){
+      
+      std::cout << e.what() << "\n";
+      return 1;
+   
+   }
+   
+   std::vector< std::vector< std::string > > points = getScanPoints( spec.parameters );
+   
+   mkdir( spec.outputDir.c_str(), 0755 );
+   
+   struct stat outputStat;
+   if( stat( spec.outputDir.c_str(), &outputStat ) != 0 || !S_ISDIR( outputStat.st_mode ) ){
+      
+      std::cout << "Can't create the output directory " << spec.outputDir << "\n";
+      return 1;
+   
+   }
+   
+   std::vector< std::string > pointDirs;
+   for( unsigned i=0; i < points.size(); i++ ){
+      
+      std::ostringstream dir;
+      dir << spec.outputDir << "/point_" << i;
+      pointDirs.push_back( dir.str() );
+   
+   }
+   
+   std::cout << "Scanning " << points.size() << " points with " << spec.nJobs << " jobs\n";
+   
+   
+   /**********************************************************************************************/
+   /*                Run Marlin                                                                  */
+   /**********************************************************************************************/
+   
+   std::vector< char > success( points.size(), 0 );
+   std::atomic< unsigned > nextPoint( 0 );
+   std::mutex outputMutex;
+   
+   std::vector< std::thread > jobs;
+   
+   for( unsigned t=0; t < spec.nJobs; t++ ){
+      
+      jobs.push_back( std::thread( [&](){
+         
+         for( unsigned i = nextPoint++; i < points.size(); i = nextPoint++ ){
+            
+            bool skipped = false;
+            success[i] = runPoint( spec, pointDirs[i], getPointParameters( spec, pointDirs[i], points[i] ), skipped );
+            
+            std::lock_guard< std::mutex > lock( outputMutex );
+            std::cout << pointDirs[i] << ( skipped ? ": already done" : ( success[i] ? ": done" : ": Marlin did not return 0. Error!!!" ) ) << "\n";
+         
+         }
+      
+      } ) );
+   
+   }
+   
+   for( unsigned t=0; t < jobs.size(); t++ ) jobs[t].join();
+   
+   
+   /**********************************************************************************************/
+   /*                Collect the summaries                                                       */
+   /**********************************************************************************************/
+   
+   std::string tableFileName = spec.outputDir + "/scan.csv";
+   std::ofstream table( tableFileName.c_str() );
+   
+   table << "point";
+   for( unsigned i=0; i < spec.parameters.size(); i++ ) table << "," << spec.parameters[i].name;
+   for( unsigned i=0; i < spec.summaries.size(); i++ ){
+      
+      std::string processor = spec.summaries[i].substr( 0, spec.summaries[i].find( '.' ) );
+      table << "," << processor << ".nEvents," << processor << ".efficiency," << processor << ".ghostrate," << processor << ".clonerate";
+   
+   }
+   for( unsigned i=0; i < spec.scanSummaries.size(); i++ ){
+      
+      const std::string& collection = spec.scanSummaries[i];
+      table << "," << collection << ".nEvents," << collection << ".efficiency," << collection << ".ghostrate," << collection << ".clonerate";
+   
+   }
+   table << "\n";
+   
+   unsigned nFailed = 0;
+   
+   for( unsigned i=0; i < points.size(); i++ ){
+      
+      if( !success[i] ){
+         
+         nFailed++;
+         continue;
+      
+      }
+      
+      table << i;
+      for( unsigned j=0; j < points[i].size(); j++ ) table << "," << points[i][j];
+      
+      std::vector< std::string > summaryFiles;
+      for( unsigned j=0; j < spec.summaries.size(); j++ ) summaryFiles.push_back( pointDirs[i] + "/" + getSummaryFileName( spec.summaries[j] ) );
+      for( unsigned j=0; j < spec.scanSummaries.size(); j++ ) summaryFiles.push_back( pointDirs[i] + "/" + spec.scanSummaries[j] + ".summary" );
+      
+      for( unsigned j=0; j < summaryFiles.size(); j++ ){
+         
+         try{
+            
+            FeedbackSummary summary = FeedbackSummary::read( summaryFiles[j] );
+            
+            table << "," << summary.getCounter( "nEvents" ) << "," << summary.getEfficiency()
+                  << "," << summary.getGhostRate() << "," << summary.getCloneRate();
+         
+         }
+         catch( std::runtime_error& e ){
+            
+            std::cout << pointDirs[i] << ": " << e.what() << "\n";
+            table << ",,,,";
+         
+         }
+      
+      }
+      
+      table << "\n";
+   
+   }
+   
+   table.close();
+   
+   std::cout << "Wrote " << tableFileName << "\n";
+   
+   if( nFailed > 0 ){
+      
+      std::cout << nFailed << " points failed, run the scan again to retry them\n";
+      return 1;
+   
+   }
+   
+   
+   return 0;
+
+}
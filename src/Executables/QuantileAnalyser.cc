@@ -1,16 +1,23 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <set>
 #include <algorithm>
+#include <functional>
 #include <sstream>
 #include <fstream>
 #include <cmath>
+#include <cstdlib>
 
+#include "TROOT.h"
 #include "TFile.h"
 #include "TTree.h"
+#include "TBranch.h"
 
 #include "Criteria/Criteria.h"
 
+#include "QuantileSketch.h"
+
 
 using namespace KiTrack;
 
@@ -18,7 +25,7 @@ using namespace KiTrack;
 
 /** Calculates the minimum and maximum value, so that all values between them are inside a quantile.
  * 
- * @param values a vector of the values for which the quantile is checked
+ * @param values a vector of the values for which the quantile is checked. The order of the values gets changed.
  * 
  * @param min passed by reference: here the minimum will be stored
  * 
@@ -34,44 +41,335 @@ using namespace KiTrack;
  * above the minimum.
  * If partLeft and partRight don't add up to 1 they will be normed, so that they are. So 3 and 1 will give 0.25 and 0.75.
  * 
+ * Only the two boundaries are needed, so instead of sorting all the values they are selected with nth_element.
  */
-void calcMinMaxOfQuantile( std::vector< float > values, float &min, float &max, float quantile , float partLeft = 0.5 , float partRight = 0.5 ){
+void calcMinMaxOfQuantile( std::vector< float >& values, float &min, float &max, float quantile , float partLeft = 0.5 , float partRight = 0.5 ){
+   
+   if( values.empty() ){
+      
+      min = 0.;
+      max = 0.;
+      return;
+      
+   }
    
    if (quantile < 0) quantile = 0.;
    if (quantile > 1.) quantile = 1.;
    
    // Norm partLeft and partRight
-   partLeft = partLeft/ (partLeft + partRight);
-   partRight = partRight/ (partLeft + partRight);
-   
-   sort( values.begin() , values.end() ); // sort values from low to big
+   float partSum = partLeft + partRight;
+   partLeft = partLeft / partSum;
+   partRight = partRight / partSum;
    
    unsigned nOutsideQuantile =  unsigned( values.size() * (1. - quantile) );
    
    unsigned nOutsideLeft = unsigned ( round ( nOutsideQuantile * partLeft ) );
    unsigned nOutsideRight = unsigned ( round ( nOutsideQuantile * partRight ) );
    
-   min = values[nOutsideLeft];
-   max = values[values.size() - nOutsideRight - 1];
+   unsigned iMin = std::min( nOutsideLeft, unsigned( values.size() - 1 ) );
+   unsigned iMax = values.size() - 1 - std::min( nOutsideRight, unsigned( values.size() - 1 ) );
+   iMax = std::max( iMax, iMin );
+   
+   // after this everything before iMin is <= min and everything after it >= min
+   std::nth_element( values.begin(), values.begin() + iMin, values.end() );
+   min = values[iMin];
+   
+   // so the maximum can be selected from the values after iMin
+   if( iMax > iMin ) std::nth_element( values.begin() + iMin + 1, values.begin() + iMax, values.end() );
+   max = values[iMax];
+   
+   return;
+   
+}
+
+
+/** The same as above, but the quantiles are taken from a quantile sketch of the values instead of the values themselves */
+void calcMinMaxOfQuantile( const QuantileSketch& sketch, float &min, float &max, float quantile , float partLeft = 0.5 , float partRight = 0.5 ){
+   
+   if( sketch.getN() == 0 ){
+      
+      min = 0.;
+      max = 0.;
+      return;
+      
+   }
+   
+   if (quantile < 0) quantile = 0.;
+   if (quantile > 1.) quantile = 1.;
+   
+   // Norm partLeft and partRight
+   float partSum = partLeft + partRight;
+   partLeft = partLeft / partSum;
+   partRight = partRight / partSum;
+   
+   double outsideQuantile = 1. - quantile;
+   
+   min = sketch.getQuantile( outsideQuantile * partLeft );
+   max = sketch.getQuantile( 1. - outsideQuantile * partRight );
    
    return;
    
 }
 
+
+/** Reads the tree "QuantileSketches" of TrueTrackCritAnalyser and adds the sketches of all combinations of layers
+ * (layers = -1) to the sketches of the criteria, sketches[ critType ][ critName ]. So the sketches of several files,
+ * e.g. of several jobs, can be merged by calling this for each of them.
+ */
+void readSketches( TTree* tree, std::map< std::string , std::map< std::string , QuantileSketch > >& sketches ){
+   
+   
+   std::string* critType = NULL;
+   std::string* valueName = NULL;
+   int layers = 0;
+   int k = 0;
+   float min = 0.;
+   float max = 0.;
+   std::vector< float >* items = NULL;
+   std::vector< int >* levels = NULL;
+   
+   tree->SetBranchAddress( "critType", &critType );
+   tree->SetBranchAddress( "valueName", &valueName );
+   tree->SetBranchAddress( "layers", &layers );
+   tree->SetBranchAddress( "k", &k );
+   tree->SetBranchAddress( "min", &min );
+   tree->SetBranchAddress( "max", &max );
+   tree->SetBranchAddress( "items", &items );
+   tree->SetBranchAddress( "levels", &levels );
+   
+   TBranch* layersBranch = tree->GetBranch( "layers" );
+   
+   Long64_t nEntries = tree->GetEntries();
+   
+   for( Long64_t j=0; j < nEntries; j++ ){
+      
+      // the sketches of the single combinations of layers are not needed, so only their layers get read
+      layersBranch->GetEntry( j );
+      if( layers != -1 ) continue;
+      
+      tree->GetEntry( j );
+      
+      QuantileSketch sketch = QuantileSketch::fromItems( unsigned( k ), min, max, *items, *levels );
+      
+      std::map< std::string , QuantileSketch >& typeSketches = sketches[ *critType ];
+      std::map< std::string , QuantileSketch >::iterator it = typeSketches.find( *valueName );
+      
+      if( it == typeSketches.end() ) typeSketches.insert( std::make_pair( *valueName, sketch ) );
+      else if( it->second.getK() != sketch.getK() ){
+         
+         std::cout << "\nThe sketches of " << *critType << " " << *valueName << " have different sizes (k = " 
+                   << it->second.getK() << " and " << sketch.getK() << "), skipping the one of " << tree->GetCurrentFile()->GetName();
+         
+      }
+      else it->second.merge( sketch );
+      
+   }
+   
+   tree->ResetBranchAddresses();
+   
+   delete critType;
+   delete valueName;
+   delete items;
+   delete levels;
+   
+}
+
+
+/** Reads the branches of a tree into one vector per branch. The values are appended to the vectors, so
+ * the same branches of several trees can be read one after another.
+ * 
+ * The branches are bound once and all other branches are switched off, so only the baskets of the wanted
+ * columns get read and decompressed. Branches the tree doesn't have are skipped.
+ */
+void readColumns( TTree* tree, const std::set< std::string >& branchNames, std::map < std::string , std::vector <float> >& columns ){
+   
+   
+   Long64_t nEntries = tree->GetEntries();
+   
+   std::vector< std::string > names;
+   for( std::set< std::string >::const_iterator it = branchNames.begin(); it != branchNames.end(); it++ ){
+      
+      if( tree->GetBranch( it->c_str() ) == NULL ){
+         
+         std::cout << "\nThe tree " << tree->GetName() << " has no branch " << *it << ", skipping it.";
+         continue;
+         
+      }
+      
+      names.push_back( *it );
+      
+   }
+   
+   std::vector< float > buffer( names.size() + 1 ); // +1: never empty
+   
+   tree->SetBranchStatus( "*", 0 );
+   
+   for( unsigned i=0; i < names.size(); i++ ){
+      
+      tree->SetBranchStatus( names[i].c_str(), 1 );
+      tree->SetBranchAddress( names[i].c_str(), &buffer[i] );
+      tree->AddBranchToCache( names[i].c_str(), true );
+      
+      columns[ names[i] ].reserve( columns[ names[i] ].size() + nEntries );
+      
+   }
+   
+   tree->SetCacheSize( 64*1024*1024 );
+   
+   
+   std::vector< std::vector< float >* > columnPointers;
+   for( unsigned i=0; i < names.size(); i++ ) columnPointers.push_back( &columns[ names[i] ] );
+   
+   for( Long64_t j=0; j < nEntries; j++ ){
+      
+      tree->GetEntry( j );
+      
+      for( unsigned i=0; i < names.size(); i++ ) columnPointers[i]->push_back( buffer[i] );
+      
+   }
+   
+   tree->ResetBranchAddresses();
+   tree->SetBranchStatus( "*", 1 );
+   
+}
+
+
+/** Reads a comma separated list of quantiles, like "0.999,0.99,0.97".
+ * 
+ * The quantiles get ordered from the loosest to the tightest, because this is the order of the
+ * rounds in ForwardTracking: every round that has too many connections retries with the next, tighter cuts.
+ */
+std::vector< float > parseQuantiles( const std::string& quantileString ){
+   
+   
+   std::vector< float > quantiles;
+   
+   std::stringstream ss( quantileString );
+   std::string item;
+   
+   while( std::getline( ss, item, ',' ) ){
+      
+      if( item.empty() ) continue;
+      
+      float quantile = atof( item.c_str() );
+      if (quantile < 0) quantile = 0.;
+      if (quantile > 1.) quantile = 1.;
+      
+      quantiles.push_back( quantile );
+      
+   }
+   
+   if( quantiles.empty() ) quantiles.push_back( 1. );
+   
+   std::vector< float > sorted = quantiles;
+   std::sort( sorted.begin(), sorted.end(), std::greater< float >() );
+   
+   if( sorted != quantiles ) std::cout << "Quantiles are used from loose to tight, reordered them.\n";
+   
+   return sorted;
+   
+}
+
+
+/** Counts the entries where the values of all criteria lie inside their min/max.
+ * 
+ * The columns must all belong to the same tree and have the same length, so the same index is the same entry (the same true connection).
+ */
+unsigned long countInside( const std::vector< const std::vector< float >* >& columns, 
+                           const std::vector< float >& minima, const std::vector< float >& maxima ){
+   
+   
+   if( columns.empty() ) return 0;
+   
+   unsigned long nInside = 0;
+   unsigned long nEntries = columns[0]->size();
+   
+   for( unsigned i=1; i < columns.size(); i++ ) nEntries = std::min( nEntries, (unsigned long) columns[i]->size() ); // never read past a column
+   
+   for( unsigned long j=0; j < nEntries; j++ ){
+      
+      bool inside = true;
+      
+      for( unsigned i=0; i < columns.size(); i++ ){
+         
+         float value = (*columns[i])[j];
+         
+         if(( value < minima[i] ) || ( value > maxima[i] )){
+            
+            inside = false;
+            break;
+            
+         }
+         
+      }
+      
+      if( inside ) nInside++;
+      
+   }
+   
+   return nInside;
+   
+}
+
+
+/** Returns the values of a vector separated by spaces, the way Marlin reads a FloatVec */
+std::string toFloatVecString( const std::vector< float >& values ){
+   
+   
+   std::stringstream ss;
+   
+   for( unsigned i=0; i < values.size(); i++ ){
+      
+      if( i > 0 ) ss << " ";
+      ss << values[i];
+      
+   }
+   
+   return ss.str();
+   
+}
+
+
+/** Splits a comma separated list */
+std::vector< std::string > splitList( const std::string& list ){
+   
+   
+   std::vector< std::string > items;
+   
+   std::stringstream ss( list );
+   std::string item;
+   
+   while( std::getline( ss, item, ',' ) ) if( !item.empty() ) items.push_back( item );
+   
+   return items;
+   
+}
+
+
 /**
- * @param argv[1] quantile size
+ * Calculates the cut values of the criteria from the output of TrueTrackCritAnalyser.
  * 
- * @param argv[2] root file path
+ * If every root file has the tree "QuantileSketches" (TrueTrackCritAnalyser with QuantileSketches = true), the
+ * quantiles are taken from the sketches, merged over all files. Then the trees with the values of every true
+ * connection are not needed (WriteCritValueTrees = false), but the expected effect of the rounds can't be told,
+ * because the sketches don't know which values belong to the same connection.
+ * Otherwise the values are read from the trees 2Hit, 3Hit and 4Hit of all files.
+ * 
+ * @param argv[1] quantile size, or a comma separated list of quantiles, one per round of ForwardTracking (e.g. 0.999,0.99,0.97)
+ * 
+ * @param argv[2] root file path, or a comma separated list of them (e.g. the outputs of several jobs)
  * 
  * @param argv[3] output path
  * 
+ * @param argv[4] number of threads root may use for reading (optional, default 0 = no implicit multithreading)
+ * 
  */
 int main(int argc,char *argv[]){
    
    
-   float quantile = 1.;
+   std::vector< float > quantiles( 1, 1. );
    
-   if( argc >= 2 ) quantile = atof( argv[1] );
+   if( argc >= 2 ) quantiles = parseQuantiles( argv[1] );
    
    
    std::string ROOT_FILE_PATH = "/scratch/ilcsoft/Steers/TrueTracksCritAnalysis.root";
@@ -80,22 +378,49 @@ int main(int argc,char *argv[]){
    std::string OUTPUT_PATH = "quantile_analyser_output";
    if( argc >= 4 ) OUTPUT_PATH = argv[3];
    
+   int N_THREADS = 0;
+   if( argc >= 5 ) N_THREADS = atoi( argv[4] );
+   
+#ifdef R__USE_IMT
+   if( N_THREADS > 0 ) ROOT::EnableImplicitMT( N_THREADS ); // root then decompresses the baskets of the branches in parallel
+#else
+   if( N_THREADS > 0 ) std::cout << "Root was built without implicit multithreading, reading with one thread\n";
+#endif
+   
    
    std::ofstream myfile;
    myfile.open (OUTPUT_PATH.c_str() );
    
    
    
-
+   /**********************************************************************************************/
+   /*                Open ROOT files                                                             */
+   /**********************************************************************************************/
    
+   std::vector< std::string > rootFilePaths = splitList( ROOT_FILE_PATH );
+   std::vector< TFile* > rootFiles;
    
+   bool useSketches = !rootFilePaths.empty();
    
-   /**********************************************************************************************/
-   /*                Open ROOT file                                                              */
-   /**********************************************************************************************/
+   for( unsigned i=0; i < rootFilePaths.size(); i++ ){
+      
+      TFile* rootFile = new TFile( rootFilePaths[i].c_str() , "READ");
+      rootFiles.push_back( rootFile );
+      
+      if( rootFile->Get( "QuantileSketches" ) == NULL ) useSketches = false;
+      
+   }
+   
+   std::map< std::string , std::map< std::string , QuantileSketch > > sketches; // [critType][critName]
+   
+   if( useSketches ){
+      
+      std::cout << "Taking the quantiles from the quantile sketches of " << rootFiles.size() << " file(s)\n";
+      
+      for( unsigned i=0; i < rootFiles.size(); i++ ) readSketches( dynamic_cast< TTree* >( rootFiles[i]->Get( "QuantileSketches" ) ), sketches );
+      
+   }
    
-   TFile* rootFile = new TFile( ROOT_FILE_PATH.c_str() , "READ"); 
-
    
 
    std::set< std::string > critTypes = Criteria::getTypes();
@@ -104,51 +429,87 @@ int main(int argc,char *argv[]){
    
    std::stringstream steerInfo("\n\n"); //for getting something that can be used in the marlin steer file
    std::stringstream steerInfob; // a second part
+   std::stringstream reductionInfo; // the expected effect of the rounds
    
    for( iType = critTypes.begin(); iType != critTypes.end(); iType++ ){ // once for every type of criteria ( 1 type = 1 tree in ROOT file )
       
          
       std::map < std::string , std::vector <float> > map_name_value;
+      std::map < std::string , QuantileSketch > map_name_sketch;
       
       
       /**********************************************************************************************/
-      /*                Read out the tree                                                           */
+      /*                Read out the trees                                                          */
       /**********************************************************************************************/
       
       std::string critType = *iType;
       std::string treeName = critType;
       std::cout << "\n" << critType;
-   
-      TTree* tree = (TTree*) rootFile->Get( treeName.c_str() );
-      unsigned nTreeEntries = tree->GetEntries();
       
       std::set< std::string > crits = Criteria::getCriteriaNames( critType );
-      std::set< std::string >::iterator iCrit;
-      
-      
       
+      // the names of the criteria there are values or sketches of
+      std::set< std::string > critNames;
       
-      
-      for (unsigned j = 0; j< nTreeEntries; j++){
-      
+      if( useSketches ){
          
+         std::map< std::string , QuantileSketch >& typeSketches = sketches[ critType ];
          
-         for( iCrit = crits.begin(); iCrit != crits.end() ; iCrit++){
+         for( std::set< std::string >::iterator itCrit = crits.begin(); itCrit != crits.end(); itCrit++ ){
+            
+            std::map< std::string , QuantileSketch >::iterator itSketch = typeSketches.find( *itCrit );
             
+            if( itSketch == typeSketches.end() ){
+               
+               std::cout << "\nThere is no quantile sketch of " << *itCrit << ", skipping it.";
+               continue;
+               
+            }
             
-            std::string critName = *iCrit;
+            map_name_sketch.insert( *itSketch );
+            critNames.insert( *itCrit );
             
-            std::string branchName = critName;
+         }
+         
+      }
+      else{
+         
+         std::vector< TTree* > trees;
+         
+         for( unsigned i=0; i < rootFiles.size(); i++ ){
+            
+            TTree* tree = dynamic_cast< TTree* >( rootFiles[i]->Get( treeName.c_str() ) );
             
-            map_name_value[ critName ].push_back( 0. );
+            if( tree == NULL ){
+               
+               std::cout << "\nThere is no tree " << treeName << " in " << rootFilePaths[i] << ", skipping it.";
+               continue;
+               
+            }
             
-            tree -> SetBranchAddress ( branchName.c_str() , &(map_name_value[ critName ].back()) );
+            trees.push_back( tree );
             
+            // The same index in all columns has to be the same entry. So a criterion missing in one of the files 
+            // can't be used at all, else its column would be shorter and shifted against the others.
+            for( std::set< std::string >::iterator itCrit = crits.begin(); itCrit != crits.end(); ){
+               
+               if( tree->GetBranch( itCrit->c_str() ) == NULL ){
+                  
+                  std::cout << "\nThe tree " << treeName << " in " << rootFilePaths[i] << " has no branch " << *itCrit << ", dropping this criterion.";
+                  crits.erase( itCrit++ );
+                  
+               }
+               else itCrit++;
+               
+            }
             
          }
-       
-         tree->GetEntry(j);
-       
+         
+         for( unsigned i=0; i < trees.size(); i++ ) readColumns( trees[i], crits, map_name_value ); // the values of several files get appended
+         
+         for( std::map < std::string , std::vector <float> >::iterator itValues = map_name_value.begin(); itValues != map_name_value.end(); itValues++ ) 
+            critNames.insert( itValues->first );
+         
       }
    
       
@@ -157,36 +518,68 @@ int main(int argc,char *argv[]){
       /*                Analyse the Quantiles                                                       */
       /**********************************************************************************************/
       
-      // Now we have all our data from the tree stored in the vectors in the map. 
+      // Now we have all our data from the trees stored in the vectors (or the sketches) in the map. 
       
-      std::map < std::string , std::vector <float> >::iterator it;
+      std::vector< const std::vector< float >* > columns;
+      std::vector< std::vector< float > > minima( quantiles.size() ); // [round][criterion]
+      std::vector< std::vector< float > > maxima( quantiles.size() );
       
-      for( it= map_name_value.begin(); it != map_name_value.end(); it++ ){
+      std::set< std::string >::iterator it;
+      
+      for( it= critNames.begin(); it != critNames.end(); it++ ){
+         
          
+         std::string critName = *it;
+         const std::vector < float >& values = map_name_value[ critName ];
          
-         std::string critName = it->first;
-         std::vector < float > values = it->second;
+         // the selection reorders the values, but the original order is needed to count the connections inside all cuts
+         std::vector < float > selection;
       
-         float min = 0.;
-         float max = 0.;
+         std::vector< float > mins;
+         std::vector< float > maxs;
          
          float left = 0.5;
          float right = 0.5;
          Criteria::getLeftRight( critName, left, right );
          
-         calcMinMaxOfQuantile( values , min , max , quantile , left , right );
+         for( unsigned round=0; round < quantiles.size(); round++ ){
+            
+            float min = 0.;
+            float max = 0.;
+            
+            if( useSketches ) calcMinMaxOfQuantile( map_name_sketch.find( critName )->second , min , max , quantiles[round] , left , right );
+            else{
+               
+               selection = values;
+               calcMinMaxOfQuantile( selection , min , max , quantiles[round] , left , right );
+               
+            }
+            
+//             min -= 0.01*fabs(min); // So that the actual minimum is not the boarder, but inside by a little bit
+//             max += 0.01*fabs(max);
+            
+            std::cout << "\n" << critName << ": round " << round << " (quantile " << quantiles[round] << "): min = " << min << ", max = " << max;
+            
+            mins.push_back( min );
+            maxs.push_back( max );
+            
+            minima[round].push_back( min );
+            maxima[round].push_back( max );
+            
+         }
+         
+         if( !useSketches ) columns.push_back( &values );
          
-//          min -= 0.01*fabs(min); // So that the actual minimum is not the boarder, but inside by a little bit
-//          max += 0.01*fabs(max);
+         std::string minString = toFloatVecString( mins );
+         std::string maxString = toFloatVecString( maxs );
          
-         std::cout << "\n" << critName << ": min = " << min << ", max = " << max;
-         steerInfo << "\n<parameter name=\"" << critName << "_min\" type=\"float\">" << min << "</parameter>";
-         steerInfo << "\n<parameter name=\"" << critName << "_max\" type=\"float\">" << max << "</parameter>";
+         steerInfo << "\n<parameter name=\"" << critName << "_min\" type=\"FloatVec\">" << minString << "</parameter>";
+         steerInfo << "\n<parameter name=\"" << critName << "_max\" type=\"FloatVec\">" << maxString << "</parameter>";
          steerInfob << critName << "\n";
          
          
-         myfile << "--MyForwardTracking." << critName << "_min=" << min << "   ";
-         myfile << "--MyForwardTracking." << critName << "_max=" << max << "   ";
+         myfile << "--MyForwardTracking." << critName << "_min=\"" << minString << "\"   ";
+         myfile << "--MyForwardTracking." << critName << "_max=\"" << maxString << "\"   ";
          
          
          
@@ -197,6 +590,56 @@ int main(int argc,char *argv[]){
       
       
       
+      /**********************************************************************************************/
+      /*                Expected effect of the rounds                                               */
+      /**********************************************************************************************/
+      
+      // The trees only hold the values of true connections. So what can be estimated is how many of
+      // the true connections survive all the cuts of this type in a round. The fakes can't be counted from this.
+      
+      if( useSketches ){
+         
+         reductionInfo << "\n" << critType << ": not known from the quantile sketches";
+         continue;
+         
+      }
+      
+      if( columns.empty() ) continue;
+      
+      unsigned long nEntries = columns[0]->size();
+      unsigned long nPrevious = nEntries;
+      
+      bool sameLength = true;
+      for( unsigned i=1; i < columns.size(); i++ ) if( columns[i]->size() != nEntries ) sameLength = false;
+      
+      if( !sameLength ){
+         
+         std::cout << "\nERROR: the columns of " << critType << " have different lengths, can't count the connections inside the cuts:";
+         for( unsigned i=0; i < columns.size(); i++ ) std::cout << " " << columns[i]->size();
+         
+         reductionInfo << "\n" << critType << ": not known, the columns have different lengths";
+         continue;
+         
+      }
+      
+      reductionInfo << "\n" << critType << " (" << nEntries << " true connections, " << columns.size() << " criteria):";
+      
+      for( unsigned round=0; round < quantiles.size(); round++ ){
+         
+         unsigned long nInside = countInside( columns, minima[round], maxima[round] );
+         
+         double fractionKept = nEntries > 0 ? double( nInside ) / double( nEntries ) : 0.;
+         double fractionOfPrevious = nPrevious > 0 ? double( nInside ) / double( nPrevious ) : 0.;
+         
+         reductionInfo << "\n   round " << round << " (quantile " << quantiles[round] << "): "
+                       << nInside << " kept = " << 100.*fractionKept << "% of all, " 
+                       << 100.*fractionOfPrevious << "% of the previous round";
+         
+         nPrevious = nInside;
+         
+      }
+      
+      
    }
    
    steerInfo << "<parameter name=\"Criteria\" type=\"StringVec\">";
@@ -205,7 +648,10 @@ int main(int argc,char *argv[]){
    
    std::cout << steerInfo.str() ;
    
-   delete rootFile;
+   std::cout << "Expected true connections kept per round (all criteria of a type applied together):";
+   std::cout << reductionInfo.str() << "\n\n";
+   
+   for( unsigned i=0; i < rootFiles.size(); i++ ) delete rootFiles[i];
    
 
    myfile.close();
@@ -217,4 +663,3 @@ int main(int argc,char *argv[]){
    return 0;
    
 }
-
@@ -0,0 +1,109 @@
+#include "FTDBackgroundHit.h"
+
+#include <new>
+#include <mutex>
+
+
+namespace{
+   
+   /** The pool of the FTDBackgroundHits: the free slots of all blocks */
+   struct HitPool{
+      
+      std::mutex mutex;
+      std::vector< void* > freeSlots;
+      
+      /** Adds a new block to the free slots, the mutex must be locked */
+      void addBlock(){
+         
+         char* block = static_cast< char* >( ::operator new( FTDBackgroundHit::BLOCK_SIZE * sizeof( FTDBackgroundHit ) ) );
+         
+         // in reverse, so the slots are handed out in the order of the memory
+         for( unsigned i = FTDBackgroundHit::BLOCK_SIZE; i > 0; i-- ) freeSlots.push_back( block + ( i - 1 )*sizeof( FTDBackgroundHit ) );
+         
+      }
+      
+   };
+   
+   // Never destroyed, as hits may still be deleted when static objects are already gone
+   HitPool& getPool(){
+      
+      static HitPool* pool = new HitPool;
+      return *pool;
+      
+   }
+   
+}
+
+
+FTDBackgroundHit::FTDBackgroundHit( const FTDBackgroundHitTemplate& hitTemplate, const double* pos, float time ){
+   
+   
+   setCellID0( hitTemplate.cellID0 );
+   setType( hitTemplate.type );
+   setU( hitTemplate.u );
+   setV( hitTemplate.v );
+   setdU( hitTemplate.dU );
+   setdV( hitTemplate.dV );
+   
+   setPosition( pos );
+   setTime( time );
+   
+   
+}
+
+
+void* FTDBackgroundHit::operator new( std::size_t size ){
+   
+   
+   // a derived class is bigger than a slot
+   if( size != sizeof( FTDBackgroundHit ) ) return ::operator new( size );
+   
+   HitPool& pool = getPool();
+   std::lock_guard< std::mutex > lock( pool.mutex );
+   
+   if( pool.freeSlots.empty() ) pool.addBlock();
+   
+   void* slot = pool.freeSlots.back();
+   pool.freeSlots.pop_back();
+   
+   return slot;
+   
+   
+}
+
+
+void FTDBackgroundHit::operator delete( void* p, std::size_t size ){
+   
+   
+   if( p == NULL ) return;
+   
+   if( size != sizeof( FTDBackgroundHit ) ){
+      
+      ::operator delete( p );
+      return;
+      
+   }
+   
+   HitPool& pool = getPool();
+   std::lock_guard< std::mutex > lock( pool.mutex );
+   
+   pool.freeSlots.push_back( p );
+   
+   
+}
+
+
+void FTDBackgroundHit::allocate( unsigned n, std::vector< void* >& slots ){
+   
+   
+   HitPool& pool = getPool();
+   std::lock_guard< std::mutex > lock( pool.mutex );
+   
+   while( pool.freeSlots.size() < n ) pool.addBlock();
+   
+   slots.insert( slots.end(), pool.freeSlots.rbegin(), pool.freeSlots.rbegin() + n );
+   pool.freeSlots.resize( pool.freeSlots.size() - n );
+   
+   
+}
+
@@ -0,0 +1,141 @@
+#include "FTDBackgroundLibrary.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+
+namespace{
+   
+   const char LIBRARY_MAGIC[8] = { 'F', 'T', 'D', 'B', 'K', 'G', '0', '1' };
+   
+   struct LibraryHeader{
+      
+      char magic[8];
+      uint32_t nSensors;
+      uint32_t nFrames;
+      
+   };
+   
+}
+
+
+FTDBackgroundLibrary::FTDBackgroundLibrary( const std::string& fileName ): _data( NULL ), _size( 0 ){
+   
+   
+   int fd = open( fileName.c_str(), O_RDONLY );
+   if( fd < 0 ) throw std::runtime_error( "Can't open the background library " + fileName );
+   
+   struct stat fileStat;
+   if( fstat( fd, &fileStat ) != 0 || size_t( fileStat.st_size ) < sizeof( LibraryHeader ) ){
+      
+      close( fd );
+      throw std::runtime_error( fileName + " is no background library" );
+      
+   }
+   
+   _size = fileStat.st_size;
+   _data = mmap( NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0 );
+   close( fd ); // the mapping stays valid
+   
+   if( _data == MAP_FAILED ){
+      
+      _data = NULL;
+      throw std::runtime_error( "Can't map the background library " + fileName );
+      
+   }
+   
+   const LibraryHeader* header = static_cast< const LibraryHeader* >( _data );
+   _nSensors = header->nSensors;
+   _nFrames = header->nFrames;
+   _offsets = reinterpret_cast< const uint64_t* >( header + 1 );
+   _hits = reinterpret_cast< const FTDBackgroundLibraryHit* >( _offsets + _nFrames + 1 );
+   
+   size_t hitsStart = sizeof( LibraryHeader ) + ( size_t( _nFrames ) + 1 )*sizeof( uint64_t );
+   
+   if( memcmp( header->magic, LIBRARY_MAGIC, sizeof( LIBRARY_MAGIC ) ) != 0 || _nFrames == 0 || hitsStart > _size
+       || _offsets[ _nFrames ] != ( _size - hitsStart ) / sizeof( FTDBackgroundLibraryHit )
+       || hitsStart + _offsets[ _nFrames ]*sizeof( FTDBackgroundLibraryHit ) != _size ){
+      
+      munmap( _data, _size );
+      _data = NULL;
+      throw std::runtime_error( fileName + " is no background library or is truncated" );
+      
+   }
+   
+   // The frames and the sensors of the hits are used as indices without further checks, so a corrupt file
+   // has to fail here instead of reading outside of the mapping or the sensor table later.
+   std::string error;
+   
+   if( _offsets[0] != 0 ) error = "the first frame doesn't start at the first hit";
+   
+   for( unsigned i=0; i < _nFrames && error.empty(); i++ ){
+      
+      if( _offsets[i] > _offsets[i+1] ) error = "the frames are not in order";
+      
+   }
+   
+   for( uint64_t j=0; j < _offsets[ _nFrames ] && error.empty(); j++ ){
+      
+      if( _hits[j].sensor >= _nSensors ) error = "a hit is on a sensor that doesn't exist";
+      
+   }
+   
+   if( !error.empty() ){
+      
+      munmap( _data, _size );
+      _data = NULL;
+      throw std::runtime_error( fileName + " is a corrupt background library: " + error );
+      
+   }
+   
+   
+}
+
+
+FTDBackgroundLibrary::~FTDBackgroundLibrary(){
+   
+   if( _data != NULL ) munmap( _data, _size );
+   
+}
+
+
+void FTDBackgroundLibrary::write( const std::string& fileName, unsigned nSensors, const std::vector< std::vector< FTDBackgroundLibraryHit > >& frames ){
+   
+   
+   std::ofstream file( fileName.c_str(), std::ios::binary );
+   if( !file ) throw std::runtime_error( "Can't write the background library " + fileName );
+   
+   LibraryHeader header;
+   memcpy( header.magic, LIBRARY_MAGIC, sizeof( LIBRARY_MAGIC ) );
+   header.nSensors = nSensors;
+   header.nFrames = frames.size();
+   
+   file.write( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+   
+   uint64_t offset = 0;
+   file.write( reinterpret_cast< const char* >( &offset ), sizeof( offset ) );
+   
+   for( unsigned i=0; i < frames.size(); i++ ){
+      
+      offset += frames[i].size();
+      file.write( reinterpret_cast< const char* >( &offset ), sizeof( offset ) );
+      
+   }
+   
+   for( unsigned i=0; i < frames.size(); i++ ){
+      
+      if( !frames[i].empty() ) file.write( reinterpret_cast< const char* >( &frames[i][0] ), frames[i].size()*sizeof( FTDBackgroundLibraryHit ) );
+      
+   }
+   
+   if( !file ) throw std::runtime_error( "Error while writing the background library " + fileName );
+   
+   
+}
@@ -1,15 +1,24 @@
 #include "FTDBackgroundProcessor.h"
 
 #include <cmath>
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
 
 #include <CLHEP/Random/RandFlat.h>
 #include <CLHEP/Random/RandGauss.h>
 
+#include "PhiloxRandom.h"
+#include "FTDBackgroundLibrary.h"
+
 
 #include "EVENT/LCCollection.h"
 #include "IMPL/LCCollectionVec.h"
 #include "IMPL/TrackerHitPlaneImpl.h"
 #include "UTIL/LCTrackerConf.h"
+#include "UTIL/BitField64.h"
 #include <UTIL/ILDConf.h>
 #include "marlin/Global.h"
 #include "marlin/ProcessorEventSeeder.h"
@@ -30,6 +39,19 @@ using namespace lcio ;
 using namespace marlin ;
 using namespace std ;
 
+
+namespace{
+   
+  /** The uniform random numbers of the global CLHEP engine */
+  struct CLHEPFlat{
+     
+    double flat(){ return CLHEP::RandFlat::shoot(); }
+     
+  };
+   
+}
+
+
 FTDBackgroundProcessor aFTDBackgroundProcessor ;
 
 
@@ -117,6 +139,51 @@ FTDBackgroundProcessor::FTDBackgroundProcessor() : Processor("FTDBackgroundProce
 			      _integratedBX ,
 			      defaultIntegratedBX );
 
+  registerProcessorParameter( "BunchSpacing" ,
+			      "If > 0, every hit gets the time of a random one of the integrated bunch crossings: BX * BunchSpacing (in ns), BX = 0 ... IntegratedBX - 1, the event being at BX 0" ,
+			      _bunchSpacing ,
+			      float( 0. ) );
+
+  registerProcessorParameter( "RadialDensityExponent" ,
+			      "The hits are distributed on each sensor with a density proportional to r^-n, r being the distance from the beam axis (approximated by the distance along the middle line of the petal). 0 means uniform, else the distribution is tabulated in 100 bins" ,
+			      _radialDensityExponent ,
+			      float( 0. ) );
+
+  registerProcessorParameter( "UseCounterBasedRNG" ,
+			      "Draw the random numbers from a counter based generator keyed by the event seed and the sensor, so the sensors can be done in parallel" ,
+			      _useCounterBasedRNG ,
+			      bool( false ) );
+
+  registerProcessorParameter( "NumberOfThreads" ,
+			      "Number of threads creating the hits if UseCounterBasedRNG is set" ,
+			      _nThreads ,
+			      int( 1 ) );
+
+  registerProcessorParameter( "BackgroundLibraryMode" ,
+			      "\"\" to generate the background for every event, \"write\" to write a library of background frames in init, \"overlay\" to take the background from such a library" ,
+			      _libraryMode ,
+			      std::string( "" ) );
+
+  registerProcessorParameter( "BackgroundLibraryFile" ,
+			      "The file of the background library" ,
+			      _libraryFileName ,
+			      std::string( "FTDBackground.lib" ) );
+
+  registerProcessorParameter( "BackgroundLibraryFrames" ,
+			      "The number of frames written to the library" ,
+			      _nLibraryFramesToWrite ,
+			      int( 1000 ) );
+
+  registerProcessorParameter( "BackgroundLibrarySeed" ,
+			      "The seed of the first frame written to the library, the following ones count up from it" ,
+			      _librarySeed ,
+			      int( 0 ) );
+
+  registerProcessorParameter( "FramesPerEvent" ,
+			      "The number of library frames overlaid on every event" ,
+			      _framesPerEvent ,
+			      int( 1 ) );
+
   
 }
 
@@ -131,6 +198,36 @@ void FTDBackgroundProcessor::init() {
    
   Global::EVENTSEEDER->registerProcessor(this);
   
+  initSensorTable();
+  
+  _library = NULL;
+  
+  if( _libraryMode == "write" ) writeLibrary();
+  else if( _libraryMode == "overlay" ){
+     
+    try{
+       
+      _library = new FTDBackgroundLibrary( _libraryFileName );
+       
+    }
+    catch( std::runtime_error& e ){
+       
+      throw EVENT::Exception( std::string( "  Cannot use the background library: " ) + e.what() ) ;
+       
+    }
+     
+    if( _library->getNumberOfSensors() != _sensors.size() ){
+       
+      throw EVENT::Exception( "  The background library " + _libraryFileName + " was made for a different FTD" ) ;
+       
+    }
+     
+    streamlog_out( MESSAGE0 ) << "Overlaying " << _framesPerEvent << " of the " << _library->getNumberOfFrames() 
+                              << " frames of " << _libraryFileName << " on every event\n";
+     
+  }
+  else if( !_libraryMode.empty() ) throw EVENT::Exception( "  Unknown BackgroundLibraryMode " + _libraryMode ) ;
+  
 
 }
 
@@ -185,36 +282,363 @@ void FTDBackgroundProcessor::processEvent( LCEvent * evt ) {
   
   
   /**********************************************************************************************/
-  /*       Get geometry parameters and seed                                                         */
+  /*       Seed                                                                                 */
   /**********************************************************************************************/
 
-  dd4hep::Detector& theDetector = dd4hep::Detector::getInstance();
-  dd4hep::DetElement ftdDE = theDetector.detector("FTD") ;
-  dd4hep::rec::ZDiskPetalsData* ftd = ftdDE.extension<dd4hep::rec::ZDiskPetalsData>() ;
-  int nLayers = ftd->layers.size() ; 
-
   unsigned seed = Global::EVENTSEEDER->getSeed(this);   
   streamlog_out( DEBUG4 ) << "seed set to " << seed << "\n";
-  CLHEP::HepRandom::setTheSeed( seed );
-
-   
-  // map with tracking surfaces
-  dd4hep::rec::SurfaceManager& surfMan = *theDetector.extension< dd4hep::rec::SurfaceManager >() ;
-  const dd4hep::rec::SurfaceMap& surfMap = *surfMan.map( "world" ) ;
 
-   
-  CellIDEncoder<TrackerHitPlaneImpl> cellid_encoder( LCTrackerCellID::encoding_string() , colPixel ) ;
+  colPixel->parameters().setValue( LCIO::CellIDEncoding , LCTrackerCellID::encoding_string() ) ;
   
    
   /**********************************************************************************************/
   /*       Iterate over all sensors and create hits                                             */
   /**********************************************************************************************/
 
+  // the hits of every sensor, in the order of the sensor table
+  std::vector< std::vector< TrackerHitPlaneImpl* > > sensorHits( _sensors.size() );
+  
+  if( _library != NULL ) overlayLibraryFrames( seed, sensorHits );
+  else if( _useCounterBasedRNG ) generateHitsCounterBased( seed, sensorHits );
+  else{
+     
+    CLHEP::HepRandom::setTheSeed( seed );
+    CLHEPFlat random;
+     
+    std::vector< double > densities( _sensors.size() );
+   
+    for( unsigned i=0; i < _sensors.size(); i++ ){
+     
+      const FTDBackgroundSensor& sensor = _sensors[i];
+         
+      //generate a random density that's gaussian smeared around the average.
+      //And of course multiply the density with the number of integrations. (If we do this later at nHits, we will
+      //for lets say 100 integrations always a multiple of 100)
+      double density =  CLHEP::RandGauss::shoot( sensor.densityMean , sensor.densitySigma );
+               
+               
+      /* The following is for doublesided sensors:
+       * If we find a number of hits for the front sensor, then the back sensor should have the same
+       * number of hits (asuming the hits come from background particles and not detector errors)
+       * Therefore we save the densities and for back sensors we simply take the value from the front sensor.
+       * This is especially important for strip detectors and low background, because otherwise it would
+       * be often the case that the front has e.g. 2 hits and the back 0. 
+       * The spacepointbuilder can't make a spacepoint from that, there's nothing to overlap.
+       */
+      densities[i] = density;
+      if( sensor.frontSensor >= 0 ) density = densities[ sensor.frontSensor ];
+               
+               
+      //calculate the number of hits corresponding to the density on the sensor
+      unsigned nHits = unsigned( fabs( sensor.area*density ) ) ; // hit = density * area
+               
+      streamlog_out( DEBUG1 ) << "Placing " << nHits << " hits on: side"  
+                              << sensor.side << " layer"<< sensor.layer << " petal" << sensor.petal << " sensor" << sensor.sensor << "\n";
+               
+      createSensorHits( sensor, nHits, random, sensorHits[i] );
+         
+    }
+     
+  }
+  
+  
+  // add the hits to the collections in the order of the sensors, so the output doesn't depend on how they were made
   unsigned backgroundHitsTotal=0;
+  
+  // the hits on each layer, the first half for side -1, the second for side +1
+  std::vector< unsigned > nHitsOnLayer( 2*_nLayers , 0 );
+  
+  // make room in the collections for all hits at once
+  unsigned nPixelHits = 0;
+  unsigned nStripHits = 0;
+  for( unsigned i=0; i < _sensors.size(); i++ ) ( _sensors[i].isPixel ? nPixelHits : nStripHits ) += sensorHits[i].size();
+  
+  LCCollectionVec* colPixelVec = dynamic_cast< LCCollectionVec* >( colPixel );
+  LCCollectionVec* colStripVec = dynamic_cast< LCCollectionVec* >( colStrip );
+  if( colPixelVec != NULL ) colPixelVec->reserve( colPixelVec->size() + nPixelHits );
+  if( colStripVec != NULL && colStripVec != colPixelVec ) colStripVec->reserve( colStripVec->size() + nStripHits );
+  
+  for( unsigned i=0; i < _sensors.size(); i++ ){
+     
+    LCCollection* col = _sensors[i].isPixel ? colPixel : colStrip;
+     
+    for( unsigned j=0; j < sensorHits[i].size(); j++ ) col->addElement( sensorHits[i][j] );
+     
+    nHitsOnLayer[ ( _sensors[i].side + 1 )/2 * _nLayers + _sensors[i].layer ] += sensorHits[i].size();
+     
+  }
+  
+  for ( int side = -1; side <= 1; side+= 2 ){
+     
+    for ( int layer = 0; layer < _nLayers; layer++ ){
+          
+      unsigned nHitsOnThisLayer = nHitsOnLayer[ ( side + 1 )/2 * _nLayers + layer ];
+      
+      backgroundHitsTotal += nHitsOnThisLayer;
+      streamlog_out( DEBUG4 ) << "hits on side " << side << " layer " << layer << ": " << nHitsOnThisLayer << "\n";
+         
+    }
+      
+  }
+   
+  streamlog_out( DEBUG4 ) << "Total added background hits on all layers: " << backgroundHitsTotal << "\n";
+   
+   
+  
+  
+  _nEvt ++ ;
+}
+
+
+
+void FTDBackgroundProcessor::check( LCEvent * ) { 
+  // nothing to check here - could be used to fill checkplots in reconstruction processor
+}
+
+
+void FTDBackgroundProcessor::end(){ 
+  
+  delete _library;
+  _library = NULL;
+  
+  std::cout << "FTDBackgroundProcessor::end()  " << name() 
+            << " processed " << _nEvt << " events in " << _nRun << " runs "
+            << std::endl ;
+}
+
+
+template< class Random >
+void FTDBackgroundProcessor::createSensorHits( const FTDBackgroundSensor& sensor, unsigned nHits, Random& random, std::vector< TrackerHitPlaneImpl* >& hits ){
+   
+   
+  // take the memory for all hits of the sensor from the pool at once
+  std::vector< void* > slots;
+  slots.reserve( nHits );
+  FTDBackgroundHit::allocate( nHits, slots );
+  
+  hits.reserve( hits.size() + nHits );
+  
+  //So now we have the number of hits --> distribute them on the sensor
+  for (unsigned int iHit=0; iHit < nHits; iHit++){
+                  
+                  
+    // get a random position for the hit
+    double randX = random.flat();
+    double randY = random.flat();
+                  
+    double x = 0.;
+    double y = 0.;
+    getLocalPosition( sensor, randX, randY, x, y );
+                  
+    // only draw a time if wanted, so the positions stay the same as without times
+    float time = ( _bunchSpacing > 0. ) ? getRandTime( sensor, random.flat() ) : 0.;
+                  
+    hits.push_back( createHit( sensor, getGlobalPosition( sensor, x, y ), time, slots[iHit] ) );
+                  
+  }
+  
+  
+}
+
+
+float FTDBackgroundProcessor::getRandTime( const FTDBackgroundSensor& sensor, double randBX ){
+   
+   
+  unsigned bx = unsigned( randBX * sensor.integratedBX );
+  if( bx >= sensor.integratedBX ) bx = sensor.integratedBX - 1;
+  
+  return bx * _bunchSpacing;
+   
+   
+}
+
+
+TrackerHitPlaneImpl* FTDBackgroundProcessor::createHit( const FTDBackgroundSensor& sensor, const CLHEP::Hep3Vector& globalPos, float time, void* slot ){
+   
+   
+  double pos[] = { globalPos.x(), globalPos.y(), globalPos.z() };
+  
+  // the sensor constant fields come from the template, only position and time are set per hit
+  if( slot != NULL ) return ::new( slot ) FTDBackgroundHit( sensor.hitTemplate, pos, time );
+  
+  return new FTDBackgroundHit( sensor.hitTemplate, pos, time );
+   
+   
+}
+
+
+void FTDBackgroundProcessor::generateHitsCounterBased( unsigned seed, std::vector< std::vector< TrackerHitPlaneImpl* > >& sensorHits ){
+   
+   
+  std::atomic< unsigned > nextSensor( 0 );
+  
+  // Every sensor has its own generators, keyed by the seed and its cellID (side, layer, petal, sensor).
+  // Stream 0 gives the density, stream 1 the positions. So the sensors can be done in any order and thread.
+  auto work = [&](){
+     
+    for( unsigned i = nextSensor++; i < _sensors.size(); i = nextSensor++ ){
+       
+      const FTDBackgroundSensor& sensor = _sensors[i];
+      
+      PhiloxRandom positionRandom( seed, uint32_t( sensor.cellID0 ), 1 );
+      createSensorHits( sensor, getNumberOfHitsCounterBased( seed, i ), positionRandom, sensorHits[i] );
+       
+    }
+     
+  };
+  
+  std::vector< std::thread > threads;
+  for( int t=1; t < _nThreads; t++ ) threads.push_back( std::thread( work ) );
+  
+  work();
+  
+  for( unsigned t=0; t < threads.size(); t++ ) threads[t].join();
+  
+  
+}
+
+
+unsigned FTDBackgroundProcessor::getNumberOfHitsCounterBased( unsigned seed, unsigned i ){
+   
+   
+  const FTDBackgroundSensor& sensor = _sensors[i];
+  
+  // the back of a double sided petal gets the same density as the front, see processEvent()
+  const FTDBackgroundSensor& densitySensor = ( sensor.frontSensor >= 0 ) ? _sensors[ sensor.frontSensor ] : sensor;
+  
+  PhiloxRandom densityRandom( seed, uint32_t( densitySensor.cellID0 ), 0 );
+  double density = densityRandom.gauss( densitySensor.densityMean, densitySensor.densitySigma );
+  
+  return unsigned( fabs( sensor.area*density ) ) ;
+   
+   
+}
+
+
+void FTDBackgroundProcessor::writeLibrary(){
+   
+   
+  if( _nLibraryFramesToWrite < 1 ) throw EVENT::Exception( "  BackgroundLibraryFrames must be at least 1" ) ;
+  
+  std::vector< std::vector< FTDBackgroundLibraryHit > > frames( _nLibraryFramesToWrite );
+  unsigned long nHitsTotal = 0;
+  
+  // every frame is made like an event with the counter based generators, with the seed counting up
+  for( unsigned f=0; f < frames.size(); f++ ){
+     
+    uint32_t seed = uint32_t( _librarySeed ) + f;
+     
+    for( unsigned i=0; i < _sensors.size(); i++ ){
+       
+      unsigned nHits = getNumberOfHitsCounterBased( seed, i );
+      PhiloxRandom positionRandom( seed, uint32_t( _sensors[i].cellID0 ), 1 );
+      
+      for( unsigned j=0; j < nHits; j++ ){
+         
+        double randX = positionRandom.flat();
+        double randY = positionRandom.flat();
+        
+        double x = 0.;
+        double y = 0.;
+        getLocalPosition( _sensors[i], randX, randY, x, y );
+        
+        FTDBackgroundLibraryHit hit = { i, float( x ), float( y ) };
+        frames[f].push_back( hit );
+         
+      }
+       
+    }
+    
+    nHitsTotal += frames[f].size();
+     
+  }
+  
+  try{
+     
+    FTDBackgroundLibrary::write( _libraryFileName, _sensors.size(), frames );
+     
+  }
+  catch( std::runtime_error& e ){
+     
+    throw EVENT::Exception( std::string( "  Cannot write the background library: " ) + e.what() ) ;
+     
+  }
+  
+  streamlog_out( MESSAGE0 ) << "Wrote " << frames.size() << " frames with " << nHitsTotal << " hits to " << _libraryFileName << "\n";
+   
+   
+}
+
+
+void FTDBackgroundProcessor::overlayLibraryFrames( unsigned seed, std::vector< std::vector< TrackerHitPlaneImpl* > >& sensorHits ){
+   
+   
+  // the choice of the frames and their rotations has its own stream, keyed by the seed only
+  PhiloxRandom random( seed, 0xFFFFFFFF, 2 );
+  
+  for( int k=0; k < _framesPerEvent; k++ ){
+     
+    unsigned frame = unsigned( random.flat() * _library->getNumberOfFrames() );
+    if( frame >= _library->getNumberOfFrames() ) frame = _library->getNumberOfFrames() - 1;
+     
+    // Rotate the frame in phi. The petals of a layer are evenly spaced, so a rotation by whole petals
+    // moves every hit onto the same spot of another sensor. rotation * number of petals gives the number of petals.
+    double rotation = random.flat();
+     
+    streamlog_out( DEBUG2 ) << "Overlaying frame " << frame << " rotated by " << rotation << " turns\n";
+     
+    std::vector< void* > slots;
+    slots.reserve( _library->endFrame( frame ) - _library->beginFrame( frame ) );
+    FTDBackgroundHit::allocate( _library->endFrame( frame ) - _library->beginFrame( frame ), slots );
+    unsigned nextSlot = 0;
+     
+    for( const FTDBackgroundLibraryHit* hit = _library->beginFrame( frame ); hit != _library->endFrame( frame ); ++hit ){
+       
+      const FTDBackgroundSensor& original = _sensors[ hit->sensor ];
+      
+      unsigned petal = ( original.petal + unsigned( rotation * original.nPetals ) ) % original.nPetals;
+      unsigned target = original.firstSensorOfLayer + petal * original.nSensorsPerPetal + ( original.sensor - 1 );
+      
+      const FTDBackgroundSensor& sensor = _sensors[ target ];
+      
+      // the library has no times, the bunch crossing is drawn here for the layer the hit ends up on
+      float time = ( _bunchSpacing > 0. ) ? getRandTime( sensor, random.flat() ) : 0.;
+      
+      sensorHits[ target ].push_back( createHit( sensor, getGlobalPosition( sensor, hit->x, hit->y ), time, slots[ nextSlot++ ] ) );
+       
+    }
+     
+  }
+   
+   
+}
+
+
+void FTDBackgroundProcessor::initSensorTable(){
+   
+   
+  dd4hep::Detector& theDetector = dd4hep::Detector::getInstance();
+  dd4hep::DetElement ftdDE = theDetector.detector("FTD") ;
+  dd4hep::rec::ZDiskPetalsData* ftd = ftdDE.extension<dd4hep::rec::ZDiskPetalsData>() ;
+  _nLayers = ftd->layers.size() ; 
+  
+  if( int( _backgroundDensity.size() ) < _nLayers || int( _backgroundDensitySigma.size() ) < _nLayers || int( _integratedBX.size() ) < _nLayers ){
+     
+    throw EVENT::Exception( "  BackgroundHitDensity, BackgroundHitDensitySigma and IntegratedBX need a value for each of the FTD layers" ) ;
+     
+  }
+   
+  // map with tracking surfaces
+  dd4hep::rec::SurfaceManager& surfMan = *theDetector.extension< dd4hep::rec::SurfaceManager >() ;
+  const dd4hep::rec::SurfaceMap& surfMap = *surfMan.map( "world" ) ;
+  
+  UTIL::BitField64 encoder( LCTrackerCellID::encoding_string() );
+  
+  _sensors.clear();
    
   for ( int side = -1; side <= 1; side+= 2 ){ //for both sides
      
-    for ( int layer = 0; layer < nLayers; layer++ ){ //over all layers
+    for ( int layer = 0; layer < _nLayers; layer++ ){ //over all layers
           
          
       unsigned nModules = ftd->layers[layer].petalNumber ;
@@ -251,235 +675,207 @@ void FTDBackgroundProcessor::processEvent( LCEvent * evt ) {
       // Then deltaLength would be 0.5: that's how the length changes for every new petal.
          
       double sensorWidth = petalWidth / double( nSensorsOn1Side );
-         
-      unsigned nHitsOnThisLayer=0;
-         
+      
+      unsigned firstSensorOfLayer = _sensors.size();
          
       for( unsigned petal = 0; petal < nModules; petal++ ){ //over all petals
             
+        unsigned firstSensorOfPetal = _sensors.size();
             
-           
-	std::vector< double > densities;
-            
-            
-	for( unsigned sensor = 1; sensor <= nSensors; sensor++ ){ // over all sensors
-               
+        for( unsigned sensor = 1; sensor <= nSensors; sensor++ ){ // over all sensors
                
-	  cellid_encoder[ LCTrackerCellID::subdet() ] = ILDDetID::FTD  ;
-	  cellid_encoder[ LCTrackerCellID::side()   ] = side ;
-	  cellid_encoder[ LCTrackerCellID::layer()  ] = layer ;
-	  cellid_encoder[ LCTrackerCellID::module() ] = petal ;
-	  cellid_encoder[ LCTrackerCellID::sensor() ] = sensor ;
+          encoder.reset();
+          encoder[ LCTrackerCellID::subdet() ] = ILDDetID::FTD  ;
+          encoder[ LCTrackerCellID::side()   ] = side ;
+          encoder[ LCTrackerCellID::layer()  ] = layer ;
+          encoder[ LCTrackerCellID::module() ] = petal ;
+          encoder[ LCTrackerCellID::sensor() ] = sensor ;
                
+          dd4hep::rec::SurfaceMap::const_iterator si = surfMap.find( encoder.lowWord() )  ;
+          if( si == surfMap.end() ){
+             
+            std::stringstream s;
+            s << "  No surface for the FTD sensor side " << side << " layer " << layer << " petal " << petal << " sensor " << sensor ;
+            throw EVENT::Exception( s.str() ) ;
+             
+          }
+          
+          dd4hep::rec::ISurface* surf = si->second ; 
 
-	  dd4hep::rec::SurfaceMap::const_iterator si = surfMap.find( cellid_encoder.lowWord() )  ;
-	  dd4hep::rec::ISurface* surf = ( si != surfMap.end()  ?  si->second  : 0 )  ; 
-
-	  dd4hep::rec::Vector3D surfOrigin = surf->localToGlobal( dd4hep::rec::Vector2D( 0., 0. ) ) ;
-	  surfOrigin = (1./dd4hep::mm) * surfOrigin ;
-
-	  double petalPhi = surfOrigin.phi() ;
+          dd4hep::rec::Vector3D surfOrigin = surf->localToGlobal( dd4hep::rec::Vector2D( 0., 0. ) ) ;
+          surfOrigin = (1./dd4hep::mm) * surfOrigin ;
 
-	  unsigned nthSensorOnThisSide = (sensor-1)%nSensorsOn1Side; // the -1 is because sensors start with 1 (and not with 0)
+          unsigned nthSensorOnThisSide = (sensor-1)%nSensorsOn1Side; // the -1 is because sensors start with 1 (and not with 0)
 
-	  double sensorLengthMin = petalLengthMin + nthSensorOnThisSide * deltaLength;
-	  double sensorLengthMax = sensorLengthMin + deltaLength;
-	  double sensorRMin      = petalRMin + nthSensorOnThisSide * deltaLength;  
-	  double sensorZ         = side * surfOrigin.z() ;
-               
-	  double area = (sensorLengthMin + sensorLengthMax) * sensorWidth / 2. / 100.; // the area of the sensor in cm^2
-               
-               
-	  //generate a random density that's gaussian smeared around the average.
-	  //And of course multiply the density with the number of integrations. (If we do this later at nHits, we will
-	  //for lets say 100 integrations always a multiple of 100)
-	  double density =  CLHEP::RandGauss::shoot( _densityRegulator * _backgroundDensity[layer] * _integratedBX[ layer ] , _densityRegulator * _backgroundDensitySigma[layer] * _integratedBX[ layer ] );
-               
-               
-	  /* The following is for doublesided sensors:
-	   * If we find a number of hits for the front sensor, then the back sensor should have the same
-	   * number of hits (asuming the hits come from background particles and not detector errors)
-	   * Therefore we save the densities and for back sensors we simply take the value from the front sensor.
-	   * This is especially important for strip detectors and low background, because otherwise it would
-	   * be often the case that the front has e.g. 2 hits and the back 0. 
-	   * The spacepointbuilder can't make a spacepoint from that, there's nothing to overlap.
-	   */
-	  densities.push_back( density );
-	  if( isDoubleSided && sensor > nSensorsOn1Side )density = densities.at( sensor - nSensorsOn1Side -1 );
-               
-               
-	  //calculate the number of hits corresponding to the density on the sensor
-	  unsigned nHits = unsigned( fabs( area*density ) ) ; // hit = density * area
-               
-	  streamlog_out( DEBUG1 ) << "Placing " << nHits << " hits on: side"  
-				  << side << " layer"<< layer<< " petal" << petal << " sensor" << sensor << "\n";
-               
+          FTDBackgroundSensor data;
+          
+          data.side = side;
+          data.layer = layer;
+          data.petal = petal;
+          data.sensor = sensor;
+          data.cellID0 = encoder.lowWord();
+          data.isPixel = isPixel;
+          data.firstSensorOfLayer = firstSensorOfLayer;
+          data.nPetals = nModules;
+          data.nSensorsPerPetal = nSensors;
+          data.frontSensor = ( isDoubleSided && sensor > nSensorsOn1Side ) ? int( firstSensorOfPetal + sensor - nSensorsOn1Side - 1 ) : -1;
+          
+          data.lengthMin = petalLengthMin + nthSensorOnThisSide * deltaLength;
+          data.lengthMax = data.lengthMin + deltaLength;
+          data.width     = sensorWidth;
+          data.rMin      = petalRMin + nthSensorOnThisSide * sensorWidth;  
+          data.phi       = surfOrigin.phi() ;
+          data.z         = surfOrigin.z() ; // already on the right side
+          data.area      = (data.lengthMin + data.lengthMax) * sensorWidth / 2. / 100.; // the area of the sensor in cm^2
+          
+          data.integratedBX = std::max( _integratedBX[ layer ], 1 );
+          data.densityMean  = _densityRegulator * _backgroundDensity[layer] * _integratedBX[ layer ];
+          data.densitySigma = _densityRegulator * _backgroundDensitySigma[layer] * _integratedBX[ layer ];
+          
+          dd4hep::rec::Vector3D uVec = surf->u() ;
+          dd4hep::rec::Vector3D vVec = surf->v() ;
+                  
+          data.hitTemplate.cellID0 = data.cellID0;
+          data.hitTemplate.type = 0;
+          data.hitTemplate.u[0] = uVec.theta();
+          data.hitTemplate.u[1] = uVec.phi();
+          data.hitTemplate.v[0] = vVec.theta();
+          data.hitTemplate.v[1] = vVec.phi();
+          data.hitTemplate.dU = _resU;
+          data.hitTemplate.dV = _resV;
+          
+          if( !isPixel ){ // strip
+            
+            data.hitTemplate.type = UTIL::set_bit( data.hitTemplate.type , UTIL::ILDTrkHitTypeBit::ONE_DIMENSIONAL ) ;
+            data.hitTemplate.dV = 0; // no error in v direction for strip hits as there is no meesurement information in v direction
+            
+          }
+          
+          data.cosPhi = cos( data.phi );
+          data.sinPhi = sin( data.phi );
+          
+          // The hits are placed on the trapezoid, not on the surface. Make sure the two agree.
+          double cornersX[] = { 0., 0., data.width, data.width };
+          double cornersY[] = { -data.lengthMin/2., data.lengthMin/2., -data.lengthMax/2., data.lengthMax/2. };
+          
+          for( unsigned i=0; i < 4; i++ ){
+             
+            CLHEP::Hep3Vector corner = getGlobalPosition( data, cornersX[i], cornersY[i] );
+            
+            if( !surf->insideBounds( dd4hep::mm * dd4hep::rec::Vector3D( corner.x(), corner.y(), corner.z() ) ) ){
                
+              std::stringstream s;
+              s << "  The corner (" << corner.x() << ", " << corner.y() << ", " << corner.z() << ") mm of the FTD sensor side " << side 
+                << " layer " << layer << " petal " << petal << " sensor " << sensor << " is outside of its surface" ;
+              throw EVENT::Exception( s.str() ) ;
                
-	  //So now we have the number of hits --> distribute them on the sensor
-	  for (unsigned int iHit=0; iHit < nHits; iHit++){
-                  
-                  
-                  
-	    TrackerHitPlaneImpl* trkHit = new TrackerHitPlaneImpl ;        
-                 
-                  
-	    cellid_encoder.setCellID( trkHit ) ;
-                  
-	    // get a random position for the hit
-                  
-	    CLHEP::Hep3Vector globalPos;
-	    bool posOkay = false; 
-                  
-	    for( unsigned k=0; k < 100; k++ ){
-                     
-                     
-	      globalPos = getRandPosition( sensorRMin, sensorLengthMin, sensorLengthMax, sensorWidth, petalPhi, sensorZ );
-	      if( k >= 1 ) streamlog_out( DEBUG2 ) << "Retry number " << k << ", side" 
-						   << side << " layer"<< layer<< " petal" << petal << " sensor" << sensor << "\n";
-                     
-	      if ( surf->insideBounds( { globalPos[0]*dd4hep::mm ,globalPos[1]*dd4hep::mm , globalPos[2]*dd4hep::mm } ) ){
-                        
-		posOkay = true;
-		break;
-                        
-	      }
-                     
-	    }
-                  
-	    if( posOkay == false ){
-                     
-	      streamlog_out( ERROR ) << "After 100 tries the position was still not in the boundary!"
-				     << side << " layer"<< layer<< " petal" << petal << " sensor" << sensor << "\n";
-	      delete trkHit;
-	      continue;
-                     
-	    }
-                  
-	    double pos[] = { globalPos.x(), globalPos.y(), globalPos.z() };
-                  
-	    trkHit->setPosition( pos ) ;
-                  
-                  
-	    dd4hep::rec::Vector3D uVec = surf->u() ;
-	    dd4hep::rec::Vector3D vVec = surf->v() ;
-                  
-	    float u_direction[2] ;
-	    u_direction[0] = uVec.theta();
-	    u_direction[1] = uVec.phi();
-                  
-	    float v_direction[2] ;
-	    v_direction[0] = vVec.theta();
-	    v_direction[1] = vVec.phi();
-                  
-	    streamlog_out(DEBUG3) 
-	      << " U[0] = "<< u_direction[0] << " U[1] = "<< u_direction[1] 
-	      << " V[0] = "<< v_direction[0] << " V[1] = "<< v_direction[1]
-	      << std::endl ;
-                  
-	    trkHit->setU( u_direction ) ;
-	    trkHit->setV( v_direction ) ;
-                  
-	    trkHit->setdU( _resU ) ;
-	    trkHit->setdV( _resV ) ;
-                  
-                  
-                  
-	    if( ! isPixel ){ // strip
-                     
-	      trkHit->setType( UTIL::set_bit( trkHit->getType() , UTIL::ILDTrkHitTypeBit::ONE_DIMENSIONAL ) ) ;
-	      trkHit->setdV( 0 ); // no error in v direction for strip hits as there is no meesurement information in v direction
-                     
-	      colStrip->addElement( trkHit ); 
-	      nHitsOnThisLayer++;
-                     
-	    } else { // pixel
-                     
-	      colPixel->addElement( trkHit ); 
-	      nHitsOnThisLayer++;
-                     
-	    }
-                  
-                  
-                  
-	  }
+            }
+             
+          }
+          
+          initSampling( data );
+          
+          streamlog_out(DEBUG3) 
+            << " cellID0 = " << data.cellID0
+            << " U[0] = "<< data.hitTemplate.u[0] << " U[1] = "<< data.hitTemplate.u[1] 
+            << " V[0] = "<< data.hitTemplate.v[0] << " V[1] = "<< data.hitTemplate.v[1]
+            << std::endl ;
+          
+          _sensors.push_back( data );
                
-	}
+        }
             
       }
          
-      backgroundHitsTotal += nHitsOnThisLayer;
-      streamlog_out( DEBUG4 ) << "hits on side " << side << " layer " << layer << ": " << nHitsOnThisLayer << "\n";
-         
     }
       
   }
-   
-  streamlog_out( DEBUG4 ) << "Total added background hits on all layers: " << backgroundHitsTotal << "\n";
+  
+  streamlog_out( MESSAGE0 ) << "Cached the geometry of " << _sensors.size() << " FTD sensors\n";
    
    
-  
-  
-  _nEvt ++ ;
-}
-
-
-
-void FTDBackgroundProcessor::check( LCEvent * ) { 
-  // nothing to check here - could be used to fill checkplots in reconstruction processor
 }
 
 
-void FTDBackgroundProcessor::end(){ 
+void FTDBackgroundProcessor::initSampling( FTDBackgroundSensor& sensor ){
+   
+   
+  sensor.cdfX.clear();
   
-  std::cout << "FTDBackgroundProcessor::end()  " << name() 
-            << " processed " << _nEvt << " events in " << _nRun << " runs "
-            << std::endl ;
+  if( _radialDensityExponent == 0. ) return; // uniform, this has a closed form
+  
+  // the density along x (from the inner to the outer edge) is the length of the sensor at x times r^-n,
+  // r being the distance from the beam axis. Integrate it bin by bin.
+  unsigned nBins = 100;
+  double binWidth = sensor.width / nBins;
+  double slope = ( sensor.lengthMax - sensor.lengthMin ) / sensor.width;
+  
+  sensor.cdfX.push_back( 0. );
+  
+  for( unsigned i=0; i < nBins; i++ ){
+     
+    double x = ( i + 0.5 ) * binWidth;
+    double weight = ( sensor.lengthMin + slope * x ) * pow( sensor.rMin + x , -_radialDensityExponent ) * binWidth;
+     
+    sensor.cdfX.push_back( sensor.cdfX.back() + weight );
+     
+  }
+  
+  for( unsigned i=0; i <= nBins; i++ ) sensor.cdfX[i] /= sensor.cdfX.back();
+   
+   
 }
 
 
-CLHEP::Hep3Vector FTDBackgroundProcessor::getRandPosition( double rMin, double lengthMin, double lengthMax, double width, double phi, double z ){
+void FTDBackgroundProcessor::getLocalPosition( const FTDBackgroundSensor& sensor, double randX, double randY, double& x, double& y ){
    
    
-  CLHEP::Hep3Vector pos;
-   
-  pos.setZ( z );
-   
-   
-  // now we want an x and a y position.
-  // As hits are not evenly distributed in xy, there will be more hits near the beam,
-  // this simple approach might be alright:
-  // --> make a trapezoid with same shape centered around the x axis and with the bottom sitting at x = 0,
-  // --> get a evenly distributed random number for x between the bottom and the top
+  // Work on a trapezoid with the same shape, centered around the x axis and with the bottom sitting at x = 0:
+  // --> get x from the inverse of the cumulative distribution of the hits along x
   // --> calculate the y - width at this x
   // --> get a evenly distributed random number for y between left side and right side
-  // --> transfom this coordinates to those of the actual trapezoid
-   
-   
-  double x = CLHEP::RandFlat::shoot ( 0. ,width ); 
-  double yWidth = lengthMin + (lengthMax-lengthMin) * ( x / width );
+  // --> rotate and shift to the actual trapezoid (getGlobalPosition())
+  // As every point is inside the trapezoid, there is no need to check the bounds and retry.
    
-  double y = CLHEP::RandFlat::shoot ( -1.*yWidth/2. , yWidth/2. ); 
-   
-  // now transform to actual trapezoid
-  x += rMin;
-   
-  // now it has the right distance from 0. But it still needs rotation
-  double R = sqrt( x*x + y*y );
-  double phiStart = atan2( y, x );
-   
-  double phiFinal = phiStart + phi;
+  double slope = ( sensor.lengthMax - sensor.lengthMin ) / sensor.width;
+  
+  if( sensor.cdfX.empty() ){
+     
+    // uniform in the area: the density along x is the length l(x) = lengthMin + slope*x, so solving
+    // CDF(x) = ( lengthMin*x + slope*x^2/2 ) / area = randX for x gives (in a form that also works for slope = 0)
+    double a = randX * ( sensor.lengthMin + sensor.lengthMax ) * sensor.width / 2.;
+    x = 2.*a / ( sensor.lengthMin + sqrt( sensor.lengthMin*sensor.lengthMin + 2.*slope*a ) );
+     
+  }
+  else{
+     
+    // radially weighted: the bin of the tabulated CDF and linearly within it
+    unsigned nBins = sensor.cdfX.size() - 1;
+    unsigned bin = std::upper_bound( sensor.cdfX.begin(), sensor.cdfX.end(), randX ) - sensor.cdfX.begin() - 1;
+    if( bin >= nBins ) bin = nBins - 1;
+    
+    double binLow = sensor.cdfX[bin];
+    double binHigh = sensor.cdfX[bin+1];
+    double fraction = ( binHigh > binLow ) ? ( randX - binLow ) / ( binHigh - binLow ) : 0.5;
+    
+    x = ( bin + fraction ) * sensor.width / nBins;
+     
+  }
+  
+  double yWidth = sensor.lengthMin + slope * x;
+  y = ( randY - 0.5 ) * yWidth; 
    
    
-  x = R* cos(phiFinal);
-  y = R* sin(phiFinal);
+}
+
+
+CLHEP::Hep3Vector FTDBackgroundProcessor::getGlobalPosition( const FTDBackgroundSensor& sensor, double x, double y ){
    
-  pos.setX(x);
-  pos.setY(y);
    
-  return pos; 
+  // shift it to the right distance from 0 and rotate it
+  x += sensor.rMin;
    
+  return CLHEP::Hep3Vector( x * sensor.cosPhi - y * sensor.sinPhi , x * sensor.sinPhi + y * sensor.cosPhi , sensor.z );
    
    
 }
-
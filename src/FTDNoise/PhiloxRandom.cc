@@ -0,0 +1,112 @@
+#include "PhiloxRandom.h"
+
+#include <cmath>
+
+
+
+namespace{
+   
+   const uint32_t PHILOX_M0 = 0xD2511F53;
+   const uint32_t PHILOX_M1 = 0xCD9E8D57;
+   const uint32_t PHILOX_W0 = 0x9E3779B9;
+   const uint32_t PHILOX_W1 = 0xBB67AE85;
+   
+   
+   inline void mulhilo( uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo ){
+      
+      uint64_t product = uint64_t( a ) * uint64_t( b );
+      hi = uint32_t( product >> 32 );
+      lo = uint32_t( product );
+      
+   }
+   
+}
+
+
+PhiloxRandom::PhiloxRandom( uint32_t key0, uint32_t key1, uint32_t stream ):
+   _stream( stream ), _counter( 0 ), _nUsed( 4 ){
+   
+   
+   _key[0] = key0;
+   _key[1] = key1;
+   
+   
+}
+
+
+void PhiloxRandom::getBlock( const uint32_t counter[4], const uint32_t key[2], uint32_t block[4] ){
+   
+   
+   uint32_t c[4] = { counter[0], counter[1], counter[2], counter[3] };
+   uint32_t k[2] = { key[0], key[1] };
+   
+   for( unsigned round = 0; round < 10; round++ ){
+      
+      uint32_t hi0, lo0, hi1, lo1;
+      mulhilo( PHILOX_M0, c[0], hi0, lo0 );
+      mulhilo( PHILOX_M1, c[2], hi1, lo1 );
+      
+      uint32_t next[4] = { hi1 ^ c[1] ^ k[0], lo1, hi0 ^ c[3] ^ k[1], lo0 };
+      
+      c[0] = next[0];
+      c[1] = next[1];
+      c[2] = next[2];
+      c[3] = next[3];
+      
+      k[0] += PHILOX_W0;
+      k[1] += PHILOX_W1;
+      
+   }
+   
+   for( unsigned i=0; i < 4; i++ ) block[i] = c[i];
+   
+   
+}
+
+
+void PhiloxRandom::nextBlock(){
+   
+   
+   uint32_t counter[4] = { _counter, _stream, 0, 0 };
+   
+   getBlock( counter, _key, _block );
+   
+   _counter++;
+   _nUsed = 0;
+   
+   
+}
+
+
+uint32_t PhiloxRandom::nextWord(){
+   
+   if( _nUsed >= 4 ) nextBlock();
+   return _block[ _nUsed++ ];
+   
+}
+
+
+double PhiloxRandom::flat(){
+   
+   
+   // 27 + 26 = 53 bits, the + 0.5 keeps it away from 0 and 1
+   uint64_t a = nextWord() >> 5;
+   uint64_t b = nextWord() >> 6;
+   
+   return ( double( ( a << 26 ) | b ) + 0.5 ) / 9007199254740992.; // 2^53
+   
+   
+}
+
+
+double PhiloxRandom::gauss( double mean, double sigma ){
+   
+   
+   // Box-Muller
+   double u1 = flat();
+   double u2 = flat();
+   
+   return mean + sigma * sqrt( -2. * log( u1 ) ) * cos( 2. * M_PI * u2 );
+   
+   
+}
@@ -0,0 +1,380 @@
+#include "AutomatonRound.h"
+
+#include <exception>
+
+#include "KiTrack/Automaton.h"
+#include "Criteria/Criteria.h"
+#include "ILDImpl/IFTDHit.h"
+
+#include "marlin/VerbosityLevels.h"
+
+#include "Tools/KiTrackMarlinCEDTools.h"
+
+#include "ParallelSegmentBuilder.h"
+#include "FlatAutomaton.h"
+#include "SpeculativeRounds.h"
+#include "Crit2_DeltaTime.h"
+#include "IEndcapHit.h"
+
+
+using namespace KiTrackMarlin;
+
+
+AutomatonRound::AutomatonRound( const std::map< int , std::vector< IHit* > >& map_sector_hits, unsigned maxConnections, bool useFlatAutomaton ):
+_map_sector_hits( map_sector_hits ),
+_maxConnections( maxConnections ),
+_useFlatAutomaton( useFlatAutomaton ),
+_drawSegments( false ){
+   
+   
+}
+
+
+bool AutomatonRound::run( const std::vector< ICriterion* >& crit2Vec, const std::vector< ICriterion* >& crit3Vec,
+                          const std::vector< ICriterion* >& crit4Vec, ISectorConnector* sectorConnector, unsigned nThreads,
+                          const std::atomic< bool >* cancelled, std::vector< std::vector< IHit* > >& rawTracks ) const {
+   
+   
+   // a round that can be cancelled runs next to others, its output would be mixed with theirs
+   bool debugOutput = ( cancelled == NULL );
+   
+   
+   /**********************************************************************************************/
+   /*                Build the segments                                                          */
+   /**********************************************************************************************/
+   
+   if( debugOutput ) streamlog_out( DEBUG4 ) << "\t\t---SegementBuilder---\n" ;
+   
+   //Create a segmentbuilder
+   ParallelSegmentBuilder segBuilder( _map_sector_hits, nThreads );
+   
+   segBuilder.addCriteria ( crit2Vec ); // Add the criteria on when to connect two hits
+   
+   segBuilder.addSectorConnector ( sectorConnector ); // Add the sector connector (so the SegmentBuilder knows what hits from different sectors it is allowed to look for connections)
+   
+   segBuilder.setCancelFlag( cancelled );
+   
+   
+   // And get out the Cellular Automaton with the 1-segments.
+   // If there are too many connections, the building stops right when this is clear.
+   if( _useFlatAutomaton ){
+      
+      FlatAutomaton automaton( nThreads );
+      
+      if( !segBuilder.get1SegAutomaton( automaton, _maxConnections ) ){
+         
+         if( debugOutput ) streamlog_out( DEBUG4 ) << "Redo the Automaton with different parameters, because there are too many connections:\n"
+         << "\tconnections( > " << segBuilder.getNumberOfConnections() << " ) > MaxConnectionsAutomaton( " << _maxConnections << " )\n";
+         return false;
+         
+      }
+      
+      return runAutomaton( automaton, crit3Vec, crit4Vec, cancelled, rawTracks );
+      
+   }
+   else{
+      
+      Automaton automaton;
+      
+      if( !segBuilder.get1SegAutomaton( automaton, _maxConnections ) ){
+         
+         if( debugOutput ) streamlog_out( DEBUG4 ) << "Redo the Automaton with different parameters, because there are too many connections:\n"
+         << "\tconnections( > " << segBuilder.getNumberOfConnections() << " ) > MaxConnectionsAutomaton( " << _maxConnections << " )\n";
+         return false;
+         
+      }
+      
+      if( _drawSegments && debugOutput ) KiTrackMarlin::drawAutomatonSegments( automaton ); // draws the 1-segments (i.e. hits)
+      
+      return runAutomaton( automaton, crit3Vec, crit4Vec, cancelled, rawTracks );
+      
+   }
+   
+   
+}
+
+
+template< class AutomatonType >
+bool AutomatonRound::runAutomaton( AutomatonType& automaton, const std::vector< ICriterion* >& crit3Vec, const std::vector< ICriterion* >& crit4Vec,
+                                   const std::atomic< bool >* cancelled, std::vector< std::vector< IHit* > >& rawTracks ) const {
+   
+   
+   bool debugOutput = ( cancelled == NULL );
+   
+   
+   /**********************************************************************************************/
+   /*                Automaton                                                                   */
+   /**********************************************************************************************/
+   
+   
+   
+   if( debugOutput ) streamlog_out( DEBUG4 ) << "\t\t---Automaton---\n" ;
+   
+   
+   /*******************************/
+   /*      2-hit segments         */
+   /*******************************/
+   
+   if( debugOutput ) streamlog_out( DEBUG4 ) << "\t\t--2-hit-Segments--\n" ;
+   
+   if( debugOutput ) streamlog_out(DEBUG4) << "Automaton has " << automaton.getTracks( 3 ).size() << " track candidates\n"; //should be commented out, because it takes time
+   
+   automaton.clearCriteria();
+   automaton.addCriteria( crit3Vec );  // Add the criteria for 3 hits (i.e. 2 2-hit segments )
+   
+   
+   // Let the automaton lengthen its 1-hit-segments to 2-hit-segments
+   automaton.lengthenSegments();
+   
+   if( debugOutput ) streamlog_out( DEBUG3 ) << "Automaton has " << automaton.getNumberOfConnections() << " connections of 2-hit segments\n";
+   
+   
+   // So now we have 2-hit-segments and are ready to perform the Cellular Automaton.
+   
+   // Perform the automaton
+   automaton.doAutomaton();
+   
+   
+   // Clean segments with bad states
+   automaton.cleanBadStates();
+   
+   
+   // Reset the states of all segments
+   automaton.resetStates();
+   
+   if( debugOutput ) streamlog_out(DEBUG4) << "Automaton has " << automaton.getTracks( 3 ).size() << " track candidates\n"; //should be commented out, because it takes time
+   
+   
+   // A round run speculatively stops here if a looser one already made it
+   if( cancelled != NULL && *cancelled ) return false;
+   
+   // Check if there are not too many connections
+   if( automaton.getNumberOfConnections() > _maxConnections ){
+      
+      if( debugOutput ) streamlog_out( DEBUG4 ) << "Redo the Automaton with different parameters, because there are too many connections:\n"
+      << "\tconnections( " << automaton.getNumberOfConnections() << " ) > MaxConnectionsAutomaton( " << _maxConnections << " )\n";
+      return false;
+      
+   }
+   
+   /*******************************/
+   /*      3-hit segments         */
+   /*******************************/
+   if( debugOutput ) streamlog_out( DEBUG4 ) << "\t\t--3-hit-Segments--\n" ;
+   
+   
+   automaton.clearCriteria();
+   automaton.addCriteria( crit4Vec );
+   
+   
+   // Lengthen the 2-hit-segments to 3-hits-segments
+   automaton.lengthenSegments();
+   
+   if( debugOutput ) streamlog_out( DEBUG3 ) << "Automaton has " << automaton.getNumberOfConnections() << " connections of 3-hit segments\n";
+   
+   
+   // Perform the Cellular Automaton
+   automaton.doAutomaton();
+   
+   //Clean segments with bad states
+   automaton.cleanBadStates();
+   
+   
+   //Reset the states of all segments
+   automaton.resetStates();
+   
+   
+   if( debugOutput ) streamlog_out(DEBUG4) << "Automaton has " << automaton.getTracks( 3 ).size() << " track candidates\n"; //should be commented out, because it takes time
+   
+   
+   // A round run speculatively stops here if a looser one already made it
+   if( cancelled != NULL && *cancelled ) return false;
+   
+   // Check if there are not too many connections
+   if( automaton.getNumberOfConnections() > _maxConnections ){
+      
+      if( debugOutput ) streamlog_out( DEBUG4 ) << "Redo the Automaton with different parameters, because there are too many connections:\n"
+      << "\tconnections( " << automaton.getNumberOfConnections() << " ) > MaxConnectionsAutomaton( " << _maxConnections << " )\n";
+      return false;
+      
+   }
+   
+   // get the raw tracks (raw track = just a vector of hits, the most rudimentary form of a track)
+   rawTracks = automaton.getTracks( 3 );
+   
+   return true;
+   
+   
+}
+
+
+template< class HitType >
+bool KiTrackMarlin::createRoundCriteria( unsigned round, const std::vector< std::string >& criteriaNames,
+                                         const std::map< std::string , std::vector< float > >& critMinima,
+                                         const std::map< std::string , std::vector< float > >& critMaxima, float maxHitTimeDifference,
+                                         std::vector< ICriterion* >& crit2Vec, std::vector< ICriterion* >& crit3Vec, std::vector< ICriterion* >& crit4Vec ){
+   
+   bool newValuesGotUsed = false; // if new values are used
+   
+   for( unsigned i=0; i<criteriaNames.size(); i++ ){
+      
+      std::string critName = criteriaNames[i];
+      
+      const std::vector< float >& minima = critMinima.at( critName );
+      const std::vector< float >& maxima = critMaxima.at( critName );
+      
+      float min = minima.back();
+      float max = maxima.back();
+      
+      
+      
+      // use the value corresponding to the round, if there are no new ones for this criterion, just do nothing (the previous value stays in place)
+      if( round + 1 <= minima.size() ){
+         
+         min =  minima[round];
+         newValuesGotUsed = true;
+         
+      }
+      
+      if( round + 1 <= maxima.size() ){
+         
+         max =  maxima[round];
+         newValuesGotUsed = true;
+         
+      }
+      
+      ICriterion* crit = Criteria::createCriterion( critName, min , max );
+      
+      // Some debug output about the created criterion
+      std::string type = crit->getType();
+      
+      streamlog_out( DEBUG3 ) <<  "Added: Criterion " << critName << " (type =  " << type 
+      << " ). Min = " << min
+      << ", Max = " << max
+      << ", round " << round << "\n";
+      
+      
+      // Add the new criterion to the corresponding vector
+      if( type == "2Hit" ){
+         
+         crit2Vec.push_back( crit );
+         
+      }
+      else if( type == "3Hit" ){
+         
+         crit3Vec.push_back( crit );
+         
+      }
+      else if( type == "4Hit" ){
+         
+         crit4Vec.push_back( crit );
+         
+      }
+      else delete crit;
+      
+      
+   }
+   
+   // The time criterion is cheap and removes most of the background from other bunch crossings, so it goes first
+   if( maxHitTimeDifference >= 0. ) crit2Vec.insert( crit2Vec.begin(), new Crit2_DeltaTime< HitType >( 0., maxHitTimeDifference ) );
+   
+   return newValuesGotUsed;
+   
+   
+}
+
+
+bool KiTrackMarlin::runRoundsSpeculatively( const AutomatonRound& automatonRound, ISectorConnector* sectorConnector, unsigned nThreads,
+                                            const RoundCriteriaCreator& createCriteria, std::vector< std::vector< IHit* > >& rawTracks ){
+   
+   
+   // the criteria of all rounds, in the same order as the serial rounds use them
+   std::vector< std::vector< ICriterion* > > crit2Vecs;
+   std::vector< std::vector< ICriterion* > > crit3Vecs;
+   std::vector< std::vector< ICriterion* > > crit4Vecs;
+   
+   for( unsigned round=0; ; round++ ){
+      
+      std::vector< ICriterion* > crit2Vec;
+      std::vector< ICriterion* > crit3Vec;
+      std::vector< ICriterion* > crit4Vec;
+      
+      bool newValuesGotUsed = createCriteria( round, crit2Vec, crit3Vec, crit4Vec );
+      
+      if( !newValuesGotUsed ){
+         
+         for( unsigned i=0; i < crit2Vec.size(); i++ ) delete crit2Vec[i];
+         for( unsigned i=0; i < crit3Vec.size(); i++ ) delete crit3Vec[i];
+         for( unsigned i=0; i < crit4Vec.size(); i++ ) delete crit4Vec[i];
+         break;
+         
+      }
+      
+      crit2Vecs.push_back( crit2Vec );
+      crit3Vecs.push_back( crit3Vec );
+      crit4Vecs.push_back( crit4Vec );
+      
+   }
+   
+   unsigned nRounds = crit2Vecs.size();
+   
+   
+   // A round runs in a single thread, the rounds run next to each other
+   auto runRound = [&]( unsigned r, const std::atomic< bool >* cancelled, std::vector< std::vector< IHit* > >& roundTracks ){
+      
+      return automatonRound.run( crit2Vecs[r], crit3Vecs[r], crit4Vecs[r], sectorConnector, 1, cancelled, roundTracks );
+      
+   };
+   
+   SpeculativeRounds speculativeRounds( nThreads );
+   
+   bool success = false;
+   std::exception_ptr exception;
+   
+   try{
+      
+      success = speculativeRounds.run( nRounds, runRound, rawTracks );
+      
+   }
+   catch( ... ){
+      
+      exception = std::current_exception();
+      
+   }
+   
+   
+   for( unsigned r=0; r < nRounds; r++ ){
+      
+      for( unsigned i=0; i < crit2Vecs[r].size(); i++ ) delete crit2Vecs[r][i];
+      for( unsigned i=0; i < crit3Vecs[r].size(); i++ ) delete crit3Vecs[r][i];
+      for( unsigned i=0; i < crit4Vecs[r].size(); i++ ) delete crit4Vecs[r][i];
+      
+   }
+   
+   if( exception ) std::rethrow_exception( exception );
+   
+   if( !success ){
+      
+      streamlog_out( DEBUG4 ) << "None of the " << nRounds << " rounds run speculatively has few enough connections\n";
+      return false;
+      
+   }
+   
+   streamlog_out( DEBUG4 ) << "Round " << speculativeRounds.getWinner() << " of " << nRounds << " rounds run speculatively in "
+                           << speculativeRounds.getNumberOfThreads() << " threads is used\n";
+   
+   return true;
+   
+   
+}
+
+
+template bool KiTrackMarlin::createRoundCriteria< IFTDHit >( unsigned, const std::vector< std::string >&,
+                                                            const std::map< std::string , std::vector< float > >&,
+                                                            const std::map< std::string , std::vector< float > >&, float,
+                                                            std::vector< ICriterion* >&, std::vector< ICriterion* >&, std::vector< ICriterion* >& );
+
+template bool KiTrackMarlin::createRoundCriteria< IEndcapHit >( unsigned, const std::vector< std::string >&,
+                                                               const std::map< std::string , std::vector< float > >&,
+                                                               const std::map< std::string , std::vector< float > >&, float,
+                                                               std::vector< ICriterion* >&, std::vector< ICriterion* >&, std::vector< ICriterion* >& );
@@ -0,0 +1,91 @@
+#include "Crit2_DeltaTime.h"
+
+#include <cmath>
+#include <sstream>
+
+#include "ILDImpl/IFTDHit.h"
+
+#include "IEndcapHit.h"
+
+
+
+using namespace KiTrackMarlin;
+
+
+template< class HitType >
+Crit2_DeltaTime< HitType >::Crit2_DeltaTime ( float deltaTimeMin , float deltaTimeMax ){
+   
+   
+   _deltaTimeMax = deltaTimeMax;
+   _deltaTimeMin = deltaTimeMin;
+   
+   _name = "Crit2_DeltaTime";
+   _type = "2Hit";
+   
+   _saveValues = false;
+   
+   
+}
+
+
+template< class HitType >
+bool Crit2_DeltaTime< HitType >::areCompatible( Segment* parent , Segment* child ){
+   
+   
+   if (( parent->getHits().size() == 1 )&&( child->getHits().size() == 1 )){ //a criterion for 1-segments
+      
+      
+      float timeA = 0.;
+      float timeB = 0.;
+      
+      // without two times, there is nothing to compare
+      if( !getHitTime( parent->getHits()[0], timeA ) || !getHitTime( child->getHits()[0], timeB ) ) return true;
+      
+      float deltaTime = fabs( timeA - timeB );
+      
+      if (_saveValues) _map_name_value["Crit2_DeltaTime"] = deltaTime;
+      
+      if ( deltaTime > _deltaTimeMax ) return false;
+      if ( deltaTime < _deltaTimeMin ) return false;
+      
+      
+   }
+   else{
+      
+      std::stringstream s;
+      s << "Crit2_DeltaTime::This criterion needs 2 segments with 1 hit each, passed was a "
+      <<  parent->getHits().size() << " hit segment (parent) and a "
+      <<  child->getHits().size() << " hit segment (child).";
+      
+      
+      throw BadSegmentLength( s.str() );
+      
+      
+   }
+   
+   
+   return true;
+   
+   
+   
+}
+
+
+template< class HitType >
+bool Crit2_DeltaTime< HitType >::getHitTime( IHit* hit, float& time ){
+   
+   
+   if( hit->isVirtual() ) return false;
+   
+   HitType* timedHit = dynamic_cast< HitType* >( hit );
+   if( timedHit == NULL ) return false;
+   
+   time = timedHit->getTrackerHit()->getTime();
+   return true;
+   
+   
+}
+
+
+template class KiTrackMarlin::Crit2_DeltaTime< IFTDHit >;
+template class KiTrackMarlin::Crit2_DeltaTime< IEndcapHit >;
@@ -1,94 +1,263 @@
+
 #include "EndcapSectorConnector.h"
 
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+#include <climits>
+
 
 using namespace KiTrackMarlin;
 
 
 // Constructor
 EndcapSectorConnector::EndcapSectorConnector( const SectorSystemEndcap* sectorSystemEndcap , unsigned layerStepMax, unsigned lastLayerToIP ){
-   
+
+   init( sectorSystemEndcap, layerStepMax, lastLayerToIP );
+
+   for( unsigned layer = 0; layer < _nLayers; layer++ )
+      for( unsigned layerStep = 1; layerStep <= _layerStepMax; layerStep++ )
+         for( unsigned iTheta = 0; iTheta < _nDivisionsInTheta; iTheta++ ) setFixedWindow( layer, layerStep, iTheta );
+
+}
+
+
+EndcapSectorConnector::EndcapSectorConnector( const SectorSystemEndcap* sectorSystemEndcap , unsigned layerStepMax, unsigned lastLayerToIP,
+                                              const std::vector< double >& layerZ, double ptMin, double Bz, unsigned toleranceBins ){
+
+   init( sectorSystemEndcap, layerStepMax, lastLayerToIP );
+
+
+   // The radius (in mm) of the helix of a track with the minimum pt: R = pt / ( 0.3 * B )
+   double RMin = 1000. * ptMin / ( 0.299792458 * fabs( Bz ) );
+
+   double dPhi = 2.*M_PI / _nDivisionsInPhi;
+   double dCosTheta = 2.0 / _nDivisionsInTheta;
+
+
+   for( unsigned layer = 0; layer < _nLayers; layer++ ){
+
+      for( unsigned layerStep = 1; layerStep <= _layerStepMax; layerStep++ ){
+
+         for( unsigned iTheta = 0; iTheta < _nDivisionsInTheta; iTheta++ ){
+
+            // The IP (layer 0) is not a target here, and without sensible z positions we can't do better than the fixed window
+            if( ( layer <= layerStep ) || ( layer >= layerZ.size() ) || !( RMin > 0. ) ){
+
+               setFixedWindow( layer, layerStep, iTheta );
+               continue;
+
+            }
+
+            double zOuter = fabs( layerZ[ layer ] );
+            double zInner = fabs( layerZ[ layer - layerStep ] );
+
+            if( !( zInner > 0. ) || !( zOuter > zInner ) ){
+
+               setFixedWindow( layer, layerStep, iTheta );
+               continue;
+
+            }
+
+
+            double cosLow  = -1. + iTheta*dCosTheta;
+            double cosHigh = cosLow + dCosTheta;
+
+            // the bin contains theta = 90 deg: nothing that reaches an endcap, so no need to be clever
+            if( ( cosLow < 0. ) && ( cosHigh > 0. ) ){
+
+               setFixedWindow( layer, layerStep, iTheta );
+               continue;
+
+            }
+
+            double absCosMin = std::min( fabs( cosLow ), fabs( cosHigh ) );
+            double absCosMax = std::max( fabs( cosLow ), fabs( cosHigh ) );
+
+            // The biggest tan(theta) of the hit seen from the IP on the outer layer
+            double tanThetaMax = sqrt( 1. - absCosMin*absCosMin ) / absCosMin;
+
+
+            // A track from the IP with helix radius R and polar angle theta has turned by the angle
+            // alpha = z * tan(theta) / R in the xy plane when reaching z. The hit is then seen under
+            // tan(theta') = 2R/z * sin( alpha/2 ) from the IP and its phi is shifted by alpha/2.
+            // For a hit seen under tan(theta') on the outer layer x = alpha/2 = asin( tan(theta') * zOuter / ( 2R ) )
+            // and the hit on the inner layer lies at a phi differing by x * ( 1 - zInner/zOuter ).
+            // This is largest for the smallest radius, i.e. the smallest pt.
+            double sinX = std::min( 1., tanThetaMax * zOuter / ( 2.*RMin ) );
+            double x = asin( sinX );
+
+            double deltaPhiMax = x * ( 1. - zInner / zOuter );
+
+            // two hits within deltaPhiMax can be one bin further apart than deltaPhiMax / dPhi
+            int phiHalfWidth = int( deltaPhiMax / dPhi ) + 1 + toleranceBins;
+
+
+            // Seen from the IP the hit on the inner layer has a bigger theta than the one on the outer layer:
+            // tan(theta'inner) / tan(theta'outer) = zOuter * sin( x * zInner / zOuter ) / ( zInner * sin(x) ),
+            // which is 1 for straight tracks and grows with the curvature.
+            double ratio = 1.;
+            if( sinX > 0. ) ratio = zOuter * sin( x * zInner / zOuter ) / ( zInner * sinX );
+
+            double absCosInnerMin = 1. / sqrt( 1. + tanThetaMax*ratio*tanThetaMax*ratio );
+
+            double cosInnerLow  = absCosInnerMin;
+            double cosInnerHigh = absCosMax;
+            if( cosHigh <= 0. ){ // the backward side
+
+               cosInnerLow  = -absCosMax;
+               cosInnerHigh = -absCosInnerMin;
+
+            }
+
+            int thetaLow  = int( ( cosInnerLow  + 1. ) / dCosTheta ) - int( toleranceBins );
+            int thetaHigh = int( ( cosInnerHigh + 1. ) / dCosTheta ) + int( toleranceBins );
+
+            // the bin edges themselves are calculated with rounding errors, so make sure the own bin is always in the window
+            thetaLow  = std::min( thetaLow , int( iTheta ) );
+            thetaHigh = std::max( thetaHigh, int( iTheta ) );
+
+            unsigned index = getWindowIndex( layer, layerStep, iTheta );
+            _phiHalfWidth[ index ] = phiHalfWidth;
+            _thetaLow[ index ]     = std::max( thetaLow , 0 );
+            _thetaHigh[ index ]    = std::min( thetaHigh, int( _nDivisionsInTheta ) - 1 );
+
+         }
+
+      }
+
+   }
+
+}
+
+
+void EndcapSectorConnector::init( const SectorSystemEndcap* sectorSystemEndcap , unsigned layerStepMax, unsigned lastLayerToIP ){
+
    _sectorSystemEndcap = sectorSystemEndcap ;
    _layerStepMax = layerStepMax ;
    _lastLayerToIP = lastLayerToIP ;
+   _occupancy = NULL ;
 
    _nLayers = sectorSystemEndcap->getNLayers();
    _nDivisionsInPhi = sectorSystemEndcap->getPhiSectors();
    _nDivisionsInTheta = sectorSystemEndcap->getThetaSectors();
 
+   unsigned nWindows = _nLayers * _layerStepMax * _nDivisionsInTheta;
+   _phiHalfWidth.assign( nWindows, 0 );
+   _thetaLow.assign( nWindows, 0 );
+   _thetaHigh.assign( nWindows, 0 );
+
 }
 
 
+void EndcapSectorConnector::setFixedWindow( unsigned layer, unsigned layerStep, unsigned iTheta ){
+
+   unsigned index = getWindowIndex( layer, layerStep, iTheta );
+
+   _phiHalfWidth[ index ] = 8;
+   _thetaLow[ index ]     = std::max( int( iTheta ) - 1, 0 );
+   _thetaHigh[ index ]    = std::min( int( iTheta ) + 1, int( _nDivisionsInTheta ) - 1 );
+
+}
+
 
 std::set< int > EndcapSectorConnector::getTargetSectors ( int sector ){
-   
-   
-   std::set <int> targetSectors;
 
-   //std::cout << " check : n layers " << _nLayers << " n phi divisions " << _nDivisionsInPhi << " n theta divisions " << _nDivisionsInTheta << std::endl ;
+
+   std::set <int> targetSectors;
 
    // Decode the sector integer,  and take the layer, phi and theta bin
-   
-   int iTheta = sector/(_nLayers*_nDivisionsInPhi) ;
-   
-   int iPhi = ((sector - (iTheta*_nLayers*_nDivisionsInPhi)) / _nLayers) ;
-   
-   int layer = sector - (iTheta*_nLayers*_nDivisionsInPhi) - (iPhi*_nLayers) ; 
-
-   // search for sectors at the neighbouring theta nad phi bins
-
-   int iPhi_Up    = iPhi + 8;
-   int iPhi_Low   = iPhi - 8;
-   int iTheta_Up  = iTheta + 1; 
-   int iTheta_Low = iTheta - 1;
-   if (iTheta_Low < 0) iTheta_Low = 0;
-   if (iTheta_Up  >= int(_nDivisionsInTheta)) iTheta_Up = _nDivisionsInTheta-1;
-   
-   //*************************************************************************************
-
-   
+
+   int iTheta = _sectorSystemEndcap->getTheta( sector );
+
+   int iPhi = _sectorSystemEndcap->getPhi( sector );
+
+   int layer = _sectorSystemEndcap->getLayer( sector );
+
+
    for( unsigned layerStep = 1; layerStep <= _layerStepMax; layerStep++ ){
-     
-     //streamlog_out(DEBUG3) << " EndcapSectorConnector: layer " << layer << std::endl ;
+
      if ( layer >= int(layerStep) ){ // +1 makes sense if I use IP as innermost layer
-       
+
        unsigned layerTarget = layer - layerStep;
 
-       //streamlog_out(DEBUG3) << " EndcapSectorConnector: layer " << layer << " layerTarget " << layerTarget << std::endl ;
-
-       //if (layerTarget >= 0 && layerTarget < 7 ){   // just a test to run cellular automaton over the whole VXD - SIT
-	 
-	 for (int ip = iPhi_Low ; ip <= iPhi_Up ; ip++){
-
-	   // catch wrap-around
-	   if (ip < 0) ip = _nDivisionsInPhi-1;          
-	   if (ip >= int(_nDivisionsInPhi)) ip = ip - _nDivisionsInPhi;
-	   
-	   for (int iT = iTheta_Low ; iT <= iTheta_Up ; iT++){
-	     
-	     targetSectors.insert( _sectorSystemEndcap->getSector ( layerTarget , ip , iT ) ); 
-	     
-	   }
-	 }
-	 //}
+       unsigned index = getWindowIndex( layer, layerStep, iTheta );
+
+       // search for sectors at the neighbouring theta and phi bins
+       int phiHalfWidth = _phiHalfWidth[ index ];
+       int nPhiBins = std::min( 2*phiHalfWidth + 1, int(_nDivisionsInPhi) );
+
+       if ( _occupancy != NULL ){ // only walk over the occupied sectors
+
+         for (int iT = _thetaLow[ index ] ; iT <= _thetaHigh[ index ] ; iT++){
+
+           _occupancy->forEachOccupiedSector( layerTarget, iT, iPhi - phiHalfWidth, nPhiBins,
+                                              [&targetSectors]( int targetSector ){ targetSectors.insert( targetSector ); } );
+
+         }
+         continue;
+
+       }
+
+       for ( int k = 0 ; k < nPhiBins ; k++ ){
+
+         // catch wrap-around
+         int ip = ( ( iPhi - phiHalfWidth + k ) % int(_nDivisionsInPhi) + int(_nDivisionsInPhi) ) % int(_nDivisionsInPhi);
+
+         for (int iT = _thetaLow[ index ] ; iT <= _thetaHigh[ index ] ; iT++){
+
+           targetSectors.insert( _sectorSystemEndcap->getSector ( layerTarget , ip , iT ) );
+
+         }
+       }
      }
    }
-   
+
 
    if ( layer > 0 && ( layer <= int(_lastLayerToIP) ) ){
-      
-     for (int ip = iPhi_Low ; ip <= iPhi_Up ; ip++){
-       
-       for (int iT = iTheta_Low ; iT <= iTheta_Up ; iT++){
-	 
-	 targetSectors.insert( 0 ) ;
-       }
-     }
+
+      if ( _occupancy == NULL || _occupancy->isOccupied( 0 ) ) targetSectors.insert( 0 ) ;
+
    }
-   
-										 
+
+
    return targetSectors;
-   
-   
+
+
 }
 
 
+std::string EndcapSectorConnector::getInfoOnWindows() const{
+
+
+   std::stringstream s;
+
+   for( unsigned layer = 2; layer < _nLayers; layer++ ){
+
+      for( unsigned layerStep = 1; layerStep <= _layerStepMax && layerStep < layer; layerStep++ ){
+
+         int phiMin = INT_MAX;
+         int phiMax = 0;
+         int thetaMax = 0;
+
+         for( unsigned iTheta = 0; iTheta < _nDivisionsInTheta; iTheta++ ){
+
+            unsigned index = getWindowIndex( layer, layerStep, iTheta );
+            phiMin = std::min( phiMin, _phiHalfWidth[ index ] );
+            phiMax = std::max( phiMax, _phiHalfWidth[ index ] );
+            thetaMax = std::max( thetaMax, _thetaHigh[ index ] - _thetaLow[ index ] + 1 );
+
+         }
+
+         s << " layer " << layer << " --> layer " << layer - layerStep
+           << ": phi half width " << phiMin << " - " << phiMax << " bins"
+           << ", theta width up to " << thetaMax << " bins\n";
+
+      }
+
+   }
+
+   return s.str();
+
+}
+
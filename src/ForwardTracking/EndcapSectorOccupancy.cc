@@ -0,0 +1,28 @@
+
+#include "EndcapSectorOccupancy.h"
+
+
+using namespace KiTrackMarlin;
+
+
+EndcapSectorOccupancy::EndcapSectorOccupancy( const SectorSystemEndcap* sectorSystemEndcap ){
+
+   _nLayers = sectorSystemEndcap->getNLayers();
+   _nDivisionsInPhi = sectorSystemEndcap->getPhiSectors();
+   _nDivisionsInTheta = sectorSystemEndcap->getThetaSectors();
+
+   unsigned nSectors = _nLayers * _nDivisionsInPhi * _nDivisionsInTheta;
+
+   _words.assign( ( nSectors + 63 ) / 64, 0 );
+
+}
+
+
+void EndcapSectorOccupancy::clear(){
+
+   for( unsigned i=0; i < _occupiedSectors.size(); i++ ) _words[ getBit( _occupiedSectors[i] ) >> 6 ] = 0;
+
+   _occupiedSectors.clear();
+
+}
+
@@ -0,0 +1,184 @@
+#include "FTDTransitionSectorConnector.h"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+
+using namespace KiTrackMarlin;
+
+
+namespace{
+   
+   
+   bool compareCountsDescending( const std::pair< std::pair< int, int >, unsigned long >& a,
+                                 const std::pair< std::pair< int, int >, unsigned long >& b ){
+      
+      if( a.second != b.second ) return a.second > b.second;
+      return a.first < b.first; // so the order doesn't depend on anything else
+      
+   }
+   
+   
+   std::vector< std::pair< std::pair< int, int >, unsigned long > > sortByCount( const SectorTransitionCounts& counts ){
+      
+      std::vector< std::pair< std::pair< int, int >, unsigned long > > sorted( counts.begin(), counts.end() );
+      std::sort( sorted.begin(), sorted.end(), compareCountsDescending );
+      return sorted;
+      
+   }
+   
+   
+}
+
+
+FTDTransitionSectorConnector::FTDTransitionSectorConnector( const SectorSystemFTD* sectorSystemFTD , const std::string& fileName, double coverage ){
+   
+   
+   SectorTransitionCounts counts;
+   readTable( fileName, sectorSystemFTD, counts );
+   
+   
+   unsigned long nTotal = 0;
+   for( SectorTransitionCounts::const_iterator it = counts.begin(); it != counts.end(); it++ ) nTotal += it->second;
+   
+   
+   std::vector< std::pair< std::pair< int, int >, unsigned long > > sorted = sortByCount( counts );
+   
+   _nTransitions = 0;
+   unsigned long nCovered = 0;
+   
+   for( unsigned i=0; i < sorted.size(); i++ ){
+      
+      if( nCovered >= coverage * nTotal ) break;
+      
+      _targets[ sorted[i].first.first ].insert( sorted[i].first.second );
+      
+      nCovered += sorted[i].second;
+      _nTransitions++;
+      
+   }
+   
+   _coverage = nTotal > 0 ? double( nCovered ) / double( nTotal ) : 0.;
+   
+   
+}
+
+
+std::set< int > FTDTransitionSectorConnector::getTargetSectors ( int sector ){
+   
+   
+   std::map< int, std::set< int > >::const_iterator it = _targets.find( sector );
+   
+   if( it == _targets.end() ) return std::set< int >();
+   
+   return it->second;
+   
+   
+}
+
+
+void FTDTransitionSectorConnector::writeTable( std::ostream& os, const SectorSystemFTD* sectorSystemFTD, const SectorTransitionCounts& counts ){
+   
+   
+   unsigned long nTotal = 0;
+   for( SectorTransitionCounts::const_iterator it = counts.begin(); it != counts.end(); it++ ) nTotal += it->second;
+   
+   os << "# Transitions between the sectors of consecutive hits of true tracks\n";
+   os << "# SectorSystemFTD " << sectorSystemFTD->getNLayers() << " " << sectorSystemFTD->getNModules() << " " << sectorSystemFTD->getNSensors() << "\n";
+   os << "# transitions " << nTotal << "\n";
+   os << "# outerSector innerSector count fraction coverage   side layer module sensor -> side layer module sensor\n";
+   
+   
+   std::vector< std::pair< std::pair< int, int >, unsigned long > > sorted = sortByCount( counts );
+   
+   unsigned long nCovered = 0;
+   
+   for( unsigned i=0; i < sorted.size(); i++ ){
+      
+      int outer = sorted[i].first.first;
+      int inner = sorted[i].first.second;
+      unsigned long count = sorted[i].second;
+      
+      nCovered += count;
+      
+      os << outer << " " << inner << " " << count << " "
+         << double( count ) / double( nTotal ) << " " << double( nCovered ) / double( nTotal ) << "   "
+         << sectorSystemFTD->getSide( outer ) << " " << sectorSystemFTD->getLayer( outer ) << " " 
+         << sectorSystemFTD->getModule( outer ) << " " << sectorSystemFTD->getSensor( outer ) << " -> "
+         << sectorSystemFTD->getSide( inner ) << " " << sectorSystemFTD->getLayer( inner ) << " " 
+         << sectorSystemFTD->getModule( inner ) << " " << sectorSystemFTD->getSensor( inner ) << "\n";
+      
+   }
+   
+   
+}
+
+
+void FTDTransitionSectorConnector::readTable( const std::string& fileName, const SectorSystemFTD* sectorSystemFTD, SectorTransitionCounts& counts ){
+   
+   
+   std::ifstream file( fileName.c_str() );
+   if( !file ) throw std::runtime_error( "FTDTransitionSectorConnector: can't open " + fileName );
+   
+   counts.clear();
+   
+   bool sectorSystemChecked = false;
+   
+   std::string line;
+   
+   while( std::getline( file, line ) ){
+      
+      
+      if( line.empty() ) continue;
+      
+      std::istringstream ss( line );
+      
+      if( line[0] == '#' ){
+         
+         std::string hash;
+         std::string key;
+         ss >> hash >> key;
+         
+         if( key == "SectorSystemFTD" ){
+            
+            unsigned nLayers = 0;
+            unsigned nModules = 0;
+            unsigned nSensors = 0;
+            ss >> nLayers >> nModules >> nSensors;
+            
+            if(( nLayers != sectorSystemFTD->getNLayers() ) || ( nModules != sectorSystemFTD->getNModules() ) 
+               || ( nSensors != sectorSystemFTD->getNSensors() ) ){
+               
+               std::ostringstream msg;
+               msg << "FTDTransitionSectorConnector: " << fileName << " was made for a sector system with "
+                   << nLayers << " layers, " << nModules << " modules and " << nSensors << " sensors";
+               throw std::runtime_error( msg.str() );
+               
+            }
+            
+            sectorSystemChecked = true;
+            
+         }
+         
+         continue;
+         
+      }
+      
+      int outer = 0;
+      int inner = 0;
+      unsigned long count = 0;
+      
+      if( !( ss >> outer >> inner >> count ) ) throw std::runtime_error( "FTDTransitionSectorConnector: can't read the line \"" + line + "\" in " + fileName );
+      
+      counts[ std::make_pair( outer, inner ) ] += count;
+      
+   }
+   
+   if( !sectorSystemChecked ) throw std::runtime_error( "FTDTransitionSectorConnector: " + fileName + " doesn't say which sector system it was made for" );
+   
+   
+}
+
@@ -0,0 +1,486 @@
+#include "FlatAutomaton.h"
+
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+
+#include "KiTrack/Segment.h"
+
+
+using namespace KiTrackMarlin;
+
+
+
+FlatAutomaton::FlatAutomaton( unsigned nThreads ):
+_nThreads( nThreads > 0 ? nThreads : 1 ),
+_nHits( 0 ){
+   
+   
+   _layerBegin.push_back( 0 );
+   _stateBegin.push_back( 0 );
+   _childBegin.push_back( 0 );
+   
+   
+}
+
+
+void FlatAutomaton::set1Segments( const std::vector< IHit* >& hits, const std::vector< unsigned >& layers,
+                                  const std::vector< std::pair< unsigned, unsigned > >& connections ){
+   
+   
+   unsigned nSegments = hits.size();
+   
+   _nHits = 1;
+   _hits = hits;
+   _layers = layers;
+   
+   _states.assign( nSegments, 0 );
+   _stateBegin.resize( nSegments + 1 );
+   for( unsigned i=0; i <= nSegments; i++ ) _stateBegin[i] = i;
+   
+   // group the connections by parent, keeping their order
+   std::vector< unsigned > childBegin( nSegments + 1, 0 );
+   for( unsigned k=0; k < connections.size(); k++ ) childBegin[ connections[k].first + 1 ]++;
+   for( unsigned i=0; i < nSegments; i++ ) childBegin[i+1] += childBegin[i];
+   
+   std::vector< unsigned > children( connections.size() );
+   std::vector< unsigned > next( childBegin.begin(), childBegin.end() - 1 );
+   for( unsigned k=0; k < connections.size(); k++ ) children[ next[ connections[k].first ]++ ] = connections[k].second;
+   
+   sortByLayer( childBegin, children );
+   
+   
+}
+
+
+void FlatAutomaton::sortByLayer( const std::vector< unsigned >& childBegin, const std::vector< unsigned >& children ){
+   
+   
+   unsigned nSegments = _layers.size();
+   
+   unsigned nLayers = 0;
+   for( unsigned i=0; i < nSegments; i++ ) nLayers = std::max( nLayers, _layers[i] + 1 );
+   
+   _layerBegin.assign( nLayers + 1, 0 );
+   for( unsigned i=0; i < nSegments; i++ ) _layerBegin[ _layers[i] + 1 ]++;
+   for( unsigned l=0; l < nLayers; l++ ) _layerBegin[l+1] += _layerBegin[l];
+   
+   // the new position of every segment
+   std::vector< unsigned > newIndex( nSegments );
+   std::vector< unsigned > next( _layerBegin.begin(), _layerBegin.end() - 1 );
+   for( unsigned i=0; i < nSegments; i++ ) newIndex[i] = next[ _layers[i] ]++;
+   
+   std::vector< unsigned > order( nSegments );
+   for( unsigned i=0; i < nSegments; i++ ) order[ newIndex[i] ] = i;
+   
+   
+   std::vector< IHit* > hits( _hits.size() );
+   std::vector< unsigned > layers( nSegments );
+   std::vector< unsigned > stateBegin( nSegments + 1, 0 );
+   std::vector< int > states( _states.size() );
+   std::vector< unsigned > newChildBegin( nSegments + 1, 0 );
+   std::vector< unsigned > newChildren( children.size() );
+   
+   for( unsigned j=0; j < nSegments; j++ ){
+      
+      unsigned i = order[j];
+      
+      std::copy( _hits.begin() + i*_nHits, _hits.begin() + (i+1)*_nHits, hits.begin() + j*_nHits );
+      
+      layers[j] = _layers[i];
+      
+      stateBegin[j+1] = stateBegin[j] + _stateBegin[i+1] - _stateBegin[i];
+      std::copy( _states.begin() + _stateBegin[i], _states.begin() + _stateBegin[i+1], states.begin() + stateBegin[j] );
+      
+      newChildBegin[j+1] = newChildBegin[j] + childBegin[i+1] - childBegin[i];
+      for( unsigned k = childBegin[i]; k < childBegin[i+1]; k++ ) newChildren[ newChildBegin[j] + k - childBegin[i] ] = newIndex[ children[k] ];
+      
+   }
+   
+   _hits.swap( hits );
+   _layers.swap( layers );
+   _stateBegin.swap( stateBegin );
+   _states.swap( states );
+   _childBegin.swap( newChildBegin );
+   _children.swap( newChildren );
+   
+   
+}
+
+
+void FlatAutomaton::lengthenSegments(){
+   
+   
+   // Every connection becomes a new segment, numbered like the connections.
+   // As the segments are sorted by layer, this is the order the Automaton creates them in.
+   unsigned nSegments = _layers.size();
+   unsigned nNewSegments = _children.size();
+   unsigned nNewHits = _nHits + 1;
+   
+   std::vector< IHit* > hits( nNewSegments * nNewHits );
+   std::vector< unsigned > layers( nNewSegments );
+   std::vector< unsigned > stateBegin( nNewSegments + 1, 0 );
+   
+   for( unsigned parent=0; parent < nSegments; parent++ ){
+      
+      for( unsigned e = _childBegin[ parent ]; e < _childBegin[ parent + 1 ]; e++ ){
+         
+         unsigned child = _children[e];
+         
+         // the hits of the parent and the innermost hit of the child
+         std::copy( _hits.begin() + parent*_nHits, _hits.begin() + (parent+1)*_nHits, hits.begin() + e*nNewHits );
+         hits[ e*nNewHits + _nHits ] = _hits[ (child+1)*_nHits - 1 ];
+         
+         layers[e] = _layers[ child ];
+         
+         unsigned skippedLayers = ( _layers[ parent ] > _layers[ child ] ) ? _layers[ parent ] - _layers[ child ] - 1 : 0;
+         stateBegin[e+1] = stateBegin[e] + skippedLayers + 1;
+         
+      }
+      
+   }
+   
+   
+   // The criteria need segments
+   std::vector< Segment* > segments( nNewSegments );
+   for( unsigned e=0; e < nNewSegments; e++ ){
+      
+      segments[e] = new Segment( std::vector< IHit* >( hits.begin() + e*nNewHits, hits.begin() + (e+1)*nNewHits ) );
+      segments[e]->setLayer( layers[e] );
+      
+   }
+   
+   // The segment parent -> child is connected to all segments child -> grandchild that fulfill the criteria.
+   // The new segments are done in blocks, every block has its own buffer for the children.
+   const unsigned blockSize = 256;
+   unsigned nBlocks = ( nNewSegments + blockSize - 1 ) / blockSize;
+   
+   std::vector< unsigned > nChildren( nNewSegments, 0 );
+   std::vector< std::vector< unsigned > > blockChildren( nBlocks );
+   
+   std::atomic< unsigned > nextBlock( 0 );
+   std::mutex exceptionMutex;
+   std::exception_ptr exception;
+   
+   auto work = [&](){
+      
+      try{
+         
+         for( unsigned b = nextBlock++; b < nBlocks; b = nextBlock++ ){
+            
+            for( unsigned e = b*blockSize; e < std::min( (b+1)*blockSize, nNewSegments ); e++ ){
+               
+               unsigned child = _children[e];
+               
+               for( unsigned f = _childBegin[ child ]; f < _childBegin[ child + 1 ]; f++ ){
+                  
+                  bool allCriteriaOK = true;
+                  
+                  for( unsigned iCrit=0; iCrit < _criteria.size(); iCrit++ ){
+                     
+                     if( !_criteria[iCrit]->areCompatible( segments[e], segments[f] ) ){
+                        
+                        allCriteriaOK = false;
+                        break;
+                        
+                     }
+                     
+                  }
+                  
+                  if( allCriteriaOK ){
+                     
+                     blockChildren[b].push_back( f );
+                     nChildren[e]++;
+                     
+                  }
+                  
+               }
+               
+            }
+            
+         }
+         
+      }
+      catch( ... ){
+         
+         std::lock_guard< std::mutex > lock( exceptionMutex );
+         if( !exception ) exception = std::current_exception();
+         nextBlock = nBlocks;
+         
+      }
+      
+   };
+   
+   std::vector< std::thread > threads;
+   for( unsigned t=1; t < _nThreads && t < nBlocks; t++ ) threads.push_back( std::thread( work ) );
+   
+   work();
+   
+   for( unsigned t=0; t < threads.size(); t++ ) threads[t].join();
+   
+   for( unsigned e=0; e < nNewSegments; e++ ) delete segments[e];
+   
+   if( exception ) std::rethrow_exception( exception );
+   
+   
+   std::vector< unsigned > childBegin( nNewSegments + 1, 0 );
+   for( unsigned e=0; e < nNewSegments; e++ ) childBegin[e+1] = childBegin[e] + nChildren[e];
+   
+   std::vector< unsigned > children;
+   children.reserve( childBegin.back() );
+   for( unsigned b=0; b < nBlocks; b++ ) children.insert( children.end(), blockChildren[b].begin(), blockChildren[b].end() );
+   
+   _nHits = nNewHits;
+   _hits.swap( hits );
+   _layers.swap( layers );
+   _stateBegin.swap( stateBegin );
+   _states.assign( _stateBegin.back(), 0 );
+   
+   sortByLayer( childBegin, children );
+   
+   
+}
+
+
+void FlatAutomaton::doAutomaton(){
+   
+   
+   unsigned nSegments = _layers.size();
+   
+   // whether a segment has a child with an outer state equal to its inner state
+   std::vector< char > raise( nSegments, 0 );
+   
+   std::atomic< bool > hasChanged( true );
+   
+   while( hasChanged ){
+      
+      
+      hasChanged = false;
+      
+      // Look for neighbours. Only the states of the last sweep are read, so the segments can be done in any order.
+      forEachBlock( nSegments, [&]( unsigned begin, unsigned end ){
+         
+         bool changed = false;
+         
+         for( unsigned i = begin; i < end; i++ ){
+            
+            int innerState = getInnerState( i );
+            raise[i] = 0;
+            
+            for( unsigned k = _childBegin[i]; k < _childBegin[i+1]; k++ ){
+               
+               if( getOuterState( _children[k] ) == innerState ){
+                  
+                  raise[i] = 1;
+                  changed = true;
+                  break;
+                  
+               }
+               
+            }
+            
+         }
+         
+         if( changed ) hasChanged = true;
+         
+      } );
+      
+      // Update the states: the states of skipped layers follow one step (one per sweep, starting from the outside)
+      // and the inner state is raised if there was a neighbour. A segment only changes its own states.
+      forEachBlock( nSegments, [&]( unsigned begin, unsigned end ){
+         
+         bool changed = false;
+         
+         for( unsigned i = begin; i < end; i++ ){
+            
+            for( unsigned j = _stateBegin[i+1] - 1; j > _stateBegin[i]; j-- ){
+               
+               if( _states[j] == _states[j-1] ){
+                  
+                  _states[j]++;
+                  changed = true;
+                  break;
+                  
+               }
+               
+            }
+            
+            if( raise[i] ) _states[ _stateBegin[i] ]++;
+            
+         }
+         
+         if( changed ) hasChanged = true;
+         
+      } );
+      
+      
+   }
+   
+   
+}
+
+
+void FlatAutomaton::cleanBadStates(){
+   
+   
+   unsigned nSegments = _layers.size();
+   
+   std::vector< unsigned > newIndex( nSegments );
+   const unsigned REMOVED = unsigned( -1 );
+   
+   unsigned nKept = 0;
+   for( unsigned i=0; i < nSegments; i++ ) newIndex[i] = ( getInnerState( i ) == int( _layers[i] ) ) ? nKept++ : REMOVED;
+   
+   std::vector< IHit* > hits;
+   std::vector< unsigned > layers;
+   std::vector< unsigned > stateBegin( 1, 0 );
+   std::vector< int > states;
+   std::vector< unsigned > childBegin( 1, 0 );
+   std::vector< unsigned > children;
+   
+   hits.reserve( nKept * _nHits );
+   layers.reserve( nKept );
+   
+   // the connections to removed segments go as well
+   for( unsigned i=0; i < nSegments; i++ ){
+      
+      if( newIndex[i] == REMOVED ) continue;
+      
+      hits.insert( hits.end(), _hits.begin() + i*_nHits, _hits.begin() + (i+1)*_nHits );
+      layers.push_back( _layers[i] );
+      
+      states.insert( states.end(), _states.begin() + _stateBegin[i], _states.begin() + _stateBegin[i+1] );
+      stateBegin.push_back( states.size() );
+      
+      for( unsigned k = _childBegin[i]; k < _childBegin[i+1]; k++ ){
+         
+         if( newIndex[ _children[k] ] != REMOVED ) children.push_back( newIndex[ _children[k] ] );
+         
+      }
+      childBegin.push_back( children.size() );
+      
+   }
+   
+   _hits.swap( hits );
+   _layers.swap( layers );
+   _stateBegin.swap( stateBegin );
+   _states.swap( states );
+   
+   // the order stays, this only renews the layers
+   sortByLayer( childBegin, children );
+   
+   
+}
+
+
+void FlatAutomaton::resetStates(){
+   
+   
+   std::fill( _states.begin(), _states.end(), 0 );
+   
+   
+}
+
+
+std::vector< std::vector< IHit* > > FlatAutomaton::getTracks( unsigned minHits ){
+   
+   
+   std::vector< std::vector< IHit* > > tracks;
+   
+   std::vector< char > hasParent( _layers.size(), 0 );
+   for( unsigned k=0; k < _children.size(); k++ ) hasParent[ _children[k] ] = 1;
+   
+   std::vector< IHit* > hits;
+   
+   // start from the segments without parents, from the outside in
+   for( unsigned l = _layerBegin.size() - 1; l > 0; l-- ){
+      
+      for( unsigned i = _layerBegin[l-1]; i < _layerBegin[l]; i++ ){
+         
+         if( !hasParent[i] ) addTracksOfSegment( i, hits, minHits, tracks );
+         
+      }
+      
+   }
+   
+   return tracks;
+   
+   
+}
+
+
+void FlatAutomaton::addTracksOfSegment( unsigned i, std::vector< IHit* >& hits, unsigned minHits, std::vector< std::vector< IHit* > >& tracks ) const {
+   
+   
+   if( _childBegin[i] == _childBegin[i+1] ){ // the end of the track: add all the hits of the segment
+      
+      if( hits.size() + _nHits >= minHits ){
+         
+         tracks.push_back( hits );
+         tracks.back().insert( tracks.back().end(), _hits.begin() + i*_nHits, _hits.begin() + (i+1)*_nHits );
+         
+      }
+      
+      return;
+      
+   }
+   
+   // the other hits come with the children
+   hits.push_back( _hits[ i*_nHits ] );
+   
+   for( unsigned k = _childBegin[i]; k < _childBegin[i+1]; k++ ) addTracksOfSegment( _children[k], hits, minHits, tracks );
+   
+   hits.pop_back();
+   
+   
+}
+
+
+void FlatAutomaton::forEachBlock( unsigned n, const std::function< void( unsigned begin, unsigned end ) >& work ) const {
+   
+   
+   // starting threads costs more than a sweep over a few thousand segments
+   const unsigned blockSize = 4096;
+   unsigned nBlocks = ( n + blockSize - 1 ) / blockSize;
+   
+   if( _nThreads == 1 || nBlocks <= 1 ){
+      
+      work( 0, n );
+      return;
+      
+   }
+   
+   std::atomic< unsigned > nextBlock( 0 );
+   std::mutex exceptionMutex;
+   std::exception_ptr exception;
+   
+   auto doBlocks = [&](){
+      
+      try{
+         
+         for( unsigned b = nextBlock++; b < nBlocks; b = nextBlock++ ) work( b*blockSize, std::min( (b+1)*blockSize, n ) );
+         
+      }
+      catch( ... ){
+         
+         std::lock_guard< std::mutex > lock( exceptionMutex );
+         if( !exception ) exception = std::current_exception();
+         nextBlock = nBlocks;
+         
+      }
+      
+   };
+   
+   std::vector< std::thread > threads;
+   for( unsigned t=1; t < _nThreads && t < nBlocks; t++ ) threads.push_back( std::thread( doBlocks ) );
+   
+   doBlocks();
+   
+   for( unsigned t=0; t < threads.size(); t++ ) threads[t].join();
+   
+   if( exception ) std::rethrow_exception( exception );
+   
+   
+}
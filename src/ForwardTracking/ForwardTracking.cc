@@ -1,6 +1,9 @@
 #include "ForwardTracking.h"
 
 #include <algorithm>
+#include <sstream>
+#include <cstdlib>
+#include <stdexcept>
 
 #include "EVENT/TrackerHit.h"
 #include "EVENT/Track.h"
@@ -23,8 +26,6 @@
 //----From KiTrack-----------------------------
 #include "KiTrack/SubsetHopfieldNN.h"
 #include "KiTrack/SubsetSimple.h"
-#include "KiTrack/SegmentBuilder.h"
-#include "KiTrack/Automaton.h"
 
 //----From KiTrackMarlin-----------------------
 #include "ILDImpl/FTDTrack.h"
@@ -140,6 +141,56 @@ ForwardTracking::ForwardTracking() : Processor("ForwardTracking") {
                               int(1000));
    
    
+   registerProcessorParameter("SectorTransitionTable",
+                              "Table of the sector transitions of true tracks (from StepAnalyser) used to connect the sectors. Empty: connect neighbouring petals on the next layer",
+                              _sectorTransitionTable,
+                              std::string("") );
+   
+   registerProcessorParameter("SectorTransitionCoverage",
+                              "Fraction of the transitions in the SectorTransitionTable that stay connected",
+                              _sectorTransitionCoverage,
+                              float(0.999) );
+   
+   
+   registerProcessorParameter("HitTimeWindow",
+                              "Only hits with a time (TrackerHit::getTime()) in this window [min max] (in ns) are used. Empty: use all hits",
+                              _hitTimeWindow,
+                              std::vector< float >() );
+   
+   registerProcessorParameter("MaxHitTimeDifference",
+                              "Two hits are only connected if their times differ by at most this (in ns, criterion Crit2_DeltaTime). Negative: no time criterion",
+                              _maxHitTimeDifference,
+                              float(-1.) );
+   
+   registerProcessorParameter("SegmentBuilderThreads",
+                              "The number of threads connecting the hits to 1-segments (and lengthening the segments of the FlatAutomaton)",
+                              _segmentBuilderThreads,
+                              int(1) );
+   
+   registerProcessorParameter("UseFlatAutomaton",
+                              "Whether to run the Cellular Automaton with the FlatAutomaton (segments in flat arrays) instead of the Automaton of KiTrack",
+                              _useFlatAutomaton,
+                              bool(false) );
+   
+   registerProcessorParameter("SpeculativeRounds",
+                              "In events with more than SpeculativeRoundsMinHits hits, run the rounds with the different criteria at the same time in up to this many threads. 0 = the rounds are always run one after the other",
+                              _speculativeRounds,
+                              int(0) );
+   
+   registerProcessorParameter("SpeculativeRoundsMinHits",
+                              "The number of hits above which the rounds are run at the same time, see SpeculativeRounds",
+                              _speculativeRoundsMinHits,
+                              int(10000) );
+   
+   
+   // Parameter scan within one job
+   
+   registerProcessorParameter("ScanPoints",
+                              "Settings to rerun the tracking with on the same hits, one point per entry: Name=value,Name=value... (multiple criteria values separated by :). The tracks go to ForwardTrackCollection_scan<i>",
+                              _scanPointStrings,
+                              std::vector< std::string >() );
+   
+   
    //For fitting:
    
    registerProcessorParameter("MultipleScatteringOn",
@@ -225,6 +276,12 @@ void ForwardTracking::init() {
                     // can be printed. As this is mainly used for debugging it is not a steerable parameter.
    if( _useCED )MarlinCED::init(this) ;    //CED
    
+   if( !_hitTimeWindow.empty() && _hitTimeWindow.size() != 2 ){
+      
+      throw EVENT::Exception( "  HitTimeWindow needs two values: the minimum and the maximum time" ) ;
+      
+   }
+   
    
    /**********************************************************************************************/
    /*       Make a SectorSystemFTD                                                               */
@@ -253,6 +310,27 @@ void ForwardTracking::init() {
    _sectorSystemFTD = new SectorSystemFTD( nLayers, nModules , nSensors );
    
    
+   _transitionSectorConnector = NULL;
+   
+   if( !_sectorTransitionTable.empty() ){
+      
+      try{
+         
+         _transitionSectorConnector = new FTDTransitionSectorConnector( _sectorSystemFTD, _sectorTransitionTable, _sectorTransitionCoverage );
+         
+      }
+      catch( std::runtime_error& e ){
+         
+         throw EVENT::Exception( std::string("  Cannot use the SectorTransitionTable: ") + e.what() ) ;
+         
+      }
+      
+      streamlog_out( MESSAGE ) << "Using " << _transitionSectorConnector->getNumberOfTransitions() << " sector transitions from "
+                               << _sectorTransitionTable << ", covering " << _transitionSectorConnector->getCoverage() << " of the table\n";
+      
+   }
+   
+   
    // Get the B Field in z direction
 
   double bfieldV[3] ;
@@ -310,6 +388,23 @@ void ForwardTracking::init() {
    }
    
    
+   // Read the points of the parameter scan and try them once, so wrong names or values show up now and not in the first event
+   _scanPoints.clear();
+   
+   ForwardTrackingSettings defaultSettings = getSettings();
+   
+   for( unsigned i=0; i < _scanPointStrings.size(); i++ ){
+      
+      _scanPoints.push_back( parseScanPoint( _scanPointStrings[i] ) );
+      
+      applyScanPoint( _scanPoints.back() );
+      setSettings( defaultSettings );
+      
+      streamlog_out( MESSAGE ) << "Scan point " << i << " (" << getScanCollectionName( i ) << "): " << _scanPointStrings[i] << "\n";
+      
+   }
+   
+   
    
 
 }
@@ -408,6 +503,13 @@ void ForwardTracking::processEvent( LCEvent * evt ) {
             
          }
          
+         if( !_hitTimeWindow.empty() && ( trackerHit->getTime() < _hitTimeWindow[0] || trackerHit->getTime() > _hitTimeWindow[1] ) ){
+            
+            streamlog_out( DEBUG1 ) << "hit" << i << " with time " << trackerHit->getTime() << " is outside the HitTimeWindow, skipping it\n";
+            continue;
+            
+         }
+         
          streamlog_out(DEBUG1) << "hit" << i << " " << KiTrackMarlin::getCellID0Info( trackerHit->getCellID0() ) 
          << " " << KiTrackMarlin::getPositionInfo( trackerHit )<< "\n";
          
@@ -476,510 +578,474 @@ void ForwardTracking::processEvent( LCEvent * evt ) {
      
       
       /**********************************************************************************************/
-      /*                SegmentBuilder and Cellular Automaton                                       */
+      /*                Reconstruct the tracks                                                      */
       /**********************************************************************************************/
       
-      unsigned round = 0; // the round we are in
-      std::vector < RawTrack > rawTracks;
+      LCCollectionVec* trkCol = reconstructTracks( map_hitFront_hitsBack );
       
-      // The following while loop ideally only runs once. (So we do round 0 and everything works)
-      // It will repeat as long as the Automaton creates too many connections and as long as there are new criteria
-      // parameters to use to cut down the problem.
-      // Ideally already in round 0, there is a reasonable number of connections (not more than _maxConnectionsAutomaton), 
-      // so the loop will be left. If however there are too many connections we stay in the loop and use 
-      // (hopefully) tighter cut offs (if provided in the steering). This should prevent combinatorial breakdown
-      // for very evil events.
-      while( setCriteria( round ) ){
-         
-         
-         round++; // count up the round we are in
-         
-         
-         /**********************************************************************************************/
-         /*                Build the segments                                                          */
-         /**********************************************************************************************/
-         
-         streamlog_out( DEBUG4 ) << "\t\t---SegementBuilder---\n" ;
-         
-         //Create a segmentbuilder
-         SegmentBuilder segBuilder( _map_sector_hits );
-         
-         segBuilder.addCriteria ( _crit2Vec ); // Add the criteria on when to connect two hits. The vector has been filled by the method setCriteria
-         
-         //Also load hit connectors
-         unsigned layerStepMax = 1; // how many layers to go at max
-         unsigned petalStepMax = 1; // how many petals to go at max
-         unsigned lastLayerToIP = 5;// layer 1,2,3 and 4 get connected directly to the IP
-         FTDSectorConnector secCon( _sectorSystemFTD , layerStepMax , petalStepMax , lastLayerToIP );
-         
-         
-         segBuilder.addSectorConnector ( & secCon ); // Add the sector connector (so the SegmentBuilder knows what hits from different sectors it is allowed to look for connections)
-         
-         
-         // And get out the Cellular Automaton with the 1-segments 
-         Automaton automaton = segBuilder.get1SegAutomaton();
-         
-         // Check if there are not too many connections
-         if( automaton.getNumberOfConnections() > unsigned( _maxConnectionsAutomaton ) ){
-            
-            streamlog_out( DEBUG4 ) << "Redo the Automaton with different parameters, because there are too many connections:\n"
-            << "\tconnections( " << automaton.getNumberOfConnections() << " ) > MaxConnectionsAutomaton( " << _maxConnectionsAutomaton << " )\n";
-            continue;
-            
-         }
-         
-         
-         
-         /**********************************************************************************************/
-         /*                Automaton                                                                   */
-         /**********************************************************************************************/
-         
-         
-         
-         streamlog_out( DEBUG4 ) << "\t\t---Automaton---\n" ;
-         
-         if( _useCED ) KiTrackMarlin::drawAutomatonSegments( automaton ); // draws the 1-segments (i.e. hits)
-         
-         
-         /*******************************/
-         /*      2-hit segments         */
-         /*******************************/
-         
-         streamlog_out( DEBUG4 ) << "\t\t--2-hit-Segments--\n" ;
-         
-         streamlog_out(DEBUG4) << "Automaton has " << automaton.getTracks( 3 ).size() << " track candidates\n"; //should be commented out, because it takes time
-         
-         automaton.clearCriteria();
-         automaton.addCriteria( _crit3Vec );  // Add the criteria for 3 hits (i.e. 2 2-hit segments )
-         
-         
-         // Let the automaton lengthen its 1-hit-segments to 2-hit-segments
-         automaton.lengthenSegments();
-        
-         
-         // So now we have 2-hit-segments and are ready to perform the Cellular Automaton.
-         
-         // Perform the automaton
-         automaton.doAutomaton();
-         
-         
-         // Clean segments with bad states
-         automaton.cleanBadStates();
-         
-        
-         // Reset the states of all segments
-         automaton.resetStates();
-        
-         streamlog_out(DEBUG4) << "Automaton has " << automaton.getTracks( 3 ).size() << " track candidates\n"; //should be commented out, because it takes time
+      evt->addCollection(trkCol,_ForwardTrackCollection.c_str());
+      
+      streamlog_out (DEBUG5) << "Forward Tracking found and saved " << trkCol->getNumberOfElements() << " tracks in event " << _nEvt << "\n\n"; 
+      
+      
+      /**********************************************************************************************/
+      /*                Rerun on the same hits for the points of the parameter scan                 */
+      /**********************************************************************************************/
+      
+      // The hits, the overlap map, the geometry and the fitter are reused, only the tracking itself runs again.
+      if( !_scanPoints.empty() ){
          
+         ForwardTrackingSettings defaultSettings = getSettings();
          
-         // Check if there are not too many connections
-         if( automaton.getNumberOfConnections() > unsigned( _maxConnectionsAutomaton ) ){
+         for( unsigned iPoint=0; iPoint < _scanPoints.size(); iPoint++ ){
             
-            streamlog_out( DEBUG4 ) << "Redo the Automaton with different parameters, because there are too many connections:\n"
-            << "\tconnections( " << automaton.getNumberOfConnections() << " ) > MaxConnectionsAutomaton( " << _maxConnectionsAutomaton << " )\n";
-            continue;
-            
-         }
-         
-         /*******************************/
-         /*      3-hit segments         */
-         /*******************************/
-         streamlog_out( DEBUG4 ) << "\t\t--3-hit-Segments--\n" ;
-         
-         
-         automaton.clearCriteria();
-         automaton.addCriteria( _crit4Vec );      
-         
-         
-         // Lengthen the 2-hit-segments to 3-hits-segments
-         automaton.lengthenSegments();
-         
-         
-         // Perform the Cellular Automaton
-         automaton.doAutomaton();
-         
-         //Clean segments with bad states
-         automaton.cleanBadStates();
-         
-         
-         //Reset the states of all segments
-         automaton.resetStates();
-         
-         
-         streamlog_out(DEBUG4) << "Automaton has " << automaton.getTracks( 3 ).size() << " track candidates\n"; //should be commented out, because it takes time
-         
-         
-         // Check if there are not too many connections
-         if( automaton.getNumberOfConnections() > unsigned( _maxConnectionsAutomaton ) ){
+            try{
+               
+               applyScanPoint( _scanPoints[iPoint] );
+               
+               LCCollectionVec* scanCol = reconstructTracks( map_hitFront_hitsBack );
+               evt->addCollection( scanCol, getScanCollectionName( iPoint ).c_str() );
+               
+            }
+            catch( ... ){
+               
+               setSettings( defaultSettings ); // the next events start from the settings of the steering file
+               throw;
+               
+            }
             
-            streamlog_out( DEBUG4 ) << "Redo the Automaton with different parameters, because there are too many connections:\n"
-            << "\tconnections( " << automaton.getNumberOfConnections() << " ) > MaxConnectionsAutomaton( " << _maxConnectionsAutomaton << " )\n";
-            continue;
+            setSettings( defaultSettings );
             
          }
          
-         // get the raw tracks (raw track = just a vector of hits, the most rudimentary form of a track)
-         rawTracks = automaton.getTracks( 3 );
-         
-         break; // if we reached this place all went well and we don't need another round --> exit the loop
-         
       }
       
-      streamlog_out( DEBUG4 ) << "Automaton returned " << rawTracks.size() << " raw tracks \n";
       
       
       /**********************************************************************************************/
-      /*                Add the overlapping hits                                                    */
+      /*                Clean up                                                                    */
       /**********************************************************************************************/
       
+      // delete all the created IHits
+      for ( unsigned i=0; i<hitsTBD.size(); i++ )  delete hitsTBD[i];
       
-      streamlog_out( DEBUG4 ) << "\t\t---Add hits from overlapping petals + fit + helix and Kalman cuts---\n" ;
       
       
-      std::vector <ITrack*> trackCandidates;
       
       
-      // for all raw tracks we got from the automaton
-      for( unsigned i=0; i < rawTracks.size(); i++){
+   }
+
+
+
+
+   if( _useCED ) MarlinCED::draw(this);
+
+
+   _nEvt ++ ;
+   
+}
+
+
+
+
+
+LCCollectionVec* ForwardTracking::reconstructTracks( std::map< IHit* , std::vector< IHit* > >& map_hitFront_hitsBack ){
+   
+   
+   /**********************************************************************************************/
+   /*                SegmentBuilder and Cellular Automaton                                       */
+   /**********************************************************************************************/
+   
+   unsigned round = 0; // the round we are in
+   std::vector < RawTrack > rawTracks;
+   
+   // the sector connector tells the SegmentBuilder what hits from different sectors it is allowed to look for connections
+   ISectorConnector* sectorConnector = _transitionSectorConnector; // only the sector pairs true tracks use
+   FTDSectorConnector* secCon = NULL;
+   
+   if( sectorConnector == NULL ){
+      
+      //Also load hit connectors
+      unsigned layerStepMax = 1; // how many layers to go at max
+      unsigned petalStepMax = 1; // how many petals to go at max
+      unsigned lastLayerToIP = 5;// layer 1,2,3 and 4 get connected directly to the IP
+      secCon = new FTDSectorConnector( _sectorSystemFTD , layerStepMax , petalStepMax , lastLayerToIP );
+      sectorConnector = secCon;
+      
+   }
+   
+   // In very busy events, several rounds are run at the same time, so the time needed is not the sum of all rounds
+   unsigned nHits = 0;
+   std::map< int , std::vector< IHit* > >::iterator itSecHit;
+   for( itSecHit = _map_sector_hits.begin(); itSecHit != _map_sector_hits.end(); itSecHit++ ) nHits += itSecHit->second.size();
+   
+   bool speculative = ( _speculativeRounds > 1 ) && ( int( nHits ) > _speculativeRoundsMinHits );
+   
+   // A round: the 1-segments from the hits in _map_sector_hits and the Cellular Automaton on them
+   AutomatonRound automatonRound( _map_sector_hits, unsigned( _maxConnectionsAutomaton ), _useFlatAutomaton );
+   automatonRound.setDrawSegments( _useCED );
+   
+   if( speculative ){
+      
+      // the criteria of every round, made like setCriteria() does
+      auto createCriteria = [this]( unsigned r, std::vector< ICriterion* >& crit2Vec, std::vector< ICriterion* >& crit3Vec, std::vector< ICriterion* >& crit4Vec ){
+         
+         return createRoundCriteria< IFTDHit >( r, _criteriaNames, _critMinima, _critMaxima, _maxHitTimeDifference, crit2Vec, crit3Vec, crit4Vec );
          
+      };
+      
+      runRoundsSpeculatively( automatonRound, sectorConnector, unsigned( _speculativeRounds ), createCriteria, rawTracks );
+      
+   }
+   
+   // The following while loop ideally only runs once. (So we do round 0 and everything works)
+   // It will repeat as long as the Automaton creates too many connections and as long as there are new criteria
+   // parameters to use to cut down the problem.
+   // Ideally already in round 0, there is a reasonable number of connections (not more than _maxConnectionsAutomaton), 
+   // so the loop will be left. If however there are too many connections we stay in the loop and use 
+   // (hopefully) tighter cut offs (if provided in the steering). This should prevent combinatorial breakdown
+   // for very evil events.
+   while( !speculative && setCriteria( round ) ){
+      
+      
+      round++; // count up the round we are in
+      
+      if( automatonRound.run( _crit2Vec, _crit3Vec, _crit4Vec, sectorConnector, _segmentBuilderThreads, NULL, rawTracks ) ) break; // all went well and we don't need another round --> exit the loop
+      
+   }
+   
+   delete secCon;
+   secCon = NULL;
+   
+   streamlog_out( DEBUG4 ) << "Automaton returned " << rawTracks.size() << " raw tracks \n";
+   
+   
+   /**********************************************************************************************/
+   /*                Add the overlapping hits                                                    */
+   /**********************************************************************************************/
+   
+   
+   streamlog_out( DEBUG4 ) << "\t\t---Add hits from overlapping petals + fit + helix and Kalman cuts---\n" ;
+   
+   
+   std::vector <ITrack*> trackCandidates;
+   
+   
+   // for all raw tracks we got from the automaton
+   for( unsigned i=0; i < rawTracks.size(); i++){
+      
+      
+      RawTrack rawTrack = rawTracks[i];
+      
+      _nTrackCandidates++;
+      
+      
+      // get all versions of the track plus hits from overlapping petals
+      std::vector < RawTrack > rawTracksPlus = getRawTracksPlusOverlappingHits( rawTrack, map_hitFront_hitsBack );
+      
+      streamlog_out( DEBUG2 ) << "For raw track number " << i << " there are " << rawTracksPlus.size() << " versions\n";
+      
+      
+      /**********************************************************************************************/
+      /*                Make track candidates, fit them and throw away bad ones                     */
+      /**********************************************************************************************/
+      
+      std::vector< ITrack* > overlappingTrackCands;
+      
+      for( unsigned j=0; j < rawTracksPlus.size(); j++ ){
          
-         RawTrack rawTrack = rawTracks[i];
+         _nTrackCandidatesPlus++;
          
-         _nTrackCandidates++;
+         RawTrack rawTrackPlus = rawTracksPlus[j];
          
+         if( rawTrackPlus.size() < unsigned( _hitsPerTrackMin ) ){
+            
+            streamlog_out( DEBUG1 ) << "Trackversion discarded, too few hits: only " << rawTrackPlus.size() << " < " << _hitsPerTrackMin << "(hitsPerTrackMin)\n";
+            continue;
+            
+         }
          
-         // get all versions of the track plus hits from overlapping petals
-         std::vector < RawTrack > rawTracksPlus = getRawTracksPlusOverlappingHits( rawTrack, map_hitFront_hitsBack );
+         FTDTrack* trackCand = new FTDTrack( _trkSystem );
          
-         streamlog_out( DEBUG2 ) << "For raw track number " << i << " there are " << rawTracksPlus.size() << " versions\n";
+         // add the hits to the track
+         for( unsigned k=0; k<rawTrackPlus.size(); k++ ){
+            
+            IFTDHit* ftdHit = dynamic_cast< IFTDHit* >( rawTrackPlus[k] ); // cast to IFTDHits, as needed for an FTDTrack
+            if( ftdHit != NULL ) trackCand->addHit( ftdHit );
+            else streamlog_out( DEBUG4 ) << "Hit " << rawTrackPlus[k] << " could not be casted to IFTDHit\n";
+            
+         }
          
+         std::vector< IHit* > trackCandHits = trackCand->getHits();
+         streamlog_out( DEBUG2 ) << "Fitting track candidate with " << trackCandHits.size() << " hits\n";
          
-         /**********************************************************************************************/
-         /*                Make track candidates, fit them and throw away bad ones                     */
-         /**********************************************************************************************/
+         for( unsigned k=0; k < trackCandHits.size(); k++ ) streamlog_out( DEBUG1 ) << trackCandHits[k]->getPositionInfo();
+         streamlog_out( DEBUG1 ) << "\n";
          
-         std::vector< ITrack* > overlappingTrackCands;
+         /*-----------------------------------------------*/
+         /*                Helix Fit                      */
+         /*-----------------------------------------------*/
          
-         for( unsigned j=0; j < rawTracksPlus.size(); j++ ){
-            
-            _nTrackCandidatesPlus++;
+         streamlog_out( DEBUG2 ) << "Fitting with Helix Fit\n";
+         try{
             
-            RawTrack rawTrackPlus = rawTracksPlus[j];
+            FTDHelixFitter helixFitter( trackCand->getLcioTrack() );
+            float chi2OverNdf = helixFitter.getChi2() / float( helixFitter.getNdf() );
+            streamlog_out( DEBUG2 ) << "chi2OverNdf = " << chi2OverNdf << "\n";
             
-            if( rawTrackPlus.size() < unsigned( _hitsPerTrackMin ) ){
+            if( chi2OverNdf > _helixFitMax ){
                
-               streamlog_out( DEBUG1 ) << "Trackversion discarded, too few hits: only " << rawTrackPlus.size() << " < " << _hitsPerTrackMin << "(hitsPerTrackMin)\n";
+               streamlog_out( DEBUG2 ) << "Discarding track because of bad helix fit: chi2/ndf = " << chi2OverNdf << "\n";
+               delete trackCand;
                continue;
                
             }
+            else streamlog_out( DEBUG2 ) << "Keeping track because of good helix fit: chi2/ndf = " << chi2OverNdf << "\n";
             
-            FTDTrack* trackCand = new FTDTrack( _trkSystem );
-            
-            // add the hits to the track
-            for( unsigned k=0; k<rawTrackPlus.size(); k++ ){
-               
-               IFTDHit* ftdHit = dynamic_cast< IFTDHit* >( rawTrackPlus[k] ); // cast to IFTDHits, as needed for an FTDTrack
-               if( ftdHit != NULL ) trackCand->addHit( ftdHit );
-               else streamlog_out( DEBUG4 ) << "Hit " << rawTrackPlus[k] << " could not be casted to IFTDHit\n";
-               
-            }
-            
-            std::vector< IHit* > trackCandHits = trackCand->getHits();
-            streamlog_out( DEBUG2 ) << "Fitting track candidate with " << trackCandHits.size() << " hits\n";
+         }
+         catch( FTDHelixFitterException e ){
             
-            for( unsigned k=0; k < trackCandHits.size(); k++ ) streamlog_out( DEBUG1 ) << trackCandHits[k]->getPositionInfo();
-            streamlog_out( DEBUG1 ) << "\n";
             
-            /*-----------------------------------------------*/
-            /*                Helix Fit                      */
-            /*-----------------------------------------------*/
+            streamlog_out( DEBUG3 ) << "Track rejected, because fit failed: " <<  e.what() << "\n";
+            delete trackCand;
+            continue;
             
-            streamlog_out( DEBUG2 ) << "Fitting with Helix Fit\n";
-            try{
-               
-               FTDHelixFitter helixFitter( trackCand->getLcioTrack() );
-               float chi2OverNdf = helixFitter.getChi2() / float( helixFitter.getNdf() );
-               streamlog_out( DEBUG2 ) << "chi2OverNdf = " << chi2OverNdf << "\n";
-               
-               if( chi2OverNdf > _helixFitMax ){
-                  
-                  streamlog_out( DEBUG2 ) << "Discarding track because of bad helix fit: chi2/ndf = " << chi2OverNdf << "\n";
-                  delete trackCand;
-                  continue;
-                  
-               }
-               else streamlog_out( DEBUG2 ) << "Keeping track because of good helix fit: chi2/ndf = " << chi2OverNdf << "\n";
+         }
+         
+         /*-----------------------------------------------*/
+         /*                Kalman Fit                      */
+         /*-----------------------------------------------*/
+         
+         streamlog_out( DEBUG2 ) << "Fitting with Kalman Filter\n";
+         try{
                
-            }
-            catch( FTDHelixFitterException e ){
+            trackCand->fit();
                
+            streamlog_out( DEBUG2 ) << " Track " << trackCand 
+                                    << " chi2Prob = " << trackCand->getChi2Prob() 
+                                    << "( chi2=" << trackCand->getChi2() 
+                                    <<", Ndf=" << trackCand->getNdf() << " )\n";
                
-               streamlog_out( DEBUG3 ) << "Track rejected, because fit failed: " <<  e.what() << "\n";
-               delete trackCand;
-               continue;
                
-            }
-            
-            /*-----------------------------------------------*/
-            /*                Kalman Fit                      */
-            /*-----------------------------------------------*/
-            
-            streamlog_out( DEBUG2 ) << "Fitting with Kalman Filter\n";
-            try{
-                  
-               trackCand->fit();
-                  
-               streamlog_out( DEBUG2 ) << " Track " << trackCand 
-                                       << " chi2Prob = " << trackCand->getChi2Prob() 
-                                       << "( chi2=" << trackCand->getChi2() 
-                                       <<", Ndf=" << trackCand->getNdf() << " )\n";
-                  
-                  
-               if ( trackCand->getChi2Prob() >= _chi2ProbCut ){
-                  
-                  streamlog_out( DEBUG2 ) << "Track accepted (chi2prob " << trackCand->getChi2Prob() << " >= " << _chi2ProbCut << "\n";
-                  
-               }
-               else{
-                  
-                  streamlog_out( DEBUG2 ) << "Track rejected (chi2prob " << trackCand->getChi2Prob() << " < " << _chi2ProbCut << "\n";
-                  delete trackCand;
-                  
-                  continue;
-                  
-               }
+            if ( trackCand->getChi2Prob() >= _chi2ProbCut ){
                
+               streamlog_out( DEBUG2 ) << "Track accepted (chi2prob " << trackCand->getChi2Prob() << " >= " << _chi2ProbCut << "\n";
                
             }
-            catch( FitterException e ){
-               
+            else{
                
-               streamlog_out( DEBUG3 ) << "Track rejected, because fit failed: " <<  e.what() << "\n";
+               streamlog_out( DEBUG2 ) << "Track rejected (chi2prob " << trackCand->getChi2Prob() << " < " << _chi2ProbCut << "\n";
                delete trackCand;
+               
                continue;
                
             }
             
-            // If we reach this point than the track got accepted by all cuts
-            overlappingTrackCands.push_back( trackCand );
+            
+         }
+         catch( FitterException e ){
+            
+            
+            streamlog_out( DEBUG3 ) << "Track rejected, because fit failed: " <<  e.what() << "\n";
+            delete trackCand;
+            continue;
             
          }
          
-         /**********************************************************************************************/
-         /*                Take the best version of the track                                          */
-         /**********************************************************************************************/
-        // Now we have all versions of one track, coming from adding possible hits from overlapping petals.
+         // If we reach this point than the track got accepted by all cuts
+         overlappingTrackCands.push_back( trackCand );
          
-         if( _takeBestVersionOfTrack ){ // we want to take only the best version
-            
+      }
+      
+      /**********************************************************************************************/
+      /*                Take the best version of the track                                          */
+      /**********************************************************************************************/
+     // Now we have all versions of one track, coming from adding possible hits from overlapping petals.
+      
+      if( _takeBestVersionOfTrack ){ // we want to take only the best version
+         
+         
+         streamlog_out( DEBUG2 ) << "Take the version of the track with best quality from " << overlappingTrackCands.size() << " track candidates\n";
+         
+         if( !overlappingTrackCands.empty() ){
             
-            streamlog_out( DEBUG2 ) << "Take the version of the track with best quality from " << overlappingTrackCands.size() << " track candidates\n";
+            ITrack* bestTrack = overlappingTrackCands[0];
             
-            if( !overlappingTrackCands.empty() ){
+            for( unsigned j=1; j < overlappingTrackCands.size(); j++ ){
                
-               ITrack* bestTrack = overlappingTrackCands[0];
-               
-               for( unsigned j=1; j < overlappingTrackCands.size(); j++ ){
+               if( overlappingTrackCands[j]->getChi2Prob() > bestTrack->getChi2Prob() ){
+                  
+                  delete bestTrack; //delete the old one, not needed anymore
+                  bestTrack = overlappingTrackCands[j];
+               }
+               else{
                   
-                  if( overlappingTrackCands[j]->getChi2Prob() > bestTrack->getChi2Prob() ){
-                     
-                     delete bestTrack; //delete the old one, not needed anymore
-                     bestTrack = overlappingTrackCands[j];
-                  }
-                  else{
-                     
-                     delete overlappingTrackCands[j]; //delete this one
-                     
-                  }
+                  delete overlappingTrackCands[j]; //delete this one
                   
                }
-               streamlog_out( DEBUG2 ) << "Adding best track candidate with " << bestTrack->getHits().size() << " hits\n";
-               
-               trackCandidates.push_back( bestTrack );
                
             }
+            streamlog_out( DEBUG2 ) << "Adding best track candidate with " << bestTrack->getHits().size() << " hits\n";
             
-         }
-         else{ // we take all versions
-            
-            streamlog_out( DEBUG2 ) << "Taking all " << overlappingTrackCands.size() << " versions of the track\n";
-            trackCandidates.insert( trackCandidates.end(), overlappingTrackCands.begin(), overlappingTrackCands.end() );
+            trackCandidates.push_back( bestTrack );
             
          }
          
       }
-      
-      if( _useCED ){
-//          for( unsigned i=0; i < trackCandidates.size(); i++ ) KiTrackMarlin::drawTrackRandColor( trackCandidates[i] );
-      }
-      
-      /**********************************************************************************************/
-      /*               Get the best subset of tracks                                                */
-      /**********************************************************************************************/
-      
-      streamlog_out(DEBUG3) << "The track candidates so far: \n";
-      for( unsigned iTrack=0; iTrack < trackCandidates.size(); iTrack++ ){
+      else{ // we take all versions
          
-         streamlog_out(DEBUG3) << "track " << iTrack << ": " << trackCandidates[iTrack] << "\t" << KiTrackMarlin::getTrackHitInfo( trackCandidates[iTrack] ) << "\n";
+         streamlog_out( DEBUG2 ) << "Taking all " << overlappingTrackCands.size() << " versions of the track\n";
+         trackCandidates.insert( trackCandidates.end(), overlappingTrackCands.begin(), overlappingTrackCands.end() );
          
       }
       
-      streamlog_out( DEBUG4 ) << "\t\t---Get best subset of tracks---\n" ;
+   }
+   
+   if( _useCED ){
+//          for( unsigned i=0; i < trackCandidates.size(); i++ ) KiTrackMarlin::drawTrackRandColor( trackCandidates[i] );
+   }
+   
+   /**********************************************************************************************/
+   /*               Get the best subset of tracks                                                */
+   /**********************************************************************************************/
+   
+   streamlog_out(DEBUG3) << "The track candidates so far: \n";
+   for( unsigned iTrack=0; iTrack < trackCandidates.size(); iTrack++ ){
       
-      std::vector< ITrack* > tracks;
-      std::vector< ITrack* > rejected;
+      streamlog_out(DEBUG3) << "track " << iTrack << ": " << trackCandidates[iTrack] << "\t" << KiTrackMarlin::getTrackHitInfo( trackCandidates[iTrack] ) << "\n";
       
-      TrackCompatibilityShare1SP comp;
+   }
+   
+   streamlog_out( DEBUG4 ) << "\t\t---Get best subset of tracks---\n" ;
+   
+   std::vector< ITrack* > tracks;
+   std::vector< ITrack* > rejected;
+   
+   TrackCompatibilityShare1SP comp;
 //       TrackQIChi2Prob trackQI;
-      TrackQIChi2ProbSpecial trackQIChi2ProbSpecial;
+   TrackQIChi2ProbSpecial trackQIChi2ProbSpecial;
+   
+   
+   
+   if( _bestSubsetFinder == "SubsetHopfieldNN" ){
       
+      streamlog_out( DEBUG3 ) << "Use SubsetHopfieldNN for getting the best subset\n" ;
       
+      SubsetHopfieldNN< ITrack* > subset;
+      subset.setOmega( _HNN_Omega );
+      subset.setActivationThreshold( _HNN_ActivationThreshold );
+      subset.setTInf( _HNN_TInf );
+      subset.add( trackCandidates );
       
-      if( _bestSubsetFinder == "SubsetHopfieldNN" ){
-         
-         streamlog_out( DEBUG3 ) << "Use SubsetHopfieldNN for getting the best subset\n" ;
-         
-         SubsetHopfieldNN< ITrack* > subset;
-         subset.setOmega( _HNN_Omega );
-         subset.setActivationThreshold( _HNN_ActivationThreshold );
-         subset.setTInf( _HNN_TInf );
-         subset.add( trackCandidates );
-         
-         
-         subset.calculateBestSet( comp, trackQIChi2ProbSpecial );
-         
-         tracks = subset.getAccepted();
-         rejected = subset.getRejected();
-         
-      }
-      else if( _bestSubsetFinder == "SubsetSimple" ){
-         
-         streamlog_out( DEBUG3 ) << "Use SubsetSimple for getting the best subset\n" ;
-         
-         SubsetSimple< ITrack* > subset;
-         subset.add( trackCandidates );
-         subset.calculateBestSet( comp, trackQIChi2ProbSpecial );
-         tracks = subset.getAccepted();
-         rejected = subset.getRejected();
-         
-      }
-      else { // in any other case take all tracks
-         
-         streamlog_out( DEBUG3 ) << "Input for subset = \"" << _bestSubsetFinder << "\". All tracks are kept\n" ;
-         
-         tracks = trackCandidates;
-         
-      }
       
+      subset.calculateBestSet( comp, trackQIChi2ProbSpecial );
       
-      if( _useCED ){
-//          for( unsigned i=0; i < tracks.size(); i++ ) KiTrackMarlin::drawTrack( tracks[i] , 0x00ff00 );
-//          for( unsigned i=0; i < rejected.size(); i++ ) KiTrackMarlin::drawTrack( rejected[i] , 0xff0000 );
-      }
+      tracks = subset.getAccepted();
+      rejected = subset.getRejected();
       
+   }
+   else if( _bestSubsetFinder == "SubsetSimple" ){
       
-      for ( unsigned i=0; i<rejected.size(); i++){
-         
-         delete rejected[i];
-         
-      }
+      streamlog_out( DEBUG3 ) << "Use SubsetSimple for getting the best subset\n" ;
       
+      SubsetSimple< ITrack* > subset;
+      subset.add( trackCandidates );
+      subset.calculateBestSet( comp, trackQIChi2ProbSpecial );
+      tracks = subset.getAccepted();
+      rejected = subset.getRejected();
       
+   }
+   else { // in any other case take all tracks
       
-      /**********************************************************************************************/
-      /*               Finally: Finalise and save the tracks                                        */
-      /**********************************************************************************************/
+      streamlog_out( DEBUG3 ) << "Input for subset = \"" << _bestSubsetFinder << "\". All tracks are kept\n" ;
       
-      streamlog_out( DEBUG4 ) << "\t\t---Save Tracks---\n" ;
+      tracks = trackCandidates;
       
-      LCCollectionVec * trkCol = new LCCollectionVec(LCIO::TRACK);
+   }
+   
+   
+   if( _useCED ){
+//          for( unsigned i=0; i < tracks.size(); i++ ) KiTrackMarlin::drawTrack( tracks[i] , 0x00ff00 );
+//          for( unsigned i=0; i < rejected.size(); i++ ) KiTrackMarlin::drawTrack( rejected[i] , 0xff0000 );
+   }
+   
+   
+   for ( unsigned i=0; i<rejected.size(); i++){
+      
+      delete rejected[i];
       
-      // Set the flags
-      LCFlagImpl hitFlag(0) ;
-      hitFlag.setBit( LCIO::TRBIT_HITS ) ;
-      trkCol->setFlag( hitFlag.getFlag()  ) ;
+   }
+   
+   
+   
+   /**********************************************************************************************/
+   /*               Finally: Finalise and save the tracks                                        */
+   /**********************************************************************************************/
+   
+   streamlog_out( DEBUG4 ) << "\t\t---Save Tracks---\n" ;
+   
+   LCCollectionVec * trkCol = new LCCollectionVec(LCIO::TRACK);
+   
+   // Set the flags
+   LCFlagImpl hitFlag(0) ;
+   hitFlag.setBit( LCIO::TRBIT_HITS ) ;
+   trkCol->setFlag( hitFlag.getFlag()  ) ;
+   
+   
+   for (unsigned int i=0; i < tracks.size(); i++){
       
+      FTDTrack* myTrack = dynamic_cast< FTDTrack* >( tracks[i] );
       
-      for (unsigned int i=0; i < tracks.size(); i++){
+      if( myTrack != NULL ){
          
-         FTDTrack* myTrack = dynamic_cast< FTDTrack* >( tracks[i] );
          
-         if( myTrack != NULL ){
-            
+         TrackImpl* trackImpl = new TrackImpl( *(myTrack->getLcioTrack()) );
+         
+         try{
             
-            TrackImpl* trackImpl = new TrackImpl( *(myTrack->getLcioTrack()) );
-            
-            try{
-               
-               finaliseTrack( trackImpl );
-               trkCol->addElement( trackImpl );
-               
-            }
-            catch( FitterException e ){
-               
-               streamlog_out( DEBUG4 ) << "ForwardTracking: track couldn't be finalized due to fitter error: " << e.what() << "\n";
-               delete trackImpl;
-            }
+            finaliseTrack( trackImpl );
+            trkCol->addElement( trackImpl );
             
+         }
+         catch( FitterException e ){
             
+            streamlog_out( DEBUG4 ) << "ForwardTracking: track couldn't be finalized due to fitter error: " << e.what() << "\n";
+            delete trackImpl;
          }
          
          
       }
-     
-      // set the quality of the output collection
-      switch (_output_track_col_quality) {
-         
-         case _output_track_col_quality_FAIR:
-            trkCol->parameters().setValue( "QualityCode" , "Fair"  ) ;
-            break;
-            
-         case _output_track_col_quality_POOR:
-            trkCol->parameters().setValue( "QualityCode" , "Poor"  ) ;
-            break;
-            
-         default:
-            trkCol->parameters().setValue( "QualityCode" , "Good"  ) ;
-            break;
-      }
-
-      evt->addCollection(trkCol,_ForwardTrackCollection.c_str());
-      
-      
-      
-      streamlog_out (DEBUG5) << "Forward Tracking found and saved " << tracks.size() << " tracks in event " << _nEvt << "\n\n"; 
-      
-      
-      /**********************************************************************************************/
-      /*                Clean up                                                                    */
-      /**********************************************************************************************/
-      
-      // delete all the created IHits
-      for ( unsigned i=0; i<hitsTBD.size(); i++ )  delete hitsTBD[i];
-      
-      // delete the FTracks
-      for (unsigned int i=0; i < tracks.size(); i++){ delete tracks[i];}
-      
       
       
+   }
+  
+   // set the quality of the output collection
+   switch (_output_track_col_quality) {
       
+      case _output_track_col_quality_FAIR:
+         trkCol->parameters().setValue( "QualityCode" , "Fair"  ) ;
+         break;
+         
+      case _output_track_col_quality_POOR:
+         trkCol->parameters().setValue( "QualityCode" , "Poor"  ) ;
+         break;
+         
+      default:
+         trkCol->parameters().setValue( "QualityCode" , "Good"  ) ;
+         break;
    }
-
-
-
-
-   if( _useCED ) MarlinCED::draw(this);
-
-
-   _nEvt ++ ;
+   
+   
+   // delete the FTracks
+   for (unsigned int i=0; i < tracks.size(); i++){ delete tracks[i];}
+   
+   return trkCol;
    
 }
 
 
 
 
-
 void ForwardTracking::check( LCEvent * ) {}
 
 
@@ -996,6 +1062,9 @@ void ForwardTracking::end(){
    delete _sectorSystemFTD;
    _sectorSystemFTD = NULL;
    
+   delete _transitionSectorConnector;
+   _transitionSectorConnector = NULL;
+   
    streamlog_out( DEBUG3 ) << "There are " << _nTrackCandidates << "track candidates from CA and "<<  _nTrackCandidatesPlus
       << " track Candidates with hits from overlapping hits\n"
       << "The ratio is " << float( _nTrackCandidatesPlus )/_nTrackCandidates;
@@ -1228,68 +1297,7 @@ bool ForwardTracking::setCriteria( unsigned round ){
    _crit3Vec.clear();
    _crit4Vec.clear();
    
-   
-   
-   bool newValuesGotUsed = false; // if new values are used
-   
-   for( unsigned i=0; i<_criteriaNames.size(); i++ ){
-      
-      std::string critName = _criteriaNames[i];
-      
-      
-      float min = _critMinima[critName].back();
-      float max = _critMaxima[critName].back();
-      
-      
-      
-      // use the value corresponding to the round, if there are no new ones for this criterion, just do nothing (the previous value stays in place)
-      if( round + 1 <= _critMinima[critName].size() ){
-         
-         min =  _critMinima[critName][round];
-         newValuesGotUsed = true;
-         
-      }
-      
-      if( round + 1 <= _critMaxima[critName].size() ){
-         
-         max =  _critMaxima[critName][round];
-         newValuesGotUsed = true;
-         
-      }
-      
-      ICriterion* crit = Criteria::createCriterion( critName, min , max );
-      
-      // Some debug output about the created criterion
-      std::string type = crit->getType();
-      
-      streamlog_out( DEBUG3 ) <<  "Added: Criterion " << critName << " (type =  " << type 
-      << " ). Min = " << min
-      << ", Max = " << max
-      << ", round " << round << "\n";
-      
-      
-      // Add the new criterion to the corresponding vector
-      if( type == "2Hit" ){
-         
-         _crit2Vec.push_back( crit );
-         
-      }
-      else if( type == "3Hit" ){
-         
-         _crit3Vec.push_back( crit );
-         
-      }
-      else if( type == "4Hit" ){
-         
-         _crit4Vec.push_back( crit );
-         
-      }
-      else delete crit;
-      
-      
-   }
-   
-   return newValuesGotUsed;
+   return createRoundCriteria< IFTDHit >( round, _criteriaNames, _critMinima, _critMaxima, _maxHitTimeDifference, _crit2Vec, _crit3Vec, _crit4Vec );
    
    
 }
@@ -1369,3 +1377,166 @@ void ForwardTracking::finaliseTrack( TrackImpl* trackImpl ){
 }
 
 
+ForwardTrackingSettings ForwardTracking::getSettings() const {
+   
+   
+   ForwardTrackingSettings settings;
+   
+   settings.critMinima              = _critMinima;
+   settings.critMaxima              = _critMaxima;
+   settings.chi2ProbCut             = _chi2ProbCut;
+   settings.helixFitMax             = _helixFitMax;
+   settings.hitsPerTrackMin         = _hitsPerTrackMin;
+   settings.bestSubsetFinder        = _bestSubsetFinder;
+   settings.takeBestVersionOfTrack  = _takeBestVersionOfTrack;
+   settings.HNN_Omega               = _HNN_Omega;
+   settings.HNN_ActivationThreshold = _HNN_ActivationThreshold;
+   settings.HNN_TInf                = _HNN_TInf;
+   settings.maxConnectionsAutomaton = _maxConnectionsAutomaton;
+   
+   return settings;
+   
+   
+}
+
+
+void ForwardTracking::setSettings( const ForwardTrackingSettings& settings ){
+   
+   
+   _critMinima              = settings.critMinima;
+   _critMaxima              = settings.critMaxima;
+   _chi2ProbCut             = settings.chi2ProbCut;
+   _helixFitMax             = settings.helixFitMax;
+   _hitsPerTrackMin         = settings.hitsPerTrackMin;
+   _bestSubsetFinder        = settings.bestSubsetFinder;
+   _takeBestVersionOfTrack  = settings.takeBestVersionOfTrack;
+   _HNN_Omega               = settings.HNN_Omega;
+   _HNN_ActivationThreshold = settings.HNN_ActivationThreshold;
+   _HNN_TInf                = settings.HNN_TInf;
+   _maxConnectionsAutomaton = settings.maxConnectionsAutomaton;
+   
+   
+}
+
+
+ScanPoint ForwardTracking::parseScanPoint( const std::string& point ) const {
+   
+   
+   ScanPoint scanPoint;
+   
+   std::stringstream ss( point );
+   std::string setting;
+   
+   while( std::getline( ss, setting, ',' ) ){
+      
+      if( setting.empty() ) continue;
+      
+      size_t pos = setting.find( '=' );
+      
+      if( ( pos == std::string::npos ) || ( pos == 0 ) || ( pos + 1 == setting.size() ) ){
+         
+         throw EVENT::Exception( std::string("  Cannot read the setting \"") + setting + std::string("\" of the scan point ") + point ) ;
+         
+      }
+      
+      scanPoint.push_back( std::make_pair( setting.substr( 0, pos ), setting.substr( pos + 1 ) ) );
+      
+   }
+   
+   return scanPoint;
+   
+   
+}
+
+
+void ForwardTracking::applyScanPoint( const ScanPoint& scanPoint ){
+   
+   
+   // A wrong setting must not leave the settings half changed
+   ForwardTrackingSettings oldSettings = getSettings();
+   
+   try{
+      
+      for( unsigned i=0; i < scanPoint.size(); i++ ){
+         
+         const std::string& name = scanPoint[i].first;
+         const std::string& value = scanPoint[i].second;
+         
+         // The values of criteria, one per round, separated by ":"
+         std::vector< float > values;
+         std::stringstream ssValues( value );
+         std::string item;
+         while( std::getline( ssValues, item, ':' ) ) values.push_back( atof( item.c_str() ) );
+         
+         bool isCritMin = ( name.size() > 4 ) && ( name.compare( name.size() - 4, 4, "_min" ) == 0 );
+         bool isCritMax = ( name.size() > 4 ) && ( name.compare( name.size() - 4, 4, "_max" ) == 0 );
+         std::string critName = name.substr( 0, name.size() - 4 );
+         
+         if( isCritMin || isCritMax ){
+            
+            // only the criteria that are used have min and max, others would be ignored silently
+            if( std::find( _criteriaNames.begin(), _criteriaNames.end(), critName ) == _criteriaNames.end() ){
+               
+               throw EVENT::Exception( std::string("  The criterion ") + critName + std::string(" of a scan point is not in the parameter Criteria") ) ;
+               
+            }
+            
+            if( values.empty() ) throw EVENT::Exception( std::string("  No values for ") + name + std::string(" in a scan point") ) ;
+            
+            if( isCritMin ) _critMinima[ critName ] = values;
+            else _critMaxima[ critName ] = values;
+            
+         }
+         else if( name == "Chi2ProbCut" ){
+            
+            _chi2ProbCut = atof( value.c_str() );
+            
+            // like any probability it must range from 0 to 1
+            if( !( _chi2ProbCut >= 0. && _chi2ProbCut <= 1. ) ){
+               
+               throw EVENT::Exception( std::string("  Chi2ProbCut=") + value + std::string(" of a scan point is not between 0 and 1") ) ;
+               
+            }
+            
+         }
+         else if( name == "BestSubsetFinder" ){
+            
+            if( ( value != "None" ) && ( value != "SubsetHopfieldNN" ) && ( value != "SubsetSimple" ) ){
+               
+               throw EVENT::Exception( std::string("  BestSubsetFinder=") + value + std::string(" of a scan point is none of None, SubsetHopfieldNN and SubsetSimple") ) ;
+               
+            }
+            
+            _bestSubsetFinder = value;
+            
+         }
+         else if( name == "HelixFitMax" )               _helixFitMax = atof( value.c_str() );
+         else if( name == "HitsPerTrackMin" )           _hitsPerTrackMin = atoi( value.c_str() );
+         else if( name == "TakeBestVersionOfTrack" )    _takeBestVersionOfTrack = ( value == "true" || value == "1" );
+         else if( name == "HNN_Omega" )                 _HNN_Omega = atof( value.c_str() );
+         else if( name == "HNN_Activation_Threshold" )  _HNN_ActivationThreshold = atof( value.c_str() );
+         else if( name == "HNN_TInf" )                  _HNN_TInf = atof( value.c_str() );
+         else if( name == "MaxConnectionsAutomaton" )   _maxConnectionsAutomaton = atoi( value.c_str() );
+         else throw EVENT::Exception( std::string("  The parameter ") + name + std::string(" can't be changed in a scan point") ) ;
+         
+      }
+      
+   }
+   catch( ... ){
+      
+      setSettings( oldSettings );
+      throw;
+      
+   }
+   
+   
+}
+
+
+std::string ForwardTracking::getScanCollectionName( unsigned iPoint ) const {
+   
+   std::stringstream ss;
+   ss << _ForwardTrackCollection << "_scan" << iPoint;
+   return ss.str();
+   
+}
@@ -0,0 +1,284 @@
+#include "ParallelSegmentBuilder.h"
+
+#include <set>
+#include <utility>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+
+#include "KiTrack/Segment.h"
+
+#include "marlin/VerbosityLevels.h"
+
+
+using namespace KiTrackMarlin;
+
+
+
+ParallelSegmentBuilder::ParallelSegmentBuilder( const std::map< int , std::vector< IHit* > >& map_sector_hits, unsigned nThreads ):
+_map_sector_hits( map_sector_hits ),
+_nThreads( nThreads > 0 ? nThreads : 1 ),
+_cancelled( NULL ),
+_nConnections( 0 ){
+   
+   
+}
+
+
+bool ParallelSegmentBuilder::get1SegAutomaton( Automaton& automaton, unsigned maxConnections ){
+   
+   
+   std::vector< Segment* > segments;
+   std::vector< std::pair< unsigned, unsigned > > connections;
+   
+   if( !buildSegments( maxConnections, segments, connections ) ) return false;
+   
+   for( unsigned k=0; k < connections.size(); k++ ){
+      
+      segments[ connections[k].first ]->addChild( segments[ connections[k].second ] );
+      segments[ connections[k].second ]->addParent( segments[ connections[k].first ] );
+      
+   }
+   
+   for( unsigned i=0; i < segments.size(); i++ ) automaton.addSegment( segments[i] );
+   
+   return true;
+   
+   
+}
+
+
+bool ParallelSegmentBuilder::get1SegAutomaton( FlatAutomaton& automaton, unsigned maxConnections ){
+   
+   
+   std::vector< Segment* > segments;
+   std::vector< std::pair< unsigned, unsigned > > connections;
+   
+   if( !buildSegments( maxConnections, segments, connections ) ) return false;
+   
+   std::vector< IHit* > hits( segments.size() );
+   std::vector< unsigned > layers( segments.size() );
+   
+   // the segments were only needed for the criteria
+   for( unsigned i=0; i < segments.size(); i++ ){
+      
+      hits[i] = segments[i]->getHits()[0];
+      layers[i] = segments[i]->getLayer();
+      
+      delete segments[i];
+      
+   }
+   
+   automaton.set1Segments( hits, layers, connections );
+   
+   return true;
+   
+   
+}
+
+
+bool ParallelSegmentBuilder::buildSegments( unsigned maxConnections, std::vector< Segment* >& segments,
+                                            std::vector< std::pair< unsigned, unsigned > >& connections ){
+   
+   
+   _nConnections = 0;
+   
+   
+   /**********************************************************************************************/
+   /*                Create the 1-segments                                                       */
+   /**********************************************************************************************/
+   
+   // the sectors with hits in the order of the map
+   std::vector< int > sectors;
+   std::vector< const std::vector< IHit* >* > sectorHits;
+   std::map< int , unsigned > sectorIndex;
+   
+   std::map< int , std::vector< IHit* > >::const_iterator itSecHit;
+   for( itSecHit = _map_sector_hits.begin(); itSecHit != _map_sector_hits.end(); itSecHit++ ){
+      
+      if( itSecHit->second.empty() ) continue;
+      
+      sectorIndex[ itSecHit->first ] = sectorHits.size();
+      sectors.push_back( itSecHit->first );
+      sectorHits.push_back( &itSecHit->second );
+      
+   }
+   
+   // the index of the segment of every hit in segments, the segments are in the order they were created
+   const unsigned NO_SEGMENT = unsigned( -1 );
+   std::vector< std::vector< unsigned > > sectorSegments( sectorHits.size() );
+   std::vector< std::vector< unsigned > > targetSectors( sectorHits.size() );
+   
+   for( unsigned s=0; s < sectorHits.size(); s++ ) sectorSegments[s].resize( sectorHits[s]->size(), NO_SEGMENT );
+   
+   auto createSegment = [&]( unsigned s, unsigned i ){
+      
+      if( sectorSegments[s][i] != NO_SEGMENT ) return;
+      
+      IHit* hit = (*sectorHits[s])[i];
+      
+      std::vector< IHit* > hitVec;
+      hitVec.push_back( hit );
+      
+      Segment* segment = new Segment( hitVec );
+      segment->setLayer( hit->getLayer() );
+      
+      sectorSegments[s][i] = segments.size();
+      segments.push_back( segment );
+      
+   };
+   
+   // A hit gets its segment when it is met first, as parent or as child, just like in the SegmentBuilder.
+   // So the segments are in the same order in the automaton.
+   for( unsigned s=0; s < sectorHits.size(); s++ ){
+      
+      
+      std::set< int > targets;
+      
+      for( unsigned i=0; i < _sectorConnectors.size(); i++ ){
+         
+         std::set< int > newTargets = _sectorConnectors[i]->getTargetSectors( sectors[s] );
+         targets.insert( newTargets.begin(), newTargets.end() );
+         
+      }
+      
+      for( std::set< int >::iterator itTarget = targets.begin(); itTarget != targets.end(); itTarget++ ){
+         
+         std::map< int , unsigned >::iterator itIndex = sectorIndex.find( *itTarget );
+         if( itIndex != sectorIndex.end() ) targetSectors[s].push_back( itIndex->second );
+         
+      }
+      
+      for( unsigned i=0; i < sectorHits[s]->size(); i++ ){
+         
+         createSegment( s, i );
+         
+         if( i > 0 ) continue;
+         
+         for( unsigned t=0; t < targetSectors[s].size(); t++ ){
+            
+            for( unsigned j=0; j < sectorHits[ targetSectors[s][t] ]->size(); j++ ) createSegment( targetSectors[s][t], j );
+            
+         }
+         
+      }
+      
+      
+   }
+   
+   
+   /**********************************************************************************************/
+   /*                Find the connections                                                        */
+   /**********************************************************************************************/
+   
+   // the connections ( parent, child ) found for the hits of every sector as parents
+   std::vector< std::vector< std::pair< unsigned, unsigned > > > sectorConnections( sectorHits.size() );
+   
+   std::atomic< unsigned > nextSector( 0 );
+   std::atomic< unsigned > nConnections( 0 );
+   std::atomic< bool > aborted( false );
+   
+   std::mutex exceptionMutex;
+   std::exception_ptr exception;
+   
+   auto work = [&](){
+      
+      try{
+         
+         for( unsigned s = nextSector++; s < sectorHits.size() && !aborted; s = nextSector++ ){
+            
+            std::vector< std::pair< unsigned, unsigned > >& found = sectorConnections[s];
+            
+            for( unsigned i=0; i < sectorHits[s]->size() && !aborted; i++ ){
+               
+               unsigned parent = sectorSegments[s][i];
+               unsigned nBefore = found.size();
+               
+               for( unsigned t=0; t < targetSectors[s].size(); t++ ){
+                  
+                  const std::vector< unsigned >& targetSegments = sectorSegments[ targetSectors[s][t] ];
+                  
+                  for( unsigned j=0; j < targetSegments.size(); j++ ){
+                     
+                     unsigned child = targetSegments[j];
+                     
+                     bool allCriteriaOK = true;
+                     
+                     for( unsigned iCrit=0; iCrit < _criteria.size(); iCrit++ ){
+                        
+                        if( !_criteria[iCrit]->areCompatible( segments[ parent ], segments[ child ] ) ){
+                           
+                           allCriteriaOK = false;
+                           break;
+                           
+                        }
+                        
+                     }
+                     
+                     if( allCriteriaOK ) found.push_back( std::make_pair( parent, child ) );
+                     
+                  }
+                  
+               }
+               
+               // count after every parent hit, so the other threads learn early if there are too many
+               unsigned nNew = found.size() - nBefore;
+               if( nNew > 0 && ( nConnections += nNew ) > maxConnections ) aborted = true;
+               
+               if( _cancelled != NULL && *_cancelled ) aborted = true;
+               
+            }
+            
+         }
+         
+      }
+      catch( ... ){
+         
+         std::lock_guard< std::mutex > lock( exceptionMutex );
+         if( !exception ) exception = std::current_exception();
+         aborted = true;
+         
+      }
+      
+   };
+   
+   std::vector< std::thread > threads;
+   for( unsigned t=1; t < _nThreads; t++ ) threads.push_back( std::thread( work ) );
+   
+   work();
+   
+   for( unsigned t=0; t < threads.size(); t++ ) threads[t].join();
+   
+   _nConnections = nConnections;
+   
+   if( aborted ){
+      
+      for( unsigned i=0; i < segments.size(); i++ ) delete segments[i];
+      segments.clear();
+      
+      if( exception ) std::rethrow_exception( exception );
+      
+      if( _cancelled == NULL ) streamlog_out( DEBUG3 ) << "ParallelSegmentBuilder: aborted after " << _nConnections << " connections (maximum " << maxConnections << ")\n";
+      
+      return false;
+      
+   }
+   
+   
+   /**********************************************************************************************/
+   /*                Merge the connections                                                       */
+   /**********************************************************************************************/
+   
+   connections.clear();
+   connections.reserve( _nConnections );
+   
+   for( unsigned s=0; s < sectorConnections.size(); s++ ) connections.insert( connections.end(), sectorConnections[s].begin(), sectorConnections[s].end() );
+   
+   if( _cancelled == NULL ) streamlog_out( DEBUG3 ) << "ParallelSegmentBuilder: " << segments.size() << " segments with " << _nConnections << " connections\n";
+   
+   return true;
+   
+   
+}
+
@@ -23,8 +23,6 @@
 //----From KiTrack-----------------------------
 #include "KiTrack/SubsetHopfieldNN.h"
 #include "KiTrack/SubsetSimple.h"
-#include "KiTrack/SegmentBuilder.h"
-#include "KiTrack/Automaton.h"
 
 //----From KiTrackMarlin-----------------------
 #include "ILDImpl/FTDTrack.h"
@@ -80,6 +78,21 @@ SiliconEndcapTracking::SiliconEndcapTracking() : Processor("SiliconEndcapTrackin
 			      //int(80));
 			      int(180));
 
+   registerProcessorParameter("LayerZPositions",
+			      "The absolute z positions (mm) of all layers, starting with 0 for the IP. If set, the sector windows are calculated from them, otherwise fixed windows are used",
+			      _layerZPositions,
+			      std::vector< float >() );
+
+   registerProcessorParameter("ConnectorPtMin",
+			      "The minimum pt (GeV) of tracks that must still be connected by the calculated sector windows",
+			      _connectorPtMin,
+			      double(0.1));
+
+   registerProcessorParameter("ConnectorToleranceBins",
+			      "The number of bins added on every side of the calculated sector windows",
+			      _connectorToleranceBins,
+			      int(1));
+
    ////////////////////////
 
 
@@ -171,6 +184,36 @@ SiliconEndcapTracking::SiliconEndcapTracking() : Processor("SiliconEndcapTrackin
                               _maxHitsPerSector,
                               int(1000));
    
+   registerProcessorParameter("HitTimeWindow",
+                              "Only hits with a time (TrackerHit::getTime()) in this window [min max] (in ns) are used. Empty: use all hits",
+                              _hitTimeWindow,
+                              std::vector< float >() );
+   
+   registerProcessorParameter("MaxHitTimeDifference",
+                              "Two hits are only connected if their times differ by at most this (in ns, criterion Crit2_DeltaTime). Negative: no time criterion",
+                              _maxHitTimeDifference,
+                              float(-1.) );
+   
+   registerProcessorParameter("SegmentBuilderThreads",
+                              "The number of threads connecting the hits to 1-segments (and lengthening the segments of the FlatAutomaton)",
+                              _segmentBuilderThreads,
+                              int(1) );
+   
+   registerProcessorParameter("UseFlatAutomaton",
+                              "Whether to run the Cellular Automaton with the FlatAutomaton (segments in flat arrays) instead of the Automaton of KiTrack",
+                              _useFlatAutomaton,
+                              bool(false) );
+   
+   registerProcessorParameter("SpeculativeRounds",
+                              "In events with more than SpeculativeRoundsMinHits hits, run the rounds with the different criteria at the same time in up to this many threads. 0 = the rounds are always run one after the other",
+                              _speculativeRounds,
+                              int(0) );
+   
+   registerProcessorParameter("SpeculativeRoundsMinHits",
+                              "The number of hits above which the rounds are run at the same time, see SpeculativeRounds",
+                              _speculativeRoundsMinHits,
+                              int(10000) );
+   
    
    //For fitting:
    
@@ -257,8 +300,14 @@ void SiliconEndcapTracking::init() {
                     // can be printed. As this is mainly used for debugging it is not a steerable parameter.
    if( _useCED )MarlinCED::init(this) ;    //CED
    
+   if( !_hitTimeWindow.empty() && _hitTimeWindow.size() != 2 ){
+      
+      throw EVENT::Exception( "  HitTimeWindow needs two values: the minimum and the maximum time" ) ;
+      
+   }
    
 
+
    /**********************************************************************************************/
    /*       Make a SectorSystemEndcap                                                             */
    /**********************************************************************************************/
@@ -293,6 +342,42 @@ void SiliconEndcapTracking::init() {
    streamlog_out( DEBUG2 ) << " Bz = " << _Bz << " \n";
 
 
+   /**********************************************************************************************/
+   /*       Make the sector connector                                                            */
+   /**********************************************************************************************/
+
+   unsigned layerStepMax = 1; // how many layers to go at max
+   //unsigned layerStepMax = 2; // how many layers to go at max
+   //unsigned lastLayerToIP = 9;// layer 1,2,3 and 4 get connected directly to the IP
+   unsigned lastLayerToIP = 4;// layer 1,2,3 and 4 get connected directly to the IP
+
+   if( _layerZPositions.empty() ){
+
+      streamlog_out( MESSAGE ) << "No LayerZPositions set, the sector connector uses fixed windows\n";
+      _sectorConnector = new EndcapSectorConnector( _sectorSystemEndcap , layerStepMax, lastLayerToIP ) ;
+
+   }
+   else{
+
+      if( int( _layerZPositions.size() ) != nLayers ){
+
+         streamlog_out( WARNING ) << "LayerZPositions has " << _layerZPositions.size() << " entries, but there are " << nLayers
+                                  << " layers. Layers without a z position use fixed windows\n";
+
+      }
+
+      std::vector< double > layerZ( _layerZPositions.begin(), _layerZPositions.end() );
+      _sectorConnector = new EndcapSectorConnector( _sectorSystemEndcap , layerStepMax, lastLayerToIP,
+                                                    layerZ, _connectorPtMin, _Bz, unsigned( std::max( _connectorToleranceBins, 0 ) ) ) ;
+
+   }
+
+   streamlog_out( DEBUG4 ) << "Sector connector windows:\n" << _sectorConnector->getInfoOnWindows();
+
+   _sectorOccupancy = new EndcapSectorOccupancy( _sectorSystemEndcap );
+   _sectorConnector->setOccupancy( _sectorOccupancy );
+
+
 
    /**********************************************************************************************/
    /*       Initialise the MarlinTrkSystem, needed by the tracks for fitting                     */
@@ -398,6 +483,7 @@ void SiliconEndcapTracking::processEvent( LCEvent * evt ) {
 
    std::vector< IHit* > hitsTBD; //Hits to be deleted at the end
    _map_sector_hits.clear();
+   _sectorOccupancy->clear();
 
    
    /**********************************************************************************************/
@@ -443,6 +529,13 @@ void SiliconEndcapTracking::processEvent( LCEvent * evt ) {
             continue;
             
          }       
+         
+         if( !_hitTimeWindow.empty() && ( trackerHit->getTime() < _hitTimeWindow[0] || trackerHit->getTime() > _hitTimeWindow[1] ) ){
+            
+            streamlog_out( DEBUG1 ) << "hit" << i << " with time " << trackerHit->getTime() << " is outside the HitTimeWindow, skipping it\n";
+            continue;
+            
+         }
 
 	 //Make a EndcapHit01 from the TrackerHit
 	 EndcapHit01* endcapHit = new EndcapHit01 ( trackerHit , _sectorSystemEndcap );
@@ -512,6 +605,13 @@ void SiliconEndcapTracking::processEvent( LCEvent * evt ) {
       _map_sector_hits[ virtualIPHitForward->getSector() ].push_back( virtualIPHitForward );
  
       
+      // Mark the sectors with hits, so the sector connector only hands out those as targets
+      for( it=_map_sector_hits.begin(); it != _map_sector_hits.end(); it++ ){
+         
+         if( !it->second.empty() ) _sectorOccupancy->setOccupied( it->first );
+         
+      }
+      
      
       
       /**********************************************************************************************/
@@ -521,6 +621,29 @@ void SiliconEndcapTracking::processEvent( LCEvent * evt ) {
       unsigned round = 0; // the round we are in
       std::vector < RawTrack > rawTracks;
       
+      // In very busy events, several rounds are run at the same time, so the time needed is not the sum of all rounds
+      unsigned nHits = 0;
+      for( it=_map_sector_hits.begin(); it != _map_sector_hits.end(); it++ ) nHits += it->second.size();
+      
+      bool speculative = ( _speculativeRounds > 1 ) && ( int( nHits ) > _speculativeRoundsMinHits );
+      
+      // A round: the 1-segments from the hits in _map_sector_hits and the Cellular Automaton on them
+      AutomatonRound automatonRound( _map_sector_hits, unsigned( _maxConnectionsAutomaton ), _useFlatAutomaton );
+      automatonRound.setDrawSegments( _useCED );
+      
+      if( speculative ){
+         
+         // the criteria of every round, made like setCriteria() does
+         auto createCriteria = [this]( unsigned r, std::vector< ICriterion* >& crit2Vec, std::vector< ICriterion* >& crit3Vec, std::vector< ICriterion* >& crit4Vec ){
+            
+            return createRoundCriteria< IEndcapHit >( r, _criteriaNames, _critMinima, _critMaxima, _maxHitTimeDifference, crit2Vec, crit3Vec, crit4Vec );
+            
+         };
+         
+         runRoundsSpeculatively( automatonRound, _sectorConnector, unsigned( _speculativeRounds ), createCriteria, rawTracks );
+         
+      }
+      
       // The following while loop ideally only runs once. (So we do round 0 and everything works)
       // It will repeat as long as the Automaton creates too many connections and as long as there are new criteria
       // parameters to use to cut down the problem.
@@ -528,161 +651,12 @@ void SiliconEndcapTracking::processEvent( LCEvent * evt ) {
       // so the loop will be left. If however there are too many connections we stay in the loop and use 
       // (hopefully) tighter cut offs (if provided in the steering). This should prevent combinatorial breakdown
       // for very evil events.
-      while( setCriteria( round ) ){
+      while( !speculative && setCriteria( round ) ){
          
          
          round++; // count up the round we are in
          
-         
-         /**********************************************************************************************/
-         /*                Build the segments                                                          */
-         /**********************************************************************************************/
-         
-         streamlog_out( DEBUG4 ) << "\t\t---SegementBuilder---\n" ;
-         
-         //Create a segmentbuilder
-         SegmentBuilder segBuilder( _map_sector_hits );
-         
-         segBuilder.addCriteria ( _crit2Vec ); // Add the criteria on when to connect two hits. The vector has been filled by the method setCriteria
-         
-         //Also load hit connectors
-         unsigned layerStepMax = 1; // how many layers to go at max
-         //unsigned layerStepMax = 2; // how many layers to go at max
-         //unsigned lastLayerToIP = 9;// layer 1,2,3 and 4 get connected directly to the IP
-         unsigned lastLayerToIP = 4;// layer 1,2,3 and 4 get connected directly to the IP
-         EndcapSectorConnector secCon( _sectorSystemEndcap , layerStepMax, lastLayerToIP ) ;
-         
-         segBuilder.addSectorConnector ( & secCon ); // Add the sector connector (so the SegmentBuilder knows what hits from different sectors it is allowed to look for connections)
-         
-         
-         // And get out the Cellular Automaton with the 1-segments 
-         Automaton automaton = segBuilder.get1SegAutomaton();
-         
-         // Check if there are not too many connections
-         if( automaton.getNumberOfConnections() > unsigned( _maxConnectionsAutomaton ) ){
-            
-            streamlog_out( DEBUG4 ) << "Redo the Automaton with different parameters, because there are too many connections:\n"
-            << "\tconnections( " << automaton.getNumberOfConnections() << " ) > MaxConnectionsAutomaton( " << _maxConnectionsAutomaton << " )\n";
-            continue;
-            
-         }
-         
-         
-         
-         /**********************************************************************************************/
-         /*                Automaton                                                                   */
-         /**********************************************************************************************/
-         
-         
-         
-         streamlog_out( DEBUG4 ) << "\t\t---Automaton---\n" ;
-         
-         if( _useCED ) KiTrackMarlin::drawAutomatonSegments( automaton ); // draws the 1-segments (i.e. hits)
-         
-         
-         /*******************************/
-         /*      2-hit segments         */
-         /*******************************/
-         
-         streamlog_out( DEBUG4 ) << "\t\t--2-hit-Segments--\n" ;
-         
-         streamlog_out(DEBUG4) << "Automaton has " << automaton.getTracks( 3 ).size() << " track candidates\n"; //should be commented out, because it takes time
-         
-         automaton.clearCriteria();
-         automaton.addCriteria( _crit3Vec );  // Add the criteria for 3 hits (i.e. 2 2-hit segments )
-         
-         
-         // Let the automaton lengthen its 1-hit-segments to 2-hit-segments
-         automaton.lengthenSegments();
-        
-	 
-	 // std::vector<const KiTrack::Segment* > vec_seg_2hits = automaton.getSegments();
-	 // for(size_t is=0; is<vec_seg_2hits.size(); is++){
-	 //   streamlog_out( DEBUG2 ) << "-- segment " << is << " has nhits " << vec_seg_2hits.at(is)->getHits().size() << std::endl ;  
-	 //   KiTrack::Segment* test_segment = const_cast<KiTrack::Segment* >(vec_seg_2hits.at(is));
-	 //   streamlog_out( DEBUG2 ) << "-- segment " << is << " has nchildren " << test_segment->getChildren().size() << std::endl ;  
-	 // }
-
-         
-         // So now we have 2-hit-segments and are ready to perform the Cellular Automaton.
-         
-         // Perform the automaton
-         automaton.doAutomaton();
-         
-         
-         // Clean segments with bad states
-         automaton.cleanBadStates();
-         
-        
-         // Reset the states of all segments
-         automaton.resetStates();
-        
-         streamlog_out(DEBUG4) << "Automaton has " << automaton.getTracks( 3 ).size() << " track candidates\n"; //should be commented out, because it takes time
-         
-         
-         // Check if there are not too many connections
-         if( automaton.getNumberOfConnections() > unsigned( _maxConnectionsAutomaton ) ){
-            
-            streamlog_out( DEBUG4 ) << "Redo the Automaton with different parameters, because there are too many connections:\n"
-            << "\tconnections( " << automaton.getNumberOfConnections() << " ) > MaxConnectionsAutomaton( " << _maxConnectionsAutomaton << " )\n";
-            continue;
-            
-         }
-         
-         /*******************************/
-         /*      3-hit segments         */
-         /*******************************/
-         streamlog_out( DEBUG4 ) << "\t\t--3-hit-Segments--\n" ;
-         
-         
-         automaton.clearCriteria();
-         automaton.addCriteria( _crit4Vec );      
-         
-         
-         // Lengthen the 2-hit-segments to 3-hits-segments
-         automaton.lengthenSegments();
- 
-	 
-	 // std::vector<const KiTrack::Segment* > vec_seg_3hits = automaton.getSegments();
-	 // for(size_t is=0; is<vec_seg_3hits.size(); is++){
-	 //   streamlog_out( DEBUG2 ) << "-- segment " << is << " has nhits " << vec_seg_3hits.at(is)->getHits().size() << std::endl ;  
-	 //   KiTrack::Segment* test_segment_3 = const_cast<KiTrack::Segment* >(vec_seg_3hits.at(is));
-	 //   streamlog_out( DEBUG2 ) << "-- segment " << is << " has nchildren " << test_segment_3->getChildren().size() << std::endl ;  
-	 //   std::string info_seg = test_segment_3->getInfo();
-	 //   streamlog_out( DEBUG2 ) << "-- info segment = " << info_seg.c_str() << std::endl ; 
-	 // }
-	 // //std::vector < std::vector< IHit* > > test_tracks_segment = getTracksOfSegment();
-        
-         
-         // Perform the Cellular Automaton
-         automaton.doAutomaton();
-         
-         //Clean segments with bad states
-         automaton.cleanBadStates();
-         
-         
-         //Reset the states of all segments
-         automaton.resetStates();
-         
-
-
-      
-         streamlog_out(DEBUG4) << "Automaton has " << automaton.getTracks( 3 ).size() << " track candidates\n"; //should be commented out, because it takes time
-         
-         
-         // Check if there are not too many connections
-         if( automaton.getNumberOfConnections() > unsigned( _maxConnectionsAutomaton ) ){
-            
-            streamlog_out( DEBUG4 ) << "Redo the Automaton with different parameters, because there are too many connections:\n"
-            << "\tconnections( " << automaton.getNumberOfConnections() << " ) > MaxConnectionsAutomaton( " << _maxConnectionsAutomaton << " )\n";
-            continue;
-            
-         }
-         
-         // get the raw tracks (raw track = just a vector of hits, the most rudimentary form of a track)
-         rawTracks = automaton.getTracks( 3 );
-         
-         break; // if we reached this place all went well and we don't need another round --> exit the loop
+         if( automatonRound.run( _crit2Vec, _crit3Vec, _crit4Vec, _sectorConnector, _segmentBuilderThreads, NULL, rawTracks ) ) break; // all went well and we don't need another round --> exit the loop
          
       }
       
@@ -1074,6 +1048,12 @@ void SiliconEndcapTracking::end(){
    _crit3Vec.clear();
    _crit4Vec.clear();
    
+   delete _sectorConnector;
+   _sectorConnector = NULL;
+
+   delete _sectorOccupancy;
+   _sectorOccupancy = NULL;
+
    delete _sectorSystemEndcap;
    _sectorSystemEndcap = NULL;
 
@@ -1371,68 +1351,7 @@ bool SiliconEndcapTracking::setCriteria( unsigned round ){
    _crit3Vec.clear();
    _crit4Vec.clear();
    
-   
-   
-   bool newValuesGotUsed = false; // if new values are used
-   
-   for( unsigned i=0; i<_criteriaNames.size(); i++ ){
-      
-      std::string critName = _criteriaNames[i];
-      
-      
-      float min = _critMinima[critName].back();
-      float max = _critMaxima[critName].back();
-      
-      
-      
-      // use the value corresponding to the round, if there are no new ones for this criterion, just do nothing (the previous value stays in place)
-      if( round + 1 <= _critMinima[critName].size() ){
-         
-         min =  _critMinima[critName][round];
-         newValuesGotUsed = true;
-         
-      }
-      
-      if( round + 1 <= _critMaxima[critName].size() ){
-         
-         max =  _critMaxima[critName][round];
-         newValuesGotUsed = true;
-         
-      }
-      
-      ICriterion* crit = Criteria::createCriterion( critName, min , max );
-      
-      // Some debug output about the created criterion
-      std::string type = crit->getType();
-      
-      streamlog_out( DEBUG3 ) <<  "Added: Criterion " << critName << " (type =  " << type 
-      << " ). Min = " << min
-      << ", Max = " << max
-      << ", round " << round << "\n";
-      
-      
-      // Add the new criterion to the corresponding vector
-      if( type == "2Hit" ){
-         
-         _crit2Vec.push_back( crit );
-         
-      }
-      else if( type == "3Hit" ){
-         
-         _crit3Vec.push_back( crit );
-         
-      }
-      else if( type == "4Hit" ){
-         
-         _crit4Vec.push_back( crit );
-         
-      }
-      else delete crit;
-      
-      
-   }
-   
-   return newValuesGotUsed;
+   return createRoundCriteria< IEndcapHit >( round, _criteriaNames, _critMinima, _critMaxima, _maxHitTimeDifference, _crit2Vec, _crit3Vec, _crit4Vec );
    
    
 }
@@ -0,0 +1,83 @@
+#include "SpeculativeRounds.h"
+
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <exception>
+
+
+using namespace KiTrackMarlin;
+
+
+SpeculativeRounds::SpeculativeRounds( unsigned nThreads ):
+_nThreads( std::max( nThreads, 1u ) ),
+_nThreadsUsed( 0 ),
+_winner( 0 ){
+   
+   
+}
+
+
+bool SpeculativeRounds::run( unsigned nRounds, const Round& round, std::vector< std::vector< IHit* > >& rawTracks ){
+   
+   
+   std::vector< std::vector< std::vector< IHit* > > > roundTracks( nRounds );
+   std::vector< std::atomic< bool > > cancelled( nRounds );
+   for( unsigned r=0; r < nRounds; r++ ) cancelled[r] = false;
+   
+   std::atomic< unsigned > nextRound( 0 );
+   
+   std::mutex winnerMutex;
+   unsigned winner = nRounds;
+   
+   std::exception_ptr exception;
+   
+   auto work = [&](){
+      
+      try{
+         
+         for( unsigned r = nextRound++; r < nRounds; r = nextRound++ ){
+            
+            if( cancelled[r] ) continue;
+            
+            if( !round( r, &cancelled[r], roundTracks[r] ) ) continue;
+            
+            std::lock_guard< std::mutex > lock( winnerMutex );
+            
+            if( r < winner ) winner = r;
+            for( unsigned r2 = r+1; r2 < nRounds; r2++ ) cancelled[r2] = true;
+            
+         }
+         
+      }
+      catch( ... ){
+         
+         std::lock_guard< std::mutex > lock( winnerMutex );
+         if( !exception ) exception = std::current_exception();
+         for( unsigned r=0; r < nRounds; r++ ) cancelled[r] = true;
+         
+      }
+      
+   };
+   
+   _nThreadsUsed = std::min( _nThreads, nRounds );
+   
+   std::vector< std::thread > threads;
+   for( unsigned t=1; t < _nThreadsUsed; t++ ) threads.push_back( std::thread( work ) );
+   
+   work();
+   
+   for( unsigned t=0; t < threads.size(); t++ ) threads[t].join();
+   
+   if( exception ) std::rethrow_exception( exception );
+   
+   _winner = winner;
+   
+   if( winner == nRounds ) return false;
+   
+   rawTracks.swap( roundTracks[ winner ] );
+   
+   return true;
+   
+   
+}
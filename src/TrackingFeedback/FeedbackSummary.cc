@@ -0,0 +1,320 @@
+#include "FeedbackSummary.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+
+namespace{
+   
+   const char MAGIC[8] = { 'F', 'T', 'F', 'B', 'S', 'U', 'M', '1' };
+   
+   
+   template< class T >
+   void writeValue( std::ostream& os, const T& value ){ os.write( reinterpret_cast< const char* >( &value ), sizeof( T ) ); }
+   
+   template< class T >
+   void readValue( std::istream& is, T& value ){ is.read( reinterpret_cast< char* >( &value ), sizeof( T ) ); }
+   
+   
+   void writeString( std::ostream& os, const std::string& s ){
+      
+      writeValue( os, uint32_t( s.size() ) );
+      os.write( s.data(), s.size() );
+      
+   }
+   
+   std::string readString( std::istream& is ){
+      
+      uint32_t size = 0;
+      readValue( is, size );
+      if( !is || size > 1024 ) throw std::runtime_error( "FeedbackSummary: corrupt string" );
+      
+      std::string s( size, ' ' );
+      is.read( &s[0], size );
+      return s;
+      
+   }
+   
+   template< class T >
+   void writeVector( std::ostream& os, const std::vector< T >& v ){
+      
+      writeValue( os, uint32_t( v.size() ) );
+      if( !v.empty() ) os.write( reinterpret_cast< const char* >( &v[0] ), v.size()*sizeof( T ) );
+      
+   }
+   
+   template< class T >
+   void readVector( std::istream& is, std::vector< T >& v ){
+      
+      uint32_t size = 0;
+      readValue( is, size );
+      if( !is || size > ( 1u << 24 ) ) throw std::runtime_error( "FeedbackSummary: corrupt vector" );
+      
+      v.resize( size );
+      if( size > 0 ) is.read( reinterpret_cast< char* >( &v[0] ), size*sizeof( T ) );
+      
+   }
+   
+   template< class T >
+   void writeJSONArray( std::ostream& os, const std::vector< T >& v ){
+      
+      os << "[";
+      for( unsigned i=0; i < v.size(); i++ ) os << ( i > 0 ? ", " : "" ) << v[i];
+      os << "]";
+      
+   }
+   
+}
+
+
+
+std::vector< double > EfficiencyHistogram::linearEdges( unsigned n, double min, double max ){
+   
+   std::vector< double > edges;
+   for( unsigned i=0; i <= n; i++ ) edges.push_back( min + ( max - min )*i/n );
+   return edges;
+   
+}
+
+
+std::vector< double > EfficiencyHistogram::logEdges( unsigned n, double min, double max ){
+   
+   std::vector< double > edges;
+   for( unsigned i=0; i <= n; i++ ) edges.push_back( min * pow( max/min, double(i)/n ) );
+   return edges;
+   
+}
+
+
+void EfficiencyHistogram::fill( double x, bool passed ){
+   
+   
+   // the index of the first edge above x is the bin (0 = underflow)
+   unsigned bin = std::upper_bound( _edges.begin(), _edges.end(), x ) - _edges.begin();
+   
+   _denominator[ bin ]++;
+   if( passed ) _numerator[ bin ]++;
+   
+}
+
+
+void EfficiencyHistogram::add( const EfficiencyHistogram& other ){
+   
+   
+   if( ( other._name != _name ) || ( other._edges != _edges ) ) 
+      throw std::runtime_error( "EfficiencyHistogram: can't add " + other._name + " to " + _name + ", the bins differ" );
+   
+   for( unsigned i=0; i < _numerator.size(); i++ ){
+      
+      _numerator[i]   += other._numerator[i];
+      _denominator[i] += other._denominator[i];
+      
+   }
+   
+}
+
+
+
+const std::vector< std::string >& FeedbackSummary::getCounterNames(){
+   
+   
+   static const char* names[] = { "nEvents", "nComplete", "nCompletePlus", "nLost", "nIncomplete", "nIncompletePlus", "nGhost", 
+                                  "nFoundCompletely", "nRecoTracks", "nValidTrueTracks", "nDismissedTrueTracks", "nClones" };
+   
+   static const std::vector< std::string > counterNames( names, names + sizeof( names )/sizeof( names[0] ) );
+   
+   return counterNames;
+   
+}
+
+
+FeedbackSummary::FeedbackSummary(): _counters( getCounterNames().size(), 0 ){}
+
+
+unsigned FeedbackSummary::getCounterIndex( const std::string& name ) const{
+   
+   const std::vector< std::string >& names = getCounterNames();
+   
+   for( unsigned i=0; i < names.size(); i++ ) if( names[i] == name ) return i;
+   
+   throw std::runtime_error( "FeedbackSummary: unknown counter " + name );
+   
+}
+
+
+uint64_t& FeedbackSummary::counter( const std::string& name ){ return _counters[ getCounterIndex( name ) ]; }
+
+uint64_t FeedbackSummary::getCounter( const std::string& name ) const { return _counters[ getCounterIndex( name ) ]; }
+
+
+EfficiencyHistogram& FeedbackSummary::histogram( const std::string& name ){
+   
+   for( unsigned i=0; i < _histograms.size(); i++ ) if( _histograms[i].getName() == name ) return _histograms[i];
+   
+   throw std::runtime_error( "FeedbackSummary: unknown histogram " + name );
+   
+}
+
+
+void FeedbackSummary::add( const FeedbackSummary& other ){
+   
+   
+   for( unsigned i=0; i < _counters.size(); i++ ) _counters[i] += other._counters[i];
+   
+   if( _histograms.empty() ){
+      
+      _histograms = other._histograms;
+      return;
+      
+   }
+   
+   if( _histograms.size() != other._histograms.size() ) throw std::runtime_error( "FeedbackSummary: the summaries have different histograms" );
+   
+   for( unsigned i=0; i < _histograms.size(); i++ ) _histograms[i].add( other._histograms[i] );
+   
+}
+
+
+double FeedbackSummary::getEfficiency() const{
+   
+   double nValid = getCounter( "nValidTrueTracks" );
+   if( nValid <= 0. ) return -1.;
+   
+   return ( nValid - getCounter( "nLost" ) ) / nValid;
+   
+}
+
+
+double FeedbackSummary::getGhostRate() const{
+   
+   double nReco = getCounter( "nRecoTracks" );
+   if( nReco <= 0. ) return -1.;
+   
+   return getCounter( "nGhost" ) / nReco;
+   
+}
+
+
+double FeedbackSummary::getCloneRate() const{
+   
+   double nReco = getCounter( "nRecoTracks" );
+   if( nReco <= 0. ) return -1.;
+   
+   return getCounter( "nClones" ) / nReco;
+   
+}
+
+
+void FeedbackSummary::write( const std::string& fileName ) const{
+   
+   
+   std::ofstream file( fileName.c_str(), std::ios::binary | std::ios::trunc );
+   if( !file ) throw std::runtime_error( "FeedbackSummary: can't open " + fileName + " for writing" );
+   
+   file.write( MAGIC, sizeof( MAGIC ) );
+   
+   // the counters with their names, so a reader can check that they match
+   const std::vector< std::string >& names = getCounterNames();
+   writeValue( file, uint32_t( names.size() ) );
+   for( unsigned i=0; i < names.size(); i++ ){
+      
+      writeString( file, names[i] );
+      writeValue( file, _counters[i] );
+      
+   }
+   
+   writeValue( file, uint32_t( _histograms.size() ) );
+   for( unsigned i=0; i < _histograms.size(); i++ ){
+      
+      writeString( file, _histograms[i]._name );
+      writeVector( file, _histograms[i]._edges );
+      writeVector( file, _histograms[i]._numerator );
+      writeVector( file, _histograms[i]._denominator );
+      
+   }
+   
+   if( !file ) throw std::runtime_error( "FeedbackSummary: failed writing " + fileName );
+   
+}
+
+
+FeedbackSummary FeedbackSummary::read( const std::string& fileName ){
+   
+   
+   std::ifstream file( fileName.c_str(), std::ios::binary );
+   if( !file ) throw std::runtime_error( "FeedbackSummary: can't open " + fileName );
+   
+   char magic[ sizeof( MAGIC ) ];
+   file.read( magic, sizeof( magic ) );
+   if( !file || !std::equal( magic, magic + sizeof( magic ), MAGIC ) ) 
+      throw std::runtime_error( "FeedbackSummary: " + fileName + " is not a feedback summary" );
+   
+   FeedbackSummary summary;
+   
+   uint32_t nCounters = 0;
+   readValue( file, nCounters );
+   for( unsigned i=0; i < nCounters && file; i++ ){
+      
+      std::string name = readString( file );
+      uint64_t value = 0;
+      readValue( file, value );
+      
+      summary.counter( name ) = value;
+      
+   }
+   
+   uint32_t nHistograms = 0;
+   readValue( file, nHistograms );
+   for( unsigned i=0; i < nHistograms && file; i++ ){
+      
+      EfficiencyHistogram histogram;
+      histogram._name = readString( file );
+      readVector( file, histogram._edges );
+      readVector( file, histogram._numerator );
+      readVector( file, histogram._denominator );
+      
+      if( ( histogram._numerator.size() != histogram._edges.size() + 1 ) || ( histogram._denominator.size() != histogram._numerator.size() ) )
+         throw std::runtime_error( "FeedbackSummary: corrupt histogram " + histogram._name + " in " + fileName );
+      
+      summary._histograms.push_back( histogram );
+      
+   }
+   
+   if( !file ) throw std::runtime_error( "FeedbackSummary: " + fileName + " is truncated" );
+   
+   return summary;
+   
+}
+
+
+void FeedbackSummary::writeJSON( std::ostream& os ) const{
+   
+   
+   const std::vector< std::string >& names = getCounterNames();
+   
+   os << "{\n  \"counters\": {";
+   for( unsigned i=0; i < names.size(); i++ ) os << ( i > 0 ? "," : "" ) << "\n    \"" << names[i] << "\": " << _counters[i];
+   os << "\n  },\n";
+   
+   os << "  \"efficiency\": " << getEfficiency() << ",\n";
+   os << "  \"ghostrate\": " << getGhostRate() << ",\n";
+   os << "  \"clonerate\": " << getCloneRate() << ",\n";
+   
+   os << "  \"histograms\": [";
+   for( unsigned i=0; i < _histograms.size(); i++ ){
+      
+      os << ( i > 0 ? "," : "" ) << "\n    {\n      \"name\": \"" << _histograms[i]._name << "\",\n      \"edges\": ";
+      writeJSONArray( os, _histograms[i]._edges );
+      os << ",\n      \"numerator\": ";
+      writeJSONArray( os, _histograms[i]._numerator );
+      os << ",\n      \"denominator\": ";
+      writeJSONArray( os, _histograms[i]._denominator );
+      os << "\n    }";
+      
+   }
+   os << "\n  ]\n}\n";
+   
+}
+
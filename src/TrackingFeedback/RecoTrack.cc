@@ -7,7 +7,6 @@
 
 #include "UTIL/LCTrackerConf.h"
 
-#include "Tools/Fitter.h"
 #include "Tools/KiTrackMarlinTools.h"
 
 static const char* TRACK_TYPE_NAMES[] = {"COMPLETE" , "COMPLETE_PLUS" , "INCOMPLETE" , "INCOMPLETE_PLUS" , "GHOST" , "LOST"}; 
@@ -61,16 +60,10 @@ std::string RecoTrack::getRecoTrackInfo() const{
    
    
    // the chi2 prob
-   try{
-      
-      Fitter fitter( _track, _trkSystem );
-      info << "Chi2Prob = " << fitter.getChi2Prob( lcio::TrackState::AtIP ) << "\n";
-   }
-   catch( FitterException e ){
-      
-      info << "Could not be fitted!!!\n";
-      
-   }
+   const TrackFitResult& fit = _fitCache->getFitResult( _track );
+   
+   if( fit.fitOK ) info << "Chi2Prob = " << fit.chi2Prob << "\n";
+   else            info << "Could not be fitted!!!\n";
    
    return info.str();
    
@@ -0,0 +1,40 @@
+#include "TrackFitCache.h"
+
+#include "Tools/Fitter.h"
+
+
+const TrackFitResult& TrackFitCache::getFitResult( Track* track ){
+   
+   
+   std::unordered_map< const Track* , TrackFitResult >::iterator it = _fitResults.find( track );
+   if( it != _fitResults.end() ) return it->second;
+   
+   
+   TrackFitResult result;
+   
+   try{
+      
+      _nFits++;
+      
+      Fitter fitter( track, _trkSystem );
+      result.chi2Prob = fitter.getChi2Prob( lcio::TrackState::AtIP );
+      result.chi2     = fitter.getChi2( lcio::TrackState::AtIP );
+      result.Ndf      = fitter.getNdf( lcio::TrackState::AtIP );
+      result.fitOK    = true;
+      
+   }
+   catch( FitterException e ){
+      
+      result.chi2Prob = -1;
+      result.chi2     = -1;
+      result.Ndf      = -1;
+      result.fitOK    = false;
+      result.error    = e.what();
+      
+   }
+   
+   
+   return _fitResults.insert( std::make_pair( track, result ) ).first->second;
+   
+}
+
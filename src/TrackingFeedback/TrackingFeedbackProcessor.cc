@@ -6,6 +6,8 @@
 #include <algorithm>
 #include <sstream>
 #include <set>
+#include <functional>
+#include <stdexcept>
 
 #include "marlin/VerbosityLevels.h"
 #include "MarlinCED.h"
@@ -15,7 +17,6 @@
 #include "DD4hep/DD4hepUnits.h"
 
 
-#include "Tools/Fitter.h"
 #include "Tools/KiTrackMarlinTools.h"
 
 
@@ -55,6 +56,11 @@ TrackingFeedbackProcessor::TrackingFeedbackProcessor() : Processor("TrackingFeed
                               _tableFileName,
                               std::string("TrackingFeedback.csv") );   
    
+   registerProcessorParameter("EventSummaryOutput",
+                              "Where the summary of every event is written: \"table\" (the table file), \"root\" (the tree \"events\" in the root file) or \"both\"",
+                              _eventSummaryOutput,
+                              std::string("table") );   
+   
    registerProcessorParameter("CutPtMin",
                               "The minimum transversal momentum pt above which tracks are of interest in GeV ",
                               _cutPtMin,
@@ -126,6 +132,16 @@ TrackingFeedbackProcessor::TrackingFeedbackProcessor() : Processor("TrackingFeed
                               _summaryFileName,
                               std::string("TrackingFeedbackSum.csv") );   
    
+   registerProcessorParameter("MergeableSummaryFileName",
+                              "If not empty, the counters of all events and efficiency histograms are saved in this file, so that several jobs can be merged with FeedbackMerge",
+                              _mergeableSummaryFileName,
+                              std::string("") );   
+   
+   registerProcessorParameter("ScanTrackCollections",
+                              "Further track collections (e.g. from the scan points of ForwardTracking) to compare to the true tracks. Their summaries are written to <collection>.summary in the directory of MergeableSummaryFileName",
+                              _scanTrackCollections,
+                              std::vector< std::string >() );   
+   
    
    registerProcessorParameter("RateOfFoundHitsMin",
                               "More than this rate of hits of the real track must be in a reco track to be assigned",
@@ -171,6 +187,27 @@ void TrackingFeedbackProcessor::init() {
    _Bz = bfieldV[2]/dd4hep::tesla ; //The B field in z direction
 
    if ( _drawMCPTracks ) MarlinCED::init(this) ;
+   
+   
+   _writeEventTable = ( _eventSummaryOutput == "table" ) || ( _eventSummaryOutput == "both" );
+   _writeEventTree  = ( _eventSummaryOutput == "root" )  || ( _eventSummaryOutput == "both" );
+   
+   if( !_writeEventTable && !_writeEventTree ) 
+      throw EVENT::Exception( std::string("  Unknown EventSummaryOutput: ") + _eventSummaryOutput + std::string(", use table, root or both" ) ) ;
+   
+   if( _writeEventTable ){
+      
+      // a big buffer, so the rows of many events get written at once
+      _tableFileBuffer.resize( 1 << 16 );
+      _tableFile.rdbuf()->pubsetbuf( &_tableFileBuffer[0], _tableFileBuffer.size() );
+      _tableFile.open( _tableFileName.c_str() , std::ios::app );
+      
+      if( !_tableFile.is_open() ) throw EVENT::Exception( std::string("  Cannot open the table file ") + _tableFileName ) ;
+      
+      _tableFile << "\n";
+      
+   }
+   
 
    _nComplete_Sum            = 0;
    _nCompletePlus_Sum        = 0; 
@@ -184,6 +221,10 @@ void TrackingFeedbackProcessor::init() {
    _nDismissedTrueTracks_Sum = 0; 
    _nClones_Sum               = 0;
    
+   if( !_mergeableSummaryFileName.empty() ) _mergeableSummary = createSummary();
+   
+   _scanSummaries.assign( _scanTrackCollections.size(), createSummary() );
+   
    
    /**********************************************************************************************/
    /*       Initialise the MarlinTrkSystem, needed by the tracks for fitting                     */
@@ -203,6 +244,8 @@ void TrackingFeedbackProcessor::init() {
    // initialise the tracking system
    _trkSystem->init() ;
    
+   _fitCache = new TrackFitCache( _trkSystem );
+   
    
    /**********************************************************************************************/
    /*       Prepare the root output                                                              */
@@ -220,6 +263,7 @@ void TrackingFeedbackProcessor::init() {
    
    _treeNameTrueTracks = "trueTracks";
    _treeNameRecoTracks = "recoTracks";
+   _treeNameEvents = "events";
 
 
    
@@ -243,6 +287,9 @@ void TrackingFeedbackProcessor::init() {
       
    }
    
+   _treeEvents = NULL;
+   if( _writeEventTree ) prepareEventTree( ( rootFileAlreadyExists ) && (_rootFileAppend ) );
+   
   
    
    
@@ -287,6 +334,8 @@ void TrackingFeedbackProcessor::processEvent( LCEvent * evt ) {
    _nDismissedTrueTracks = 0; 
    _nClones = 0;
    
+   _fitCache->clear();
+   
    LCCollection* col = NULL;
    
    
@@ -321,7 +370,7 @@ void TrackingFeedbackProcessor::processEvent( LCEvent * evt ) {
       MCParticle* mcp = dynamic_cast <MCParticle*> (rel->getTo() );
       Track*    track = dynamic_cast <Track*>      (rel->getFrom() );
       
-      TrueTrack* trueTrack = new TrueTrack( track, mcp , _trkSystem );
+      TrueTrack* trueTrack = new TrueTrack( track, mcp , _fitCache );
       
       if ( _drawMCPTracks ) MarlinCED::drawMCParticle( mcp, true, evt, 2, 1, 0xff000, 10, 3.5 );
       
@@ -329,19 +378,16 @@ void TrackingFeedbackProcessor::processEvent( LCEvent * evt ) {
       
       double chi2Prob = 0.;
       
-      try{
-      
-      Fitter fitter( track, _trkSystem );
-      chi2Prob = fitter.getChi2Prob( lcio::TrackState::AtIP );
+      const TrackFitResult& fit = _fitCache->getFitResult( track );
       
-      }
-      catch( FitterException e ){
+      if( fit.fitOK ) chi2Prob = fit.chi2Prob;
+      else{
          
-         streamlog_out( DEBUG3 ) << "Monte Carlo Track " << i << " fit failed: " <<  e.what() << "\n";
+         streamlog_out( DEBUG3 ) << "Monte Carlo Track " << i << " fit failed: " <<  fit.error << "\n";
          
          if( _cutFitFails ){
             
-            streamlog_out( DEBUG3 ) << "Monte Carlo Track " << i << " rejected, because fit failed: " <<  e.what() << "\n";
+            streamlog_out( DEBUG3 ) << "Monte Carlo Track " << i << " rejected, because fit failed: " <<  fit.error << "\n";
             trueTrack->addCut( "FitFail" );
             
          }
@@ -464,6 +510,8 @@ void TrackingFeedbackProcessor::processEvent( LCEvent * evt ) {
    
    if( col != NULL ){
       
+      fillHitTrueTrackMap();
+      
       _nRecoTracks = col->getNumberOfElements()  ;
       streamlog_out( DEBUG4 ) << "Number of Reco Tracks: " << _nRecoTracks << "\n";
       
@@ -471,7 +519,7 @@ void TrackingFeedbackProcessor::processEvent( LCEvent * evt ) {
       for(unsigned i=0; i< _nRecoTracks ; i++){
          
          Track* track = dynamic_cast <Track*> ( col->getElementAt(i) ); 
-         RecoTrack* recoTrack = new RecoTrack( track, _trkSystem );
+         RecoTrack* recoTrack = new RecoTrack( track, _fitCache );
          _recoTracks.push_back( recoTrack );
          checkTheTrack( recoTrack );
          
@@ -487,6 +535,8 @@ void TrackingFeedbackProcessor::processEvent( LCEvent * evt ) {
             if ( _trueTracks[i]->isLost() == true ) _nLost++;
             if ( _trueTracks[i]->isFoundCompletely() ==true ) _nFoundCompletely++;
             
+            if( !_mergeableSummaryFileName.empty() ) fillEfficiencyHistograms( _mergeableSummary, _trueTracks[i] );
+            
          }
       }
       
@@ -499,7 +549,8 @@ void TrackingFeedbackProcessor::processEvent( LCEvent * evt ) {
       streamlog_out( DEBUG4 ).precision (4);
       
       
-      for( unsigned i=0; i < _trueTracks.size(); i++ ){
+      // building the info strings is expensive, so only do it when they get printed
+      if( streamlog::out.write< streamlog::DEBUG4 >() ) for( unsigned i=0; i < _trueTracks.size(); i++ ){
        
          
          TrueTrack* trueTrack = _trueTracks[i];
@@ -579,13 +630,28 @@ void TrackingFeedbackProcessor::processEvent( LCEvent * evt ) {
 
 
       
-      std::ofstream myfile;
-      myfile.open (_tableFileName.c_str() , std::ios::app);
+      if( _writeEventTable ){
+         
+         _tableFile << "\n";
+         for( unsigned i=0; i<data.size(); i++ ) _tableFile << data[i].first << "\t" << data[i].second << "\t\t";   
+         
+      }
       
-      if (isFirstEvent()) myfile << "\n";
-      myfile<< "\n";
-      for( unsigned i=0; i<data.size(); i++ ) myfile << data[i].first << "\t" << data[i].second << "\t\t";   
-      myfile.close();
+      if( _writeEventTree ){
+         
+         // the counters are already bound to their branches
+         _event_run              = evt->getRunNumber();
+         _event_event            = evt->getEventNumber();
+         _event_efficiency       = efficiency;
+         _event_ghostrate        = ghostrate;
+         _event_pLost            = pLost;
+         _event_pComplete        = pComplete;
+         _event_pFoundCompletely = pFoundCompletely;
+         _event_clonerate        = clonerate;
+         
+         _treeEvents->Fill();
+         
+      }
 
       
       /**********************************************************************************************/
@@ -595,6 +661,31 @@ void TrackingFeedbackProcessor::processEvent( LCEvent * evt ) {
       saveRootInformation();
       
       
+      /**********************************************************************************************/
+      /*              Compare the further collections to the same true tracks                      */
+      /**********************************************************************************************/
+      
+      for( unsigned i=0; i < _scanTrackCollections.size(); i++ ){
+         
+         LCCollection* scanCol = NULL;
+         
+         try {
+            
+            scanCol = evt->getCollection( _scanTrackCollections[i] ) ;
+            
+         }
+         catch(DataNotAvailableException &e) {
+            
+            streamlog_out( ERROR ) << "Collection " <<   _scanTrackCollections[i] <<  " is not available!\n";     
+            continue;
+            
+         }
+         
+         evaluateScanCollection( scanCol, _scanSummaries[i] );
+         
+      }
+      
+      
       
  
    }
@@ -607,6 +698,7 @@ void TrackingFeedbackProcessor::processEvent( LCEvent * evt ) {
    _trueTracks.clear();
    for( unsigned int k=0; k < _recoTracks.size(); k++) delete _recoTracks[k];
    _recoTracks.clear();   
+   _map_hit_trueTracks.clear();
 
    _nEvt ++ ;
 }
@@ -646,10 +738,76 @@ void TrackingFeedbackProcessor::end(){
       
    }   
    
+   if( _tableFile.is_open() ) _tableFile.close();
+   
+   if( !_mergeableSummaryFileName.empty() ){
+      
+      _mergeableSummary.counter( "nEvents" )              = _nEvt;
+      _mergeableSummary.counter( "nComplete" )            = _nComplete_Sum;
+      _mergeableSummary.counter( "nCompletePlus" )        = _nCompletePlus_Sum;
+      _mergeableSummary.counter( "nLost" )                = _nLost_Sum;
+      _mergeableSummary.counter( "nIncomplete" )          = _nIncomplete_Sum;
+      _mergeableSummary.counter( "nIncompletePlus" )      = _nIncompletePlus_Sum;
+      _mergeableSummary.counter( "nGhost" )               = _nGhost_Sum;
+      _mergeableSummary.counter( "nFoundCompletely" )     = _nFoundCompletely_Sum;
+      _mergeableSummary.counter( "nRecoTracks" )          = _nRecoTracks_Sum;
+      _mergeableSummary.counter( "nValidTrueTracks" )     = _nValidTrueTracks_Sum;
+      _mergeableSummary.counter( "nDismissedTrueTracks" ) = _nDismissedTrueTracks_Sum;
+      _mergeableSummary.counter( "nClones" )              = _nClones_Sum;
+      
+      try{
+         
+         _mergeableSummary.write( _mergeableSummaryFileName );
+         
+         std::ofstream json( ( _mergeableSummaryFileName + ".json" ).c_str() );
+         _mergeableSummary.writeJSON( json );
+         
+      }
+      catch( std::runtime_error& e ){
+         
+         streamlog_out( ERROR ) << e.what() << "\n";
+         
+      }
+      
+   }
+   
+   
+   // Next to the mergeable summary, so jobs that write that into their own directories don't overwrite each others scan summaries
+   std::string scanSummaryDir;
+   size_t lastSlash = _mergeableSummaryFileName.rfind( '/' );
+   if( lastSlash != std::string::npos ) scanSummaryDir = _mergeableSummaryFileName.substr( 0, lastSlash + 1 );
+   
+   for( unsigned i=0; i < _scanTrackCollections.size(); i++ ){
+      
+      FeedbackSummary& summary = _scanSummaries[i];
+      std::string fileName = scanSummaryDir + _scanTrackCollections[i] + ".summary";
+      
+      streamlog_out( MESSAGE ) << _scanTrackCollections[i] << ": efficiency " << summary.getEfficiency() 
+                               << ", ghostrate " << summary.getGhostRate() << ", clonerate " << summary.getCloneRate() << "\n";
+      
+      try{
+         
+         summary.write( fileName );
+         
+         std::ofstream json( ( fileName + ".json" ).c_str() );
+         summary.writeJSON( json );
+         
+      }
+      catch( std::runtime_error& e ){
+         
+         streamlog_out( ERROR ) << e.what() << "\n";
+         
+      }
+      
+   }
+   
    _rootFile->Write("",TObject::kOverwrite);   
    _rootFile->Close();
    delete _rootFile;
    
+   delete _fitCache;
+   _fitCache = NULL;
+   
 
 }
 
@@ -667,44 +825,80 @@ double TrackingFeedbackProcessor::getDistToIP( MCParticle* mcp ){
  
  
  
+ void TrackingFeedbackProcessor::fillHitTrueTrackMap(){
+   
+   
+   _map_hit_trueTracks.clear();
+   
+   for( unsigned int k=0; k < _trueTracks.size(); k++){
+      
+      const std::vector< TrackerHit* >& trueHits = _trueTracks[k]->getTrueTrack()->getTrackerHits();
+      
+      for( unsigned int j=0; j < trueHits.size(); j++ ){
+         
+         // a hit appearing twice in a true track still only counts once for it
+         bool alreadyStored = false;
+         
+         auto range = _map_hit_trueTracks.equal_range( trueHits[j] );
+         for( auto it = range.first; it != range.second; ++it ){
+            
+            if( it->second == _trueTracks[k] ) alreadyStored = true;
+            
+         }
+         
+         if( !alreadyStored ) _map_hit_trueTracks.insert( std::make_pair( trueHits[j], _trueTracks[k] ) );
+         
+      }
+      
+   }
+   
+   
+}
+ 
+ 
  void TrackingFeedbackProcessor::checkTheTrack( RecoTrack* recoTrack ){ 
  
    
    const Track* track = recoTrack->getTrack();
-   std::vector <TrackerHit*> hitVec = track->getTrackerHits();
+   const std::vector <TrackerHit*>& hitVec = track->getTrackerHits();
    unsigned nHitsTrack = hitVec.size();   //number of hits of the reconstructed track
    
-   std::vector<TrueTrack*> relatedTrueTracks; //to contain all the true tracks relations that correspond to the hits of the track
-                                          //if for example a track consists of 3 points from one true track and two from another
-                                          //at the end this vector will have five entries: 3 times one true track and 2 times the other.
-                                          //so at the end, all we have to do is to count them.
-
+   // The true tracks that correspond to the hits of the track and how many hits of the track belong to each of them.
+   // If for example a track consists of 3 points from one true track and two from another,
+   // at the end this vector will have two entries: one true track with 3 and the other with 2.
+   // There are only a few different true tracks per reco track, so a flat vector is the fastest counter.
+   std::vector< std::pair< TrueTrack* , unsigned > > trueTrackCounts;
+   unsigned nRelatedHits = 0;
+   
    for( unsigned int j=0; j < hitVec.size(); j++ ){ //over all hits in the track
       
+      auto range = _map_hit_trueTracks.equal_range( hitVec[j] );
       
-      for( unsigned int k=0; k < _trueTracks.size(); k++){ //check all relations if they correspond 
+      for( auto it = range.first; it != range.second; ++it ){ // all true tracks containing the hit
+         
+         nRelatedHits++;
          
+         unsigned k=0;
+         while( ( k < trueTrackCounts.size() ) && ( trueTrackCounts[k].first != it->second ) ) k++;
          
-         const Track* trueTrack = _trueTracks[k]->getTrueTrack();
+         if( k < trueTrackCounts.size() ) trueTrackCounts[k].second++;
+         else trueTrackCounts.push_back( std::make_pair( it->second, 1u ) );
          
-         if ( find (trueTrack->getTrackerHits().begin() , trueTrack->getTrackerHits().end() , hitVec[j] ) 
-            !=  trueTrack->getTrackerHits().end())      // if the hit is contained in this truetrack
-         relatedTrueTracks.push_back( _trueTracks[k] );     //add the track (i.e. its relation) to the vector relatedTrueTracks
       }
       
    } 
 
 
-   // After those two for loops we have the vector relatedTrueTracks filled with all the true tracks (relations) that correspond
+   // After this loop we have the vector trueTrackCounts filled with all the true tracks that correspond
    // to the hits in our reconstructed track. 
-   // Ideally this vector would only consist of the same true track again and again, i.e. every hit from the reconstructed
+   // Ideally this vector would only consist of one true track, i.e. every hit from the reconstructed
    // track comes from the true hit.
    //
    // Now we need to find out to what true track the reconstructed belongs or if it doesn't belong to any true track
    // at all (a ghost).
    
    unsigned nHitsFromAssignedTrueTrack = 0;
-   TrueTrack* assignedTrueTrack = getAssignedTrueTrack( relatedTrueTracks , nHitsFromAssignedTrueTrack );
+   TrueTrack* assignedTrueTrack = getAssignedTrueTrack( trueTrackCounts , nRelatedHits , nHitsFromAssignedTrueTrack );
    streamlog_out( DEBUG3 ) << "Assigned true track = " << assignedTrueTrack << "\n";
 
 
@@ -758,30 +952,26 @@ double TrackingFeedbackProcessor::getDistToIP( MCParticle* mcp ){
 }
 
 
-TrueTrack* TrackingFeedbackProcessor::getAssignedTrueTrack( std::vector<TrueTrack*> relatedTrueTracks , unsigned& nHitsFromAssignedTrueTrack ){
+TrueTrack* TrackingFeedbackProcessor::getAssignedTrueTrack( const std::vector< std::pair< TrueTrack* , unsigned > >& trueTrackCounts , 
+                                                             unsigned nRelatedHits , unsigned& nHitsFromAssignedTrueTrack ){
 
    TrueTrack* assignedTrueTrack = NULL;    //the true track most represented in the track 
    
-   sort ( relatedTrueTracks.begin() , relatedTrueTracks.end() ); //Sorting, so all the same elements are at one place
-   
    
    // Find the true track with the most hits in the reconstructed one
+   // (if two have the same number of hits, the one with the lower address is taken)
    
-   TrueTrack* previousTT = NULL;  // used to store the previous true track
-   unsigned n=0;
    unsigned nMax=0;
    
-   for (unsigned j=0; j< relatedTrueTracks.size(); j++){ 
+   for (unsigned j=0; j< trueTrackCounts.size(); j++){ 
       
-      if ( relatedTrueTracks[j] == previousTT ) n++;   //for every repeating element count 1. (that's the reason we sorted before, so we can just count them like this)
-      else n = 1;                                      //previous was different --> we start again with 1
+      TrueTrack* trueTrack = trueTrackCounts[j].first;
+      unsigned n = trueTrackCounts[j].second;
       
-      previousTT = relatedTrueTracks[j];
-      
-      if (n > nMax){ //we have a new winner (a true track) with (currently) the most hits in this track
+      if ( ( n > nMax ) || ( ( n == nMax ) && std::less< TrueTrack* >()( trueTrack, assignedTrueTrack ) ) ){
          
          nMax = n;
-         assignedTrueTrack = relatedTrueTracks[j];
+         assignedTrueTrack = trueTrack;
          
       }
       
@@ -790,7 +980,7 @@ TrueTrack* TrackingFeedbackProcessor::getAssignedTrueTrack( std::vector<TrueTrac
    
    
    if( assignedTrueTrack == NULL ) return NULL; // no track could be associated
-   if( relatedTrueTracks.empty() ) return NULL; // no true tracks were passed
+   if( nRelatedHits == 0 ) return NULL; // no true tracks were passed
    
    unsigned nHitsAssignedTT = assignedTrueTrack->getTrueTrack()->getTrackerHits().size();
    if( nHitsAssignedTT == 0 )      return NULL; // assigned true track has no hits (should really not be)
@@ -802,7 +992,7 @@ TrueTrack* TrackingFeedbackProcessor::getAssignedTrueTrack( std::vector<TrueTrac
    bool assign = true;
    
    
-   if( float( nMax ) / float( relatedTrueTracks.size() )  < _rateOfAssignedHitsMin ) assign = false;
+   if( float( nMax ) / float( nRelatedHits )  < _rateOfAssignedHitsMin ) assign = false;
 
    if( float( nMax ) / float( nHitsAssignedTT )  < _rateOfFoundHitsMin ) assign = false;
    
@@ -850,21 +1040,11 @@ void TrackingFeedbackProcessor::saveRootInformation(){
       _trueTrack_vertexZ = trueTrack->getMCP()->getVertex()[2];
       
       
-      try{
-         
-         Fitter fitter( trueTrack->getTrueTrack(), _trkSystem );
-         _trueTrack_chi2prob = fitter.getChi2Prob( lcio::TrackState::AtIP );
-         _trueTrack_chi2 = fitter.getChi2( lcio::TrackState::AtIP );
-         _trueTrack_Ndf = fitter.getNdf( lcio::TrackState::AtIP );
-         
-      }
-      catch( FitterException e ){
-         
-         _trueTrack_chi2prob = -1;
-         _trueTrack_chi2 = -1;
-         _trueTrack_Ndf = -1;
-         
-      }
+      // the true tracks were already fitted in processEvent, so this comes from the cache
+      const TrackFitResult& fit = _fitCache->getFitResult( trueTrack->getTrueTrack() );
+      _trueTrack_chi2prob = fit.chi2Prob;
+      _trueTrack_chi2 = fit.chi2;
+      _trueTrack_Ndf = fit.Ndf;
       
       
       _treeTrueTracks->Fill();
@@ -890,26 +1070,16 @@ void TrackingFeedbackProcessor::saveRootInformation(){
       
       
       _recoTrack_nTrueTracks = recoTrack->getTrueTracks().size();
+      _recoTrack_type = recoTrack->getType();
       _recoTrack_pt = pt;
       
-      _treeRecoTracks->Fill();
+      const TrackFitResult& fit = _fitCache->getFitResult( recoTrack->getTrack() );
+      _recoTrack_chi2prob = fit.chi2Prob;
+      _recoTrack_chi2 = fit.chi2;
+      _recoTrack_Ndf = fit.Ndf;
       
+      _treeRecoTracks->Fill();
       
-      try{
-         
-         Fitter fitter( recoTrack->getTrack(), _trkSystem );
-         _recoTrack_chi2prob = fitter.getChi2Prob( lcio::TrackState::AtIP );
-         _recoTrack_chi2 = fitter.getChi2( lcio::TrackState::AtIP );
-         _recoTrack_Ndf = fitter.getNdf( lcio::TrackState::AtIP );
-         
-      }
-      catch( FitterException e ){
-         
-         _recoTrack_chi2prob = -1;
-         _recoTrack_chi2 = -1;
-         _recoTrack_Ndf = -1;
-         
-      }
       
    }  
    
@@ -918,6 +1088,59 @@ void TrackingFeedbackProcessor::saveRootInformation(){
 }
 
 
+void TrackingFeedbackProcessor::prepareEventTree( bool append ){
+   
+   
+   if( append ) _treeEvents = dynamic_cast <TTree*>( _rootFile->Get( _treeNameEvents.c_str() ) );
+   
+   // the file may have been written without the events tree
+   bool makeBranches = ( _treeEvents == NULL );
+   if( makeBranches ) _treeEvents = new TTree( _treeNameEvents.c_str(), _treeNameEvents.c_str() );
+   
+   
+   std::vector< std::pair< std::string , float* > > rates;
+   rates.push_back( std::make_pair( "efficiency" , &_event_efficiency ) );
+   rates.push_back( std::make_pair( "ghostrate" , &_event_ghostrate ) );
+   rates.push_back( std::make_pair( "pLost" , &_event_pLost ) );
+   rates.push_back( std::make_pair( "pComplete" , &_event_pComplete ) );
+   rates.push_back( std::make_pair( "pFoundCompletely" , &_event_pFoundCompletely ) );
+   rates.push_back( std::make_pair( "clonerate" , &_event_clonerate ) );
+   
+   std::vector< std::pair< std::string , unsigned* > > counters;
+   counters.push_back( std::make_pair( "nComplete" , &_nComplete ) );
+   counters.push_back( std::make_pair( "nCompletePlus" , &_nCompletePlus ) );
+   counters.push_back( std::make_pair( "nLost" , &_nLost ) );
+   counters.push_back( std::make_pair( "nIncomplete" , &_nIncomplete ) );
+   counters.push_back( std::make_pair( "nIncompletePlus" , &_nIncompletePlus ) );
+   counters.push_back( std::make_pair( "nGhost" , &_nGhost ) );
+   counters.push_back( std::make_pair( "nClones" , &_nClones ) );
+   counters.push_back( std::make_pair( "nFoundCompletely" , &_nFoundCompletely ) );
+   counters.push_back( std::make_pair( "nValidTrueTracks" , &_nValidTrueTracks ) );
+   counters.push_back( std::make_pair( "nDismissedTrueTracks" , &_nDismissedTrueTracks ) );
+   counters.push_back( std::make_pair( "nRecoTracks" , &_nRecoTracks ) );
+   
+   
+   if( makeBranches ){
+      
+      _treeEvents->Branch( "run" , &_event_run );
+      _treeEvents->Branch( "event" , &_event_event );
+      for( unsigned i=0; i < rates.size(); i++ ) _treeEvents->Branch( rates[i].first.c_str() , rates[i].second );
+      for( unsigned i=0; i < counters.size(); i++ ) _treeEvents->Branch( counters[i].first.c_str() , counters[i].second );
+      
+   }
+   else{
+      
+      _treeEvents->SetBranchAddress( "run" , &_event_run );
+      _treeEvents->SetBranchAddress( "event" , &_event_event );
+      for( unsigned i=0; i < rates.size(); i++ ) _treeEvents->SetBranchAddress( rates[i].first.c_str() , rates[i].second );
+      for( unsigned i=0; i < counters.size(); i++ ) _treeEvents->SetBranchAddress( counters[i].first.c_str() , counters[i].second );
+      
+   }
+   
+   
+}
+
+
 void TrackingFeedbackProcessor::makeRootBranches(){
    
    _treeTrueTracks->Branch( "nComplete", &_trueTrack_nComplete );
@@ -940,6 +1163,7 @@ void TrackingFeedbackProcessor::makeRootBranches(){
    
    
    _treeRecoTracks->Branch( "nTrueTracks", &_recoTrack_nTrueTracks );
+   _treeRecoTracks->Branch( "Type", &_recoTrack_type );
    _treeRecoTracks->Branch( "pT" , &_recoTrack_pt );
    _treeRecoTracks->Branch( "evtNr" , &_nEvt );
    _treeRecoTracks->Branch( "chi2prob" , &_recoTrack_chi2prob );
@@ -971,6 +1195,7 @@ void TrackingFeedbackProcessor::setRootBranches(){
    
    
    _treeRecoTracks->SetBranchAddress( "nTrueTracks", &_recoTrack_nTrueTracks );
+   _treeRecoTracks->SetBranchAddress( "Type", &_recoTrack_type );
    _treeRecoTracks->SetBranchAddress( "pT" , &_recoTrack_pt );
    _treeRecoTracks->SetBranchAddress( "evtNr" , &_nEvt );
    _treeRecoTracks->SetBranchAddress( "chi2prob" , &_recoTrack_chi2prob );
@@ -1011,5 +1236,114 @@ unsigned TrackingFeedbackProcessor::getNumberOfHitsFromDifferentLayers( std::vec
 }
 
 
+FeedbackSummary TrackingFeedbackProcessor::createSummary() const {
+   
+   
+   FeedbackSummary summary;
+   
+   summary.addHistogram( EfficiencyHistogram( "efficiency_pt"    , EfficiencyHistogram::logEdges( 40, 0.01, 100. ) ) ); // GeV
+   summary.addHistogram( EfficiencyHistogram( "efficiency_theta" , EfficiencyHistogram::linearEdges( 45, 0., 90. ) ) ); // deg
+   summary.addHistogram( EfficiencyHistogram( "efficiency_vertex", EfficiencyHistogram::linearEdges( 50, 0., 100. ) ) ); // mm
+   
+   return summary;
+   
+   
+}
 
 
+void TrackingFeedbackProcessor::fillEfficiencyHistograms( FeedbackSummary& summary, const TrueTrack* trueTrack ) const {
+   
+   
+   const MCParticle* mcp = trueTrack->getMCP();
+   const double* p = mcp->getMomentum();
+   double pt = sqrt( p[0]*p[0] + p[1]*p[1] );
+   double theta = ( 180./M_PI ) * atan( fabs( pt / p[2] ) ) ;
+   double dist = sqrt( mcp->getVertex()[0]*mcp->getVertex()[0] + mcp->getVertex()[1]*mcp->getVertex()[1] + 
+                       mcp->getVertex()[2]*mcp->getVertex()[2] );
+   
+   bool found = !trueTrack->isLost();
+   summary.histogram( "efficiency_pt" ).fill( pt, found );
+   summary.histogram( "efficiency_theta" ).fill( theta, found );
+   summary.histogram( "efficiency_vertex" ).fill( dist, found );
+   
+   
+}
+
+
+void TrackingFeedbackProcessor::evaluateScanCollection( LCCollection* col, FeedbackSummary& summary ){
+   
+   
+   // checkTheTrack counts into the counters of the event, so they are set aside
+   unsigned nComplete       = _nComplete;
+   unsigned nCompletePlus   = _nCompletePlus;
+   unsigned nIncomplete     = _nIncomplete;
+   unsigned nIncompletePlus = _nIncompletePlus;
+   unsigned nGhost          = _nGhost;
+   
+   _nComplete       = 0;
+   _nCompletePlus   = 0;
+   _nIncomplete     = 0;
+   _nIncompletePlus = 0;
+   _nGhost          = 0;
+   
+   for( unsigned i=0; i < _trueTracks.size(); i++ ) _trueTracks[i]->clearRecoTracks();
+   
+   
+   // the true tracks and the map of their hits stay the same, only the reco tracks are new
+   unsigned nRecoTracks = col->getNumberOfElements();
+   std::vector< RecoTrack* > recoTracks;
+   
+   for( unsigned i=0; i < nRecoTracks; i++ ){
+      
+      Track* track = dynamic_cast <Track*> ( col->getElementAt(i) ); 
+      RecoTrack* recoTrack = new RecoTrack( track, _fitCache );
+      recoTracks.push_back( recoTrack );
+      checkTheTrack( recoTrack );
+      
+   }
+   
+   uint64_t nLost = 0;
+   uint64_t nFoundCompletely = 0;
+   uint64_t nClones = 0;
+   
+   for( unsigned i=0; i < _trueTracks.size(); i++ ){
+      
+      if( _trueTracks[i]->getRecoTracks().size() > 1 ) nClones += _trueTracks[i]->getRecoTracks().size() -1;
+      
+      if ( _trueTracks[i]->getCuts().empty() ){
+         
+         if ( _trueTracks[i]->isLost() ) nLost++;
+         if ( _trueTracks[i]->isFoundCompletely() ) nFoundCompletely++;
+         
+         fillEfficiencyHistograms( summary, _trueTracks[i] );
+         
+      }
+      
+   }
+   
+   summary.counter( "nEvents" )              += 1;
+   summary.counter( "nComplete" )            += _nComplete;
+   summary.counter( "nCompletePlus" )        += _nCompletePlus;
+   summary.counter( "nLost" )                += nLost;
+   summary.counter( "nIncomplete" )          += _nIncomplete;
+   summary.counter( "nIncompletePlus" )      += _nIncompletePlus;
+   summary.counter( "nGhost" )               += _nGhost;
+   summary.counter( "nFoundCompletely" )     += nFoundCompletely;
+   summary.counter( "nRecoTracks" )          += nRecoTracks;
+   summary.counter( "nValidTrueTracks" )     += _nValidTrueTracks;
+   summary.counter( "nDismissedTrueTracks" ) += _nDismissedTrueTracks;
+   summary.counter( "nClones" )              += nClones;
+   
+   
+   // the reco tracks are gone after this, so the true tracks must not point to them
+   for( unsigned i=0; i < _trueTracks.size(); i++ ) _trueTracks[i]->clearRecoTracks();
+   for( unsigned i=0; i < recoTracks.size(); i++ ) delete recoTracks[i];
+   
+   _nComplete       = nComplete;
+   _nCompletePlus   = nCompletePlus;
+   _nIncomplete     = nIncomplete;
+   _nIncompletePlus = nIncompletePlus;
+   _nGhost          = nGhost;
+   
+   
+}
@@ -5,7 +5,6 @@
 #include <algorithm>
 
 
-#include "Tools/Fitter.h"
 #include "Tools/KiTrackMarlinTools.h"
 
 
@@ -86,15 +85,16 @@ std::string TrueTrack::getTrueTrackInfo() const{
    // The Fit Information 
    
    
-   try{
+   const TrackFitResult& fit = _fitCache->getFitResult( _trueTrack );
+   
+   if( fit.fitOK ){
       
-      Fitter fitter( _trueTrack, _trkSystem );
-      trackInfo << "Chi2Prob = " << fitter.getChi2Prob( lcio::TrackState::AtIP ) 
-      << ", Chi2 = " << fitter.getChi2( lcio::TrackState::AtIP ) 
-      << ", Ndf = " << fitter.getNdf( lcio::TrackState::AtIP ) << "\n";
+      trackInfo << "Chi2Prob = " << fit.chi2Prob 
+      << ", Chi2 = " << fit.chi2 
+      << ", Ndf = " << fit.Ndf << "\n";
       
    }
-   catch( FitterException e ){
+   else{
       
       trackInfo << "Could not be fitted!!!\n";
       
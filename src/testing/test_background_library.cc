@@ -0,0 +1,163 @@
+////////////////////////
+// background_library test
+////////////////////////
+
+#include "ilctest/ILCTest.h"
+#include <exception>
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdio>
+
+#include <unistd.h>
+
+#include "FTDBackgroundLibrary.h"
+
+using namespace std ;
+
+// this should be the first line in your test
+static ILCTest ilctest = ILCTest( "background_library" , std::cout );
+
+
+/** Overwrites bytes of a file at a position */
+void patchFile( const std::string& fileName, long position, const void* bytes, unsigned nBytes ){
+
+   std::fstream file( fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary );
+   file.seekp( position );
+   file.write( static_cast< const char* >( bytes ), nBytes );
+
+}
+
+
+/** @return whether opening the library throws a std::runtime_error */
+bool isRejected( const std::string& fileName ){
+
+   try{
+
+      FTDBackgroundLibrary library( fileName );
+
+   }
+   catch( std::runtime_error& ){
+
+      return true;
+
+   }
+
+   return false;
+
+}
+
+
+//=============================================================================
+
+int main(int , char** ){
+
+    try{
+
+        // ----- write your tests in here -------------------------------------
+
+        std::string fileName = "test_background_library.bkg";
+
+        const unsigned nSensors = 10;
+
+        // frames of different sizes, including an empty one
+        std::vector< std::vector< FTDBackgroundLibraryHit > > frames( 4 );
+        for( unsigned f=0; f < frames.size(); f++ ){
+
+           for( unsigned j=0; j < 7*f; j++ ){
+
+              FTDBackgroundLibraryHit hit = { ( 3*j + f ) % nSensors, 1.5f*j, -0.25f*f };
+              frames[f].push_back( hit );
+
+           }
+
+        }
+
+
+        ilctest.log( "testing that a written library is read back unchanged" );
+
+        FTDBackgroundLibrary::write( fileName, nSensors, frames );
+
+        {
+
+           FTDBackgroundLibrary library( fileName );
+
+           bool same = ( library.getNumberOfSensors() == nSensors ) && ( library.getNumberOfFrames() == frames.size() );
+
+           for( unsigned f=0; f < frames.size() && same; f++ ){
+
+              if( unsigned( library.endFrame( f ) - library.beginFrame( f ) ) != frames[f].size() ){
+
+                 same = false;
+                 break;
+
+              }
+
+              for( unsigned j=0; j < frames[f].size(); j++ ){
+
+                 const FTDBackgroundLibraryHit& hit = library.beginFrame( f )[j];
+
+                 if( hit.sensor != frames[f][j].sensor || hit.x != frames[f][j].x || hit.y != frames[f][j].y ) same = false;
+
+              }
+
+           }
+
+           if( same ) ilctest.pass( "write -> read round trip" );
+           else ilctest.error( "write -> read round trip" );
+
+        }
+
+
+        ilctest.log( "testing that corrupt libraries are rejected" );
+
+        // the layout: header (8 bytes magic, 2 x uint32), nFrames + 1 uint64 offsets, the hits
+        const long offsetsStart = 16;
+        const long hitsStart = offsetsStart + ( frames.size() + 1 )*sizeof( uint64_t );
+
+        FTDBackgroundLibrary::write( fileName, nSensors, frames );
+        patchFile( fileName, 0, "NOTABKG!", 8 );
+        if( isRejected( fileName ) ) ilctest.pass( "wrong magic is rejected" );
+        else ilctest.error( "wrong magic is rejected" );
+
+        FTDBackgroundLibrary::write( fileName, nSensors, frames );
+        if( truncate( fileName.c_str(), hitsStart + 5 ) != 0 ) ilctest.error( "can't truncate the file" );
+        if( isRejected( fileName ) ) ilctest.pass( "truncated file is rejected" );
+        else ilctest.error( "truncated file is rejected" );
+
+        FTDBackgroundLibrary::write( fileName, nSensors, frames );
+        uint32_t badSensor = nSensors;
+        patchFile( fileName, hitsStart + 3*sizeof( FTDBackgroundLibraryHit ), &badSensor, sizeof( badSensor ) );
+        if( isRejected( fileName ) ) ilctest.pass( "hit on a sensor >= the number of sensors is rejected" );
+        else ilctest.error( "hit on a sensor >= the number of sensors is rejected" );
+
+        FTDBackgroundLibrary::write( fileName, nSensors, frames );
+        uint64_t badOffset = 30; // the offsets are 0, 0, 7, 21, 42: frame 1 would end after frame 2
+        patchFile( fileName, offsetsStart + 2*sizeof( uint64_t ), &badOffset, sizeof( badOffset ) );
+        if( isRejected( fileName ) ) ilctest.pass( "frames out of order are rejected" );
+        else ilctest.error( "frames out of order are rejected" );
+
+        FTDBackgroundLibrary::write( fileName, nSensors, frames );
+        uint64_t badFirst = 1;
+        patchFile( fileName, offsetsStart, &badFirst, sizeof( badFirst ) );
+        if( isRejected( fileName ) ) ilctest.pass( "first frame not at the first hit is rejected" );
+        else ilctest.error( "first frame not at the first hit is rejected" );
+
+        remove( fileName.c_str() );
+
+        // --------------------------------------------------------------------
+
+
+    //} catch( ... ){
+    } catch( exception &e ){
+        ilctest.log( "exception caught" );
+        ilctest.fatal_error( e.what() );
+    }
+
+
+    return 0;
+}
+
+//=============================================================================
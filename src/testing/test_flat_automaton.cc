@@ -0,0 +1,402 @@
+////////////////////////
+// flat_automaton test
+////////////////////////
+
+#include "ilctest/ILCTest.h"
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <atomic>
+
+#include "KiTrack/Automaton.h"
+#include "KiTrack/SegmentBuilder.h"
+#include "KiTrack/ISectorConnector.h"
+#include "Criteria/ICriterion.h"
+
+#include "SectorSystemEndcap.h"
+#include "EndcapHitSimple.h"
+#include "ParallelSegmentBuilder.h"
+#include "FlatAutomaton.h"
+
+using namespace std ;
+using namespace KiTrackMarlin;
+
+// this should be the first line in your test
+static ILCTest ilctest = ILCTest( "flat_automaton" , std::cout );
+
+
+/** Connects a sector to the neighbouring phi sectors on the next two layers towards the IP, so layers can be skipped.
+ * Layers 1 and 2 are connected to the IP (layer 0).
+ */
+class TestSectorConnector : public ISectorConnector{
+
+public:
+
+   TestSectorConnector( const SectorSystemEndcap* sectorSystem ): _sectorSystem( sectorSystem ){}
+
+   virtual std::set< int > getTargetSectors( int sector ){
+
+      std::set< int > targets;
+
+      int layer = _sectorSystem->getLayer( sector );
+      int phi = _sectorSystem->getPhi( sector );
+      int nPhi = _sectorSystem->getPhiSectors();
+
+      for( int layerStep = 1; layerStep <= 2 && layer - layerStep >= 0; layerStep++ ){
+
+         int targetLayer = layer - layerStep;
+
+         if( targetLayer == 0 ){
+
+            targets.insert( _sectorSystem->getSector( 0, 0, 0 ) );
+            break;
+
+         }
+
+         for( int phiStep = -1; phiStep <= 1; phiStep++ ) targets.insert( _sectorSystem->getSector( targetLayer, ( phi + phiStep + nPhi ) % nPhi, 0 ) );
+
+      }
+
+      return targets;
+
+   }
+
+   virtual ~TestSectorConnector(){}
+
+private:
+
+   const SectorSystemEndcap* _sectorSystem;
+
+};
+
+
+/** A criterion for straight tracks from the IP.
+ *
+ * For 1-segments: the angle between the two hits as seen from the IP, for longer segments: the angle between the
+ * directions from the last to the first hit of the segments. Compatible if the angle is below the cut.
+ * Hits at the IP are always compatible.
+ */
+class TestCriterion : public ICriterion{
+
+public:
+
+   TestCriterion( const std::string& type, double maxAngle ): _maxAngle( maxAngle ){
+
+      _name = "TestCriterion";
+      _type = type;
+      _saveValues = false;
+
+   }
+
+   virtual bool areCompatible( Segment* parent , Segment* child ){
+
+      std::vector< IHit* > parentHits = parent->getHits();
+      std::vector< IHit* > childHits = child->getHits();
+
+      double a[3];
+      double b[3];
+
+      if( parentHits.size() == 1 ){
+
+         if( parentHits[0]->isVirtual() || childHits[0]->isVirtual() ) return true;
+
+         getDirection( NULL, parentHits[0], a );
+         getDirection( NULL, childHits[0], b );
+
+      }
+      else{
+
+         if( parentHits.back()->isVirtual() || childHits.back()->isVirtual() ) return true;
+
+         getDirection( parentHits.back(), parentHits.front(), a );
+         getDirection( childHits.back(), childHits.front(), b );
+
+      }
+
+      double dot = a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+      double norm = sqrt( ( a[0]*a[0] + a[1]*a[1] + a[2]*a[2] ) * ( b[0]*b[0] + b[1]*b[1] + b[2]*b[2] ) );
+
+      if( norm <= 0. ) return true;
+
+      return acos( std::min( 1., dot / norm ) ) < _maxAngle;
+
+   }
+
+   virtual ~TestCriterion(){}
+
+private:
+
+   /** the vector from hit "from" (NULL = the IP) to hit "to" */
+   static void getDirection( IHit* from, IHit* to, double* direction ){
+
+      direction[0] = to->getX() - ( from != NULL ? from->getX() : 0. );
+      direction[1] = to->getY() - ( from != NULL ? from->getY() : 0. );
+      direction[2] = to->getZ() - ( from != NULL ? from->getZ() : 0. );
+
+   }
+
+   double _maxAngle;
+
+};
+
+
+/** Straight tracks from the IP that miss some layers, and noise hits. The IP is a virtual hit on layer 0. */
+void createHits( unsigned seed, const SectorSystemEndcap& sectorSystem, std::map< int , std::vector< IHit* > >& map_sector_hits,
+                 std::vector< IHit* >& allHits ){
+
+   std::mt19937 generator( seed );
+   std::uniform_real_distribution< double > flat( 0., 1. );
+   std::normal_distribution< double > scatter( 0., 0.3 );
+
+   unsigned nLayers = sectorSystem.getNLayers();
+   unsigned nPhi = sectorSystem.getPhiSectors();
+
+   std::vector< std::vector< double > > positions; // x, y, z, layer
+
+   for( unsigned iTrack=0; iTrack < 40; iTrack++ ){
+
+      double phi = 2.*M_PI*flat( generator );
+      double slope = 0.2 + 0.8*flat( generator ); // r / z
+
+      for( unsigned layer=1; layer < nLayers; layer++ ){
+
+         if( flat( generator ) < 0.15 ) continue; // a missing hit, the track skips this layer
+
+         double z = 100.*layer;
+         double position[] = { slope*z*cos( phi ) + scatter( generator ), slope*z*sin( phi ) + scatter( generator ), z, double( layer ) };
+         positions.push_back( std::vector< double >( position, position + 4 ) );
+
+      }
+
+   }
+
+   for( unsigned iNoise=0; iNoise < 100; iNoise++ ){
+
+      unsigned layer = 1 + unsigned( flat( generator )*( nLayers - 1 ) ) % ( nLayers - 1 );
+      double phi = 2.*M_PI*flat( generator );
+      double r = 100.*layer*( 0.2 + 0.8*flat( generator ) );
+      double z = 100.*layer;
+
+      double position[] = { r*cos( phi ), r*sin( phi ), z, double( layer ) };
+      positions.push_back( std::vector< double >( position, position + 4 ) );
+
+   }
+
+   for( unsigned i=0; i < positions.size(); i++ ){
+
+      double phi = atan2( positions[i][1], positions[i][0] );
+      if( phi < 0. ) phi += 2.*M_PI;
+
+      int iPhi = std::min( int( phi / ( 2.*M_PI ) * nPhi ), int( nPhi ) - 1 );
+
+      IHit* hit = new EndcapHitSimple( positions[i][0], positions[i][1], positions[i][2], int( positions[i][3] ), iPhi, 0, &sectorSystem );
+
+      map_sector_hits[ hit->getSector() ].push_back( hit );
+      allHits.push_back( hit );
+
+   }
+
+   IHit* virtualIPHit = new EndcapHitSimple( 0., 0., 0., 0, 0, 0, &sectorSystem );
+   virtualIPHit->setIsVirtual( true );
+
+   map_sector_hits[ virtualIPHit->getSector() ].push_back( virtualIPHit );
+   allHits.push_back( virtualIPHit );
+
+}
+
+
+/** What comes out of a run of an automaton: the number of connections after every step and the tracks */
+struct AutomatonResult{
+
+   std::vector< unsigned > nConnections;
+   std::vector< std::vector< IHit* > > tracks;
+
+};
+
+
+/** The steps AutomatonRound does on the 1-segments in every round of ForwardTracking and SiliconEndcapTracking */
+template< class AutomatonType >
+void runAutomaton( AutomatonType& automaton, const std::vector< ICriterion* >& crit3Vec, const std::vector< ICriterion* >& crit4Vec,
+                   AutomatonResult& result ){
+
+   result.nConnections.push_back( automaton.getNumberOfConnections() );
+
+   const std::vector< ICriterion* >* critVecs[] = { &crit3Vec, &crit4Vec };
+
+   for( unsigned i=0; i < 2; i++ ){
+
+      automaton.clearCriteria();
+      automaton.addCriteria( *critVecs[i] );
+
+      automaton.lengthenSegments();
+      result.nConnections.push_back( automaton.getNumberOfConnections() );
+
+      automaton.doAutomaton();
+      automaton.cleanBadStates();
+      automaton.resetStates();
+      result.nConnections.push_back( automaton.getNumberOfConnections() );
+
+   }
+
+   result.tracks = automaton.getTracks( 3 );
+
+   // the same tracks, whatever their order
+   std::sort( result.tracks.begin(), result.tracks.end() );
+
+}
+
+
+//=============================================================================
+
+int main(int , char** ){
+
+    try{
+
+        // ----- write your tests in here -------------------------------------
+
+        ilctest.log( "testing that FlatAutomaton gives the same connections and tracks as KiTrack::Automaton" );
+
+        SectorSystemEndcap sectorSystem( 8, 8, 1 );
+        TestSectorConnector sectorConnector( &sectorSystem );
+
+        // the cut offs of two rounds, the second one tighter (angles in rad)
+        const double maxAngles[2][3] = { { 0.05, 0.02, 0.02 }, { 0.02, 0.01, 0.01 } };
+
+        for( unsigned seed = 1; seed <= 5; seed++ ){
+
+           std::map< int , std::vector< IHit* > > map_sector_hits;
+           std::vector< IHit* > allHits;
+           createHits( seed, sectorSystem, map_sector_hits, allHits );
+
+           for( unsigned round=0; round < 2; round++ ){
+
+              TestCriterion crit2( "2Hit", maxAngles[round][0] );
+              TestCriterion crit3( "3Hit", maxAngles[round][1] );
+              TestCriterion crit4( "4Hit", maxAngles[round][2] );
+
+              std::vector< ICriterion* > crit2Vec( 1, &crit2 );
+              std::vector< ICriterion* > crit3Vec( 1, &crit3 );
+              std::vector< ICriterion* > crit4Vec( 1, &crit4 );
+
+
+              // the pointer based automaton of KiTrack, built like ForwardTracking did before the FlatAutomaton
+              AutomatonResult reference;
+
+              SegmentBuilder segBuilder( map_sector_hits );
+              segBuilder.addCriteria( crit2Vec );
+              segBuilder.addSectorConnector( &sectorConnector );
+
+              Automaton automaton = segBuilder.get1SegAutomaton();
+              runAutomaton( automaton, crit3Vec, crit4Vec, reference );
+
+
+              for( unsigned nThreads = 1; nThreads <= 4; nThreads += 3 ){
+
+                 AutomatonResult flatResult;
+
+                 ParallelSegmentBuilder parallelSegBuilder( map_sector_hits, nThreads );
+                 parallelSegBuilder.addCriteria( crit2Vec );
+                 parallelSegBuilder.addSectorConnector( &sectorConnector );
+
+                 FlatAutomaton flatAutomaton( nThreads );
+                 parallelSegBuilder.get1SegAutomaton( flatAutomaton, unsigned( -1 ) );
+                 runAutomaton( flatAutomaton, crit3Vec, crit4Vec, flatResult );
+
+                 std::stringstream connections;
+                 for( unsigned i=0; i < reference.nConnections.size(); i++ ) connections << ( i > 0 ? ", " : "" ) << reference.nConnections[i];
+
+                 std::stringstream test_case;
+                 test_case << "seed " << seed << ", round " << round << ", " << nThreads << " thread(s): "
+                           << "connections " << connections.str() << ", " << reference.tracks.size() << " tracks";
+
+                 if( reference.tracks.empty() ) ilctest.error( test_case.str() + ": no tracks found, the test is meaningless" );
+                 else if( flatResult.nConnections != reference.nConnections ) ilctest.error( test_case.str() + ": the numbers of connections differ" );
+                 else if( flatResult.tracks != reference.tracks ) ilctest.error( test_case.str() + ": the tracks differ" );
+                 else ilctest.pass( test_case.str() );
+
+              }
+
+           }
+
+           for( unsigned i=0; i < allHits.size(); i++ ) delete allHits[i];
+
+        }
+
+
+        ilctest.log( "testing that an aborted or cancelled building leaves the automaton empty" );
+
+        std::map< int , std::vector< IHit* > > map_sector_hits;
+        std::vector< IHit* > allHits;
+        createHits( 1, sectorSystem, map_sector_hits, allHits );
+
+        TestCriterion crit2( "2Hit", maxAngles[0][0] );
+        std::vector< ICriterion* > crit2Vec( 1, &crit2 );
+
+        std::atomic< bool > cancelled( true );
+
+        for( unsigned nThreads = 1; nThreads <= 4; nThreads += 3 ){
+
+           // too many connections: the building stops as soon as it has more than maxConnections
+           const unsigned maxConnections = 10;
+
+           ParallelSegmentBuilder abortedSegBuilder( map_sector_hits, nThreads );
+           abortedSegBuilder.addCriteria( crit2Vec );
+           abortedSegBuilder.addSectorConnector( &sectorConnector );
+
+           FlatAutomaton abortedFlatAutomaton( nThreads );
+           bool built = abortedSegBuilder.get1SegAutomaton( abortedFlatAutomaton, maxConnections );
+
+           Automaton abortedAutomaton;
+           bool builtAutomaton = abortedSegBuilder.get1SegAutomaton( abortedAutomaton, maxConnections );
+
+           std::stringstream abort_case;
+           abort_case << nThreads << " thread(s), MaxConnections " << maxConnections << ": "
+                      << abortedSegBuilder.getNumberOfConnections() << " connections found until the abort";
+
+           if( built || builtAutomaton ) ilctest.error( abort_case.str() + ": get1SegAutomaton returned true" );
+           else if( abortedSegBuilder.getNumberOfConnections() <= maxConnections ) ilctest.error( abort_case.str() + ": aborted too early" );
+           else if( abortedFlatAutomaton.getNumberOfSegments() != 0 || abortedFlatAutomaton.getNumberOfConnections() != 0
+                    || abortedAutomaton.getNumberOfConnections() != 0 ) ilctest.error( abort_case.str() + ": the automaton is not empty" );
+           else ilctest.pass( abort_case.str() );
+
+
+           // cancelled before it even started
+           ParallelSegmentBuilder cancelledSegBuilder( map_sector_hits, nThreads );
+           cancelledSegBuilder.addCriteria( crit2Vec );
+           cancelledSegBuilder.addSectorConnector( &sectorConnector );
+           cancelledSegBuilder.setCancelFlag( &cancelled );
+
+           FlatAutomaton cancelledFlatAutomaton( nThreads );
+           built = cancelledSegBuilder.get1SegAutomaton( cancelledFlatAutomaton, unsigned( -1 ) );
+
+           std::stringstream cancel_case;
+           cancel_case << nThreads << " thread(s), cancel flag set";
+
+           if( built ) ilctest.error( cancel_case.str() + ": get1SegAutomaton returned true" );
+           else if( cancelledFlatAutomaton.getNumberOfSegments() != 0 || cancelledFlatAutomaton.getNumberOfConnections() != 0 ) ilctest.error( cancel_case.str() + ": the automaton is not empty" );
+           else ilctest.pass( cancel_case.str() );
+
+        }
+
+        for( unsigned i=0; i < allHits.size(); i++ ) delete allHits[i];
+
+        // --------------------------------------------------------------------
+
+
+    //} catch( ... ){
+    } catch( exception &e ){
+        ilctest.log( "exception caught" );
+        ilctest.fatal_error( e.what() );
+    }
+
+
+    return 0;
+}
+
+//=============================================================================
@@ -0,0 +1,231 @@
+////////////////////////
+// philox test
+////////////////////////
+
+#include "ilctest/ILCTest.h"
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+
+#include "PhiloxRandom.h"
+#include "FTDBackgroundProcessor.h"
+
+using namespace std ;
+
+// this should be the first line in your test
+static ILCTest ilctest = ILCTest( "philox" , std::cout );
+
+
+/** Gives the test access to the counter based generation of FTDBackgroundProcessor, on a made up sensor table */
+class TestBackgroundProcessor : public FTDBackgroundProcessor{
+
+public:
+
+   TestBackgroundProcessor(){
+
+      _bunchSpacing = 0.5;
+      _nLayers = 3;
+
+      unsigned nPetals = 16;
+      unsigned nSensorsPerPetal = 2;
+
+      for( int side = -1; side <= 1; side += 2 ){
+
+         for( int layer = 0; layer < _nLayers; layer++ ){
+
+            unsigned firstSensorOfLayer = _sensors.size();
+
+            for( unsigned petal = 0; petal < nPetals; petal++ ){
+
+               for( unsigned iSensor = 1; iSensor <= nSensorsPerPetal; iSensor++ ){
+
+                  FTDBackgroundSensor sensor;
+
+                  sensor.side = side;
+                  sensor.layer = layer;
+                  sensor.petal = petal;
+                  sensor.sensor = iSensor;
+                  sensor.cellID0 = ( ( side + 1 ) << 20 ) | ( layer << 12 ) | ( petal << 4 ) | iSensor;
+                  sensor.isPixel = ( layer == 0 );
+                  sensor.frontSensor = ( iSensor == 2 && !sensor.isPixel ) ? int( _sensors.size() ) - 1 : -1;
+                  sensor.firstSensorOfLayer = firstSensorOfLayer;
+                  sensor.nPetals = nPetals;
+                  sensor.nSensorsPerPetal = nSensorsPerPetal;
+                  sensor.rMin = 40. + 10.*layer;
+                  sensor.lengthMin = 20.;
+                  sensor.lengthMax = 60.;
+                  sensor.width = 100.;
+                  sensor.phi = 2.*M_PI*petal/nPetals;
+                  sensor.z = side*( 200. + 100.*layer );
+                  sensor.area = ( sensor.lengthMin + sensor.lengthMax )/2. * sensor.width / 100.;
+                  sensor.integratedBX = 10;
+                  sensor.densityMean = 3.;
+                  sensor.densitySigma = 1.;
+                  sensor.cosPhi = cos( sensor.phi );
+                  sensor.sinPhi = sin( sensor.phi );
+
+                  FTDBackgroundHitTemplate hitTemplate = { sensor.cellID0, 0, { 0.f, 0.f }, { 0.f, 0.f }, 0.004f, 0.004f };
+                  sensor.hitTemplate = hitTemplate;
+
+                  _sensors.push_back( sensor );
+
+               }
+
+            }
+
+         }
+
+      }
+
+   }
+
+   void generate( unsigned seed, int nThreads, std::vector< std::vector< TrackerHitPlaneImpl* > >& sensorHits ){
+
+      _nThreads = nThreads;
+
+      sensorHits.assign( _sensors.size(), std::vector< TrackerHitPlaneImpl* >() );
+      generateHitsCounterBased( seed, sensorHits );
+
+   }
+
+};
+
+
+/** @return whether the hits of all sensors have the same cellIDs, positions and times */
+bool areEqual( const std::vector< std::vector< TrackerHitPlaneImpl* > >& hitsA, const std::vector< std::vector< TrackerHitPlaneImpl* > >& hitsB ){
+
+   if( hitsA.size() != hitsB.size() ) return false;
+
+   for( unsigned i=0; i < hitsA.size(); i++ ){
+
+      if( hitsA[i].size() != hitsB[i].size() ) return false;
+
+      for( unsigned j=0; j < hitsA[i].size(); j++ ){
+
+         const TrackerHitPlaneImpl* a = hitsA[i][j];
+         const TrackerHitPlaneImpl* b = hitsB[i][j];
+
+         if( a->getCellID0() != b->getCellID0() || a->getTime() != b->getTime() ) return false;
+
+         for( unsigned k=0; k < 3; k++ ) if( a->getPosition()[k] != b->getPosition()[k] ) return false;
+
+      }
+
+   }
+
+   return true;
+
+}
+
+
+void deleteHits( std::vector< std::vector< TrackerHitPlaneImpl* > >& sensorHits ){
+
+   for( unsigned i=0; i < sensorHits.size(); i++ )
+      for( unsigned j=0; j < sensorHits[i].size(); j++ ) delete sensorHits[i][j];
+
+   sensorHits.clear();
+
+}
+
+
+//=============================================================================
+
+int main(int , char** ){
+
+    try{
+
+        // ----- write your tests in here -------------------------------------
+
+        ilctest.log( "testing PhiloxRandom against the known answers of Random123 for Philox4x32-10" );
+
+        const uint32_t kat[3][10] = {
+           // counter                                          key                          result
+           { 0x00000000, 0x00000000, 0x00000000, 0x00000000,   0x00000000, 0x00000000,   0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 },
+           { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,   0xffffffff, 0xffffffff,   0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd },
+           { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344,   0xa4093822, 0x299f31d0,   0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }
+        };
+
+        for( unsigned i=0; i < 3; i++ ){
+
+           uint32_t block[4];
+           PhiloxRandom::getBlock( &kat[i][0], &kat[i][4], block );
+
+           std::stringstream test_case;
+           test_case << "known answer vector " << i;
+
+           if( block[0] == kat[i][6] && block[1] == kat[i][7] && block[2] == kat[i][8] && block[3] == kat[i][9] ) ilctest.pass( test_case.str() );
+           else ilctest.error( test_case.str() );
+
+        }
+
+
+        ilctest.log( "testing that generators with the same key give the same sequence and other streams differ" );
+
+        PhiloxRandom randomA( 12345, 678, 1 );
+        PhiloxRandom randomB( 12345, 678, 1 );
+        PhiloxRandom randomC( 12345, 678, 2 );
+
+        bool same = true;
+        bool allDifferent = true;
+
+        for( unsigned i=0; i < 1000; i++ ){
+
+           double a = randomA.flat();
+           double b = randomB.flat();
+           double c = randomC.flat();
+
+           if( a != b ) same = false;
+           if( a == c ) allDifferent = false;
+           if( !( a > 0. && a < 1. ) ) same = false;
+
+        }
+
+        if( same ) ilctest.pass( "same key, same sequence in (0,1)" );
+        else ilctest.error( "same key, same sequence in (0,1)" );
+
+        if( allDifferent ) ilctest.pass( "other stream, other sequence" );
+        else ilctest.error( "other stream, other sequence" );
+
+
+        ilctest.log( "testing that FTDBackgroundProcessor creates the same background with 1 and with several threads" );
+
+        TestBackgroundProcessor processor;
+
+        for( unsigned seed = 1; seed <= 3; seed++ ){
+
+           std::vector< std::vector< TrackerHitPlaneImpl* > > hits1;
+           std::vector< std::vector< TrackerHitPlaneImpl* > > hitsN;
+
+           processor.generate( seed, 1, hits1 );
+           processor.generate( seed, 8, hitsN );
+
+           unsigned nHits = 0;
+           for( unsigned i=0; i < hits1.size(); i++ ) nHits += hits1[i].size();
+
+           std::stringstream test_case;
+           test_case << "seed " << seed << ": " << nHits << " hits with 1 thread == with 8 threads";
+
+           if( nHits > 0 && areEqual( hits1, hitsN ) ) ilctest.pass( test_case.str() );
+           else ilctest.error( test_case.str() );
+
+           deleteHits( hits1 );
+           deleteHits( hitsN );
+
+        }
+
+        // --------------------------------------------------------------------
+
+
+    //} catch( ... ){
+    } catch( exception &e ){
+        ilctest.log( "exception caught" );
+        ilctest.fatal_error( e.what() );
+    }
+
+
+    return 0;
+}
+
+//=============================================================================
@@ -0,0 +1,179 @@
+////////////////////////
+// quantile_sketch test
+////////////////////////
+
+#include "ilctest/ILCTest.h"
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "QuantileSketch.h"
+
+using namespace std ;
+
+// this should be the first line in your test
+static ILCTest ilctest = ILCTest( "quantile_sketch" , std::cout );
+
+
+/** @return the sum of the weights of the stored values, a value on level h stands for 2^h values */
+uint64_t getTotalWeight( const QuantileSketch& sketch ){
+
+   std::vector< float > items;
+   std::vector< int > levels;
+   sketch.getItems( items, levels );
+
+   uint64_t total = 0;
+   for( unsigned i=0; i < levels.size(); i++ ) total += uint64_t(1) << levels[i];
+
+   return total;
+
+}
+
+
+/** @return the largest difference between q and the true rank (as a fraction) of getQuantile( q ), for q = 0.01 ... 0.99
+ *
+ * @param sorted all values of the stream, sorted
+ */
+double getMaxRankError( const QuantileSketch& sketch, const std::vector< float >& sorted ){
+
+   double maxError = 0.;
+
+   for( unsigned i=1; i < 100; i++ ){
+
+      double q = i / 100.;
+      float value = sketch.getQuantile( q );
+
+      // the values equal to the quantile cover a range of ranks, take the one nearest to q
+      double rankLow = double( std::lower_bound( sorted.begin(), sorted.end(), value ) - sorted.begin() ) / sorted.size();
+      double rankHigh = double( std::upper_bound( sorted.begin(), sorted.end(), value ) - sorted.begin() ) / sorted.size();
+
+      double error = 0.;
+      if( q < rankLow ) error = rankLow - q;
+      if( q > rankHigh ) error = q - rankHigh;
+
+      maxError = std::max( maxError, error );
+
+   }
+
+   return maxError;
+
+}
+
+
+//=============================================================================
+
+int main(int , char** ){
+
+    try{
+
+        // ----- write your tests in here -------------------------------------
+
+        const unsigned k = 200;
+        const double maxRankError = 1.7 / k;
+
+        const unsigned nJobs = 5;
+        const unsigned nPerJob = 200000;
+
+        std::mt19937 generator( 42 );
+        std::normal_distribution< float > gauss( 0.f, 1.f );
+        std::exponential_distribution< float > exponential( 2.f );
+
+        std::vector< float > all;
+        std::vector< QuantileSketch > jobSketches( nJobs, QuantileSketch( k ) );
+        QuantileSketch single( k );
+
+        // every job sees another part of the distribution, so merging really has to combine them
+        for( unsigned j=0; j < nJobs; j++ ){
+
+           for( unsigned i=0; i < nPerJob; i++ ){
+
+              float x = ( j % 2 == 0 ) ? gauss( generator ) + j : exponential( generator ) - j;
+
+              jobSketches[j].update( x );
+              single.update( x );
+              all.push_back( x );
+
+           }
+
+        }
+
+        std::sort( all.begin(), all.end() );
+
+
+        ilctest.log( "testing that no weight is lost when compacting" );
+
+        for( unsigned j=0; j < nJobs; j++ ){
+
+           std::stringstream test_case;
+           test_case << "job " << j << ": weight " << getTotalWeight( jobSketches[j] ) << " == " << nPerJob << " values";
+
+           if( getTotalWeight( jobSketches[j] ) == nPerJob && jobSketches[j].getN() == nPerJob ) ilctest.pass( test_case.str() );
+           else ilctest.error( test_case.str() );
+
+        }
+
+
+        ilctest.log( "testing that no weight is lost when merging" );
+
+        QuantileSketch merged( k );
+        for( unsigned j=0; j < nJobs; j++ ) merged.merge( jobSketches[j] );
+
+        // the way QuantileAnalyser gets them from the files
+        QuantileSketch mergedFromItems( k );
+        for( unsigned j=0; j < nJobs; j++ ){
+
+           std::vector< float > items;
+           std::vector< int > levels;
+           jobSketches[j].getItems( items, levels );
+
+           mergedFromItems.merge( QuantileSketch::fromItems( k, jobSketches[j].getMin(), jobSketches[j].getMax(), items, levels ) );
+
+        }
+
+        std::stringstream weight_case;
+        weight_case << "merged: weight " << getTotalWeight( merged ) << ", from items " << getTotalWeight( mergedFromItems )
+                    << " == " << all.size() << " values";
+
+        if( getTotalWeight( merged ) == all.size() && merged.getN() == all.size()
+            && getTotalWeight( mergedFromItems ) == all.size() && mergedFromItems.getN() == all.size() ) ilctest.pass( weight_case.str() );
+        else ilctest.error( weight_case.str() );
+
+        if( merged.getMin() == all.front() && merged.getMax() == all.back() ) ilctest.pass( "merged: min and max" );
+        else ilctest.error( "merged: min and max" );
+
+
+        ilctest.log( "testing that the rank error of the quantiles is within 1.7/k" );
+
+        const QuantileSketch* sketches[] = { &single, &merged, &mergedFromItems };
+        const char* names[] = { "one stream", "merged", "merged from items" };
+
+        for( unsigned s=0; s < 3; s++ ){
+
+           double error = getMaxRankError( *sketches[s], all );
+
+           std::stringstream test_case;
+           test_case << names[s] << ": max. rank error " << error << " <= " << maxRankError;
+
+           if( error <= maxRankError ) ilctest.pass( test_case.str() );
+           else ilctest.error( test_case.str() );
+
+        }
+
+        // --------------------------------------------------------------------
+
+
+    //} catch( ... ){
+    } catch( exception &e ){
+        ilctest.log( "exception caught" );
+        ilctest.fatal_error( e.what() );
+    }
+
+
+    return 0;
+}
+
+//=============================================================================